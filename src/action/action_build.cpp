@@ -41,6 +41,7 @@
 #include "action/action_built.h"
 #include "ai.h"
 #include "animation.h"
+#include "depend.h"
 #include "iolib.h"
 #include "map.h"
 #include "pathfinder.h"
@@ -370,6 +371,7 @@ bool COrder_Build::StartBuilding(CUnit &unit, CUnit &ontop)
 
 	// HACK: the building is not ready yet
 	build->Player->UnitTypesCount[type.Slot]--;
+	DependUnitTypeCountChanged(*build->Player, type);
 	if (build->Active) {
 		build->Player->UnitTypesAiActiveCount[type.Slot]--;
 	}
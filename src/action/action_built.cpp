@@ -36,6 +36,8 @@
 #include "ai.h"
 #include "commands.h"
 #include "construct.h"
+#include "depend.h"
+#include "distancefield.h"
 #include "iolib.h"
 #include "luacallback.h"
 #include "map.h"
@@ -156,6 +158,7 @@ static void Finish(COrder_Built &order, CUnit &unit)
 
 	// HACK: the building is ready now
 	player.UnitTypesCount[type.Slot]++;
+	DependUnitTypeCountChanged(player, type);
 	if (unit.Active) {
 		player.UnitTypesAiActiveCount[type.Slot]++;
 	}
@@ -247,6 +250,7 @@ static void Finish(COrder_Built &order, CUnit &unit)
 	unit.CurrentSightRange = unit.Stats->Variables[SIGHTRANGE_INDEX].Max;
 	MapMarkUnitSight(unit);
 	order.Finished = true;
+	DistanceFieldsDepotChanged(type);
 }
 
 
@@ -306,8 +310,8 @@ static void Finish(COrder_Built &order, CUnit &unit)
 
 /* virtual */ void COrder_Built::FillSeenValues(CUnit &unit) const
 {
-	unit.Seen.State = 1;
-	unit.Seen.CFrame = this->Frame;
+	unit.Cold->Seen.State = 1;
+	unit.Cold->Seen.CFrame = this->Frame;
 }
 
 /** Called when unit is killed.
@@ -118,6 +118,7 @@ static bool FindNearestReachableTerrainType(int movemask, int resmask, int range
 
 	terrainTraversal.SetSize(Map.Info.MapWidth, Map.Info.MapHeight);
 	terrainTraversal.Init();
+	terrainTraversal.SetWindowAround(startPos, range);
 
 	terrainTraversal.PushPos(startPos);
 
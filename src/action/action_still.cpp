@@ -78,6 +78,9 @@ enum {
 	if (this->Finished) {
 		file.printf(" \"finished\", ");
 	}
+	if (this->Quiet) {
+		file.printf(" \"quiet\", \"quiet-since\", %lu, ", this->QuietSince);
+	}
 	if (this->State != 0) { // useless to write default value
 		file.printf("\"state\", %d", this->State);
 	}
@@ -89,6 +92,11 @@ enum {
 	if (!strcmp("state", value)) {
 		++j;
 		this->State = LuaToNumber(l, -1, j + 1);
+	} else if (!strcmp("quiet", value)) {
+		this->Quiet = true;
+	} else if (!strcmp("quiet-since", value)) {
+		++j;
+		this->QuietSince = LuaToNumber(l, -1, j + 1);
 	} else {
 		return false;
 	}
@@ -304,16 +312,59 @@ bool AutoRepair(CUnit &unit)
 	return true;
 }
 
+/**
+**  Check if a scan for enemies in range can find something new.
+**
+**  After a scan which found nothing, the unit stays quiet until a unit of
+**  an enemy player enters the sectors around it. A full scan is still done
+**  from time to time, for the changes of visibility and diplomacy.
+**
+**  @param unit   Unit which looks for enemies.
+**  @param range  Distance of the scan.
+**
+**  @return       True if the scan must be done.
+*/
+bool COrder_Still::MayHaveEnemyInRange(const CUnit &unit, int range) const
+{
+	if (this->Quiet == false || GameCycle - this->QuietSince >= 4 * CYCLES_PER_SECOND) {
+		return true;
+	}
+	unsigned int enemies = 0;
+	for (int p = 0; p != PlayerMax; ++p) {
+		if (unit.Player->IsEnemy(p)) {
+			enemies |= 1 << p;
+		}
+	}
+	if (enemies == 0) {
+		return false;
+	}
+	if (unit.Type->Missile.Missile && unit.Type->Missile.Missile->Range > 1) {
+		range += unit.Type->Missile.Missile->Range;
+	}
+	// If unit is removed, use containers x and y
+	const CUnit *firstContainer = unit.Container ? unit.Container : &unit;
+	const Vec2i offset(range, range);
+	const Vec2i size(firstContainer->Type->TileWidth - 1, firstContainer->Type->TileHeight - 1);
+
+	return Map.HasUnitEnteredSince(firstContainer->tilePos - offset, firstContainer->tilePos + size + offset,
+								   enemies, this->QuietSince);
+}
+
 bool COrder_Still::AutoAttackStand(CUnit &unit)
 {
 	if (unit.Type->CanAttack == false) {
 		return false;
 	}
+	if (!MayHaveEnemyInRange(unit, unit.Stats->Variables[ATTACKRANGE_INDEX].Max)) {
+		return false;
+	}
 	//  FIXME: if bunkers can increase attack range - count it in the distance calculations and target selection.
 
 	// Removed units can only attack in AttackRange, from bunker
 	CUnit *autoAttackUnit = AttackUnitsInRange(unit);
 
+	this->Quiet = (autoAttackUnit == NULL);
+	this->QuietSince = GameCycle;
 	if (autoAttackUnit == NULL) {
 		return false;
 	}
@@ -384,6 +435,25 @@ bool AutoAttack(CUnit &unit)
 }
 
 
+/**
+**  Auto attack nearby units, unless no enemy came since the last try.
+*/
+bool COrder_Still::AutoAttackStill(CUnit &unit)
+{
+	if (unit.Type->CanAttack == false) {
+		return false;
+	}
+	const int range = unit.Player->Type == PlayerTypes::PlayerPerson ? unit.Type->ReactRangePerson : unit.Type->ReactRangeComputer;
+	if (!MayHaveEnemyInRange(unit, range)) {
+		return false;
+	}
+	const bool attacked = AutoAttack(unit);
+
+	this->Quiet = !attacked;
+	this->QuietSince = GameCycle;
+	return attacked;
+}
+
 /* virtual */ void COrder_Still::Execute(CUnit &unit)
 {
 	// If unit is not bunkered and removed, wait
@@ -423,7 +493,7 @@ bool AutoAttack(CUnit &unit)
 		}
 	} else {
 		if (unit.JustMoved) --unit.JustMoved;
-		if (AutoCast(unit) || (unit.IsAgressive() && AutoAttack(unit))
+		if (AutoCast(unit) || (unit.IsAgressive() && this->AutoAttackStill(unit))
 			|| AutoRepair(unit)
 			|| MoveRandomly(unit)) {
 		}
@@ -39,6 +39,8 @@
 
 #include "ai.h"
 #include "animation.h"
+#include "depend.h"
+#include "distancefield.h"
 #include "iolib.h"
 #include "map.h"
 #include "player.h"
@@ -119,6 +121,8 @@ static int TransformUnitIntoType(CUnit &unit, const CUnitType &newtype)
 	CPlayer &player = *unit.Player;
 	player.UnitTypesCount[oldtype.Slot]--;
 	player.UnitTypesCount[newtype.Slot]++;
+	DependUnitTypeCountChanged(player, oldtype);
+	DependUnitTypeCountChanged(player, newtype);
 	if (unit.Active) {
 		player.UnitTypesAiActiveCount[oldtype.Slot]--;
 		player.UnitTypesAiActiveCount[newtype.Slot]++;
@@ -157,6 +161,8 @@ static int TransformUnitIntoType(CUnit &unit, const CUnitType &newtype)
 
 	unit.Type = const_cast<CUnitType *>(&newtype);
 	unit.Stats = &unit.Type->Stats[player.Index];
+	DistanceFieldsDepotChanged(oldtype);
+	DistanceFieldsDepotChanged(newtype);
 
 	if (newtype.CanCastSpell && !unit.AutoCastSpell) {
 		unit.AutoCastSpell = new char[SpellTypeTable.size()];
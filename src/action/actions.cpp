@@ -125,11 +125,11 @@ void COrder::UpdatePathFinderData_NotCalled(PathFinderInput &input)
 
 /* virtual */ void COrder::FillSeenValues(CUnit &unit) const
 {
-	unit.Seen.State = ((Action == UnitActionUpgradeTo) << 1);
+	unit.Cold->Seen.State = ((Action == UnitActionUpgradeTo) << 1);
 	if (unit.CurrentAction() == UnitActionDie) {
-		unit.Seen.State = 3;
+		unit.Cold->Seen.State = 3;
 	}
-	unit.Seen.CFrame = NULL;
+	unit.Cold->Seen.CFrame = NULL;
 }
 
 /* virtual */ bool COrder::OnAiHitUnit(CUnit &unit, CUnit *attacker, int /*damage*/)
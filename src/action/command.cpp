@@ -42,6 +42,7 @@
 #include "action/action_train.h"
 #include "action/action_upgradeto.h"
 #include "commands.h"
+#include "distancefield.h"
 #include "map.h"
 #include "pathfinder.h"
 #include "player.h"
@@ -950,6 +951,7 @@ void CommandSharedVision(int playerIndex, bool state, int opponentIndex)
 				}
 			}
 		}
+		DistanceFieldsExploredChanged();
 	} else {
 		player->ShareVisionWith(*opponent);
 	}
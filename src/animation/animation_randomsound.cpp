@@ -67,10 +67,10 @@
 	}
 }
 
-void CAnimation_RandomSound::MapSound()
+void CAnimation_RandomSound::MapSound(bool prefetch)
 {
 	for (size_t i = 0; i != this->sounds.size(); ++i) {
-		this->sounds[i].MapSound();
+		this->sounds[i].MapSound(prefetch);
 	}
 }
 
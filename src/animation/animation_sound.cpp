@@ -54,9 +54,9 @@
 	this->sound.Name = s;
 }
 
-void CAnimation_Sound::MapSound()
+void CAnimation_Sound::MapSound(bool prefetch)
 {
-	this->sound.MapSound();
+	this->sound.MapSound(prefetch);
 }
 
 //@}
@@ -35,6 +35,7 @@
 ----------------------------------------------------------------------------*/
 
 #include <deque>
+#include <map>
 #include <stdint.h>
 
 #include "stratagus.h"
@@ -68,7 +69,7 @@
 
 
 extern void DoScrollArea(int state, bool fast, bool isKeyboard);
-extern void DrawGuichanWidgets();
+extern bool DrawGuichanWidgets();
 extern void CleanGame();
 extern void CreateGame(const std::string &filename, CMap *map);
 
@@ -98,6 +99,7 @@ char TileToolRandom;      /// Tile tool draws random
 static char TileToolDecoration;  /// Tile tool draws with decorations
 static int TileCursorSize;       /// Tile cursor size 1x1 2x2 ... 4x4
 static bool UnitPlacedThisPress = false;  /// Only allow one unit per press
+static bool TilesEditedThisPress = false; /// Tile edits of this press share one undo
 static bool UpdateMinimap = false;        /// Update units on the minimap
 static int MirrorEdit = 0;                /// Mirror editing enabled
 static int VisibleUnitIcons = 0;              /// Number of icons that are visible at a time
@@ -112,7 +114,8 @@ enum _mode_buttons_ {
 
 enum EditorActionType {
 	EditorActionTypePlaceUnit,
-	EditorActionTypeRemoveUnit
+	EditorActionTypeRemoveUnit,
+	EditorActionTypeEditTiles
 };
 
 struct EditorAction {
@@ -120,6 +123,7 @@ struct EditorAction {
 	Vec2i tilePos;
 	const CUnitType *UnitType;
 	CPlayer *Player;
+	std::vector<EditorTileChange> Tiles;  /// Changed fields of EditorActionTypeEditTiles
 };
 
 static std::deque<EditorAction> EditorUndoActions;
@@ -166,18 +170,13 @@ static void EditTile(const Vec2i &pos, int tile)
 		baseTileIndex = baseTileIndex / 16 * 16;
 	}
 	const int tileIndex = tileset.getTileNumber(baseTileIndex, TileToolRandom, TileToolDecoration);
-	mf.setTileIndex(tileset, tileIndex, 0);
-	mf.playerInfo.SeenTile = mf.getGraphicTile();
-
-	UI.Minimap.UpdateSeenXY(pos);
-	UI.Minimap.UpdateXY(pos);
-
+	EditorSetTileIndex(pos, tileIndex);
 	EditorTileChanged(pos);
 	UpdateMinimap = true;
 }
 
 /**
-**  Edit tiles (internal, used by EditTiles()).
+**  Edit tiles (internal, used by EditTilesMirrored()).
 **
 **  @param pos   map tile coordinate.
 **  @param tile  Tile type to edit.
@@ -207,7 +206,7 @@ static void EditTilesInternal(const Vec2i &pos, int tile, int size)
 **  @param tile  Tile type to edit.
 **  @param size  Size of rectangle
 */
-static void EditTiles(const Vec2i &pos, int tile, int size)
+static void EditTilesMirrored(const Vec2i &pos, int tile, int size)
 {
 	EditTilesInternal(pos, tile, size);
 
@@ -228,6 +227,51 @@ static void EditTiles(const Vec2i &pos, int tile, int size)
 	EditTilesInternal(mirror, tile, size);
 }
 
+/**
+**  Edit tiles, as one terrain edit which can be undone.
+**
+**  @param pos   map tile coordinate.
+**  @param tile  Tile type to edit.
+**  @param size  Size of rectangle
+*/
+static void EditTiles(const Vec2i &pos, int tile, int size)
+{
+	EditorAction editorAction;
+	editorAction.Type = EditorActionTypeEditTiles;
+	editorAction.tilePos = pos;
+	editorAction.UnitType = NULL;
+	editorAction.Player = NULL;
+
+	EditorBeginTileEdit();
+	EditTilesMirrored(pos, tile, size);
+	EditorEndTileEdit(&editorAction.Tiles);
+
+	if (editorAction.Tiles.empty()) {
+		return;
+	}
+	if (TilesEditedThisPress && !EditorUndoActions.empty()
+		&& EditorUndoActions.back().Type == EditorActionTypeEditTiles) {
+		// Dragging the brush: merge into the edit of this press
+		std::vector<EditorTileChange> &tiles = EditorUndoActions.back().Tiles;
+		std::map<unsigned int, size_t> indexes;
+		for (size_t i = 0; i != tiles.size(); ++i) {
+			indexes[tiles[i].Index] = i;
+		}
+		for (const EditorTileChange &change : editorAction.Tiles) {
+			std::map<unsigned int, size_t>::iterator it = indexes.find(change.Index);
+			if (it != indexes.end()) {
+				tiles[it->second].After = change.After;
+			} else {
+				tiles.push_back(change);
+			}
+		}
+		EditorRedoActions.clear();
+		return;
+	}
+	TilesEditedThisPress = true;
+	EditorAddUndoAction(editorAction);
+}
+
 /*----------------------------------------------------------------------------
 --  Actions
 ----------------------------------------------------------------------------*/
@@ -363,6 +407,11 @@ static void EditorUndoAction()
 		case EditorActionTypeRemoveUnit:
 			EditorActionPlaceUnit(action.tilePos, *action.UnitType, action.Player);
 			break;
+
+		case EditorActionTypeEditTiles:
+			EditorRestoreTiles(action.Tiles, false);
+			UpdateMinimap = true;
+			break;
 	}
 	EditorRedoActions.push_back(action);
 }
@@ -385,6 +434,11 @@ static void EditorRedoAction()
 			EditorActionRemoveUnit(*unit);
 			break;
 		}
+
+		case EditorActionTypeEditTiles:
+			EditorRestoreTiles(action.Tiles, true);
+			UpdateMinimap = true;
+			break;
 	}
 	EditorUndoActions.push_back(action);
 }
@@ -1110,6 +1164,7 @@ static void EditorCallbackButtonUp(unsigned button)
 	}
 	if ((1 << button) == LeftButton) {
 		UnitPlacedThisPress = false;
+		TilesEditedThisPress = false;
 	}
 
 	if (CursorState == CursorStateRectangle && !(MouseButtons & LeftButton)) { // leave select mode
@@ -51,10 +51,178 @@
 /// Callback for changed tile (with locked position)
 static void EditorChangeSurrounding(const Vec2i &pos, const Vec2i &lock_pos);
 
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+enum {
+	TileEditRecorded = 1,  /// Field is in TileEditChanges
+	TileEditPainted = 2    /// Field is set by the edit, the fix-up keeps it
+};
+
+static int TileEditDepth = 0;                     /// Nesting of EditorBeginTileEdit
+static bool TileEditFixing = false;               /// Surroundings of the edit are being fixed
+static std::vector<unsigned char> TileEditMarks;  /// TileEdit marks of each map field
+static std::vector<EditorTileChange> TileEditChanges; /// Fields changed by the current edit
+static std::vector<Vec2i> TileEditFixups;         /// Painted fields whose surroundings need fixing
+static Vec2i TileEditMin;                         /// Top left changed field
+static Vec2i TileEditMax;                         /// Bottom right changed field
+
+/// Field flags which depend on the units and not on the terrain
+static const unsigned int TileEditUnitFlags = MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit | MapFieldBuilding;
+
 /*----------------------------------------------------------------------------
 --  Functions
 ----------------------------------------------------------------------------*/
 
+static EditorTileState GetTileState(const CMapField &mf)
+{
+	EditorTileState state;
+	state.Tile = mf.getGraphicTile();
+	state.SeenTile = mf.playerInfo.SeenTile;
+	state.Flags = mf.Flags & ~TileEditUnitFlags;
+	state.Value = mf.Value;
+	return state;
+}
+
+static void SetTileState(CMapField &mf, const EditorTileState &state)
+{
+	// setTileIndex for the move cost, which only depends on the tile
+	const int tileIndex = Map.Tileset->findTileIndexByTile(state.Tile);
+	if (tileIndex != -1) {
+		mf.setTileIndex(*Map.Tileset, tileIndex, state.Value);
+	}
+	mf.setGraphicTile(state.Tile);
+	mf.playerInfo.SeenTile = state.SeenTile;
+	mf.Flags = (mf.Flags & TileEditUnitFlags) | state.Flags;
+	mf.Value = state.Value;
+}
+
+/**
+**  Remember the terrain of a field before the current edit changes it.
+**
+**  @param pos  map tile coordinate.
+*/
+static void TileEditRecord(const Vec2i &pos)
+{
+	if (!TileEditDepth) {
+		return;
+	}
+	const unsigned int index = Map.getIndex(pos);
+	if (TileEditMarks[index] & TileEditRecorded) {
+		return;
+	}
+	TileEditMarks[index] |= TileEditRecorded;
+
+	EditorTileChange change;
+	change.Index = index;
+	change.Before = GetTileState(*Map.Field(index));
+	TileEditChanges.push_back(change);
+
+	TileEditMin.x = std::min(TileEditMin.x, pos.x);
+	TileEditMin.y = std::min(TileEditMin.y, pos.y);
+	TileEditMax.x = std::max(TileEditMax.x, pos.x);
+	TileEditMax.y = std::max(TileEditMax.y, pos.y);
+}
+
+/**
+**  Check if the fix-up of the current edit must keep a field.
+*/
+static bool IsTileEditPainted(const Vec2i &pos)
+{
+	return TileEditDepth && (TileEditMarks[Map.getIndex(pos)] & TileEditPainted);
+}
+
+/**
+**  Start a terrain edit.
+**
+**  Until the matching EditorEndTileEdit, the edited tiles only get their
+**  surroundings fixed and the minimap updated once, at the end. Edits
+**  can be nested, the outermost one does the work.
+*/
+void EditorBeginTileEdit()
+{
+	if (TileEditDepth++) {
+		return;
+	}
+	const size_t size = Map.Info.MapWidth * Map.Info.MapHeight;
+	if (TileEditMarks.size() != size) {
+		TileEditMarks.assign(size, 0);
+	}
+	TileEditMin = Vec2i(Map.Info.MapWidth, Map.Info.MapHeight);
+	TileEditMax = Vec2i(-1, -1);
+}
+
+/**
+**  End a terrain edit.
+**
+**  Fix the surroundings of all the painted tiles, the painted tiles
+**  themselves are kept, then update the minimap over the changed area.
+**
+**  @param changes  If not NULL, filled with the fields changed by the
+**                  edit. Only the outermost edit returns them.
+*/
+void EditorEndTileEdit(std::vector<EditorTileChange> *changes)
+{
+	Assert(TileEditDepth > 0);
+	if (--TileEditDepth) {
+		return;
+	}
+	++TileEditDepth;
+	TileEditFixing = true;
+	for (size_t i = 0; i != TileEditFixups.size(); ++i) {
+		EditorChangeSurrounding(TileEditFixups[i], TileEditFixups[i]);
+	}
+	TileEditFixing = false;
+	--TileEditDepth;
+
+	Vec2i pos;
+	for (pos.y = TileEditMin.y; pos.y <= TileEditMax.y; ++pos.y) {
+		for (pos.x = TileEditMin.x; pos.x <= TileEditMax.x; ++pos.x) {
+			UI.Minimap.UpdateSeenXY(pos);
+			UI.Minimap.UpdateXY(pos);
+		}
+	}
+
+	// Keep only the fields which really changed
+	size_t n = 0;
+	for (size_t i = 0; i != TileEditChanges.size(); ++i) {
+		EditorTileChange &change = TileEditChanges[i];
+		TileEditMarks[change.Index] = 0;
+		change.After = GetTileState(*Map.Field(change.Index));
+		if (!(change.After == change.Before)) {
+			TileEditChanges[n++] = change;
+		}
+	}
+	TileEditChanges.resize(n);
+	for (size_t i = 0; i != TileEditFixups.size(); ++i) {
+		TileEditMarks[Map.getIndex(TileEditFixups[i])] = 0;
+	}
+	if (changes) {
+		changes->swap(TileEditChanges);
+	}
+	TileEditChanges.clear();
+	TileEditFixups.clear();
+}
+
+/**
+**  Put back the terrain of the fields changed by an edit.
+**
+**  @param changes  Fields changed by the edit.
+**  @param redo     Put back the terrain after the edit, instead of before.
+*/
+void EditorRestoreTiles(const std::vector<EditorTileChange> &changes, bool redo)
+{
+	for (size_t i = 0; i != changes.size(); ++i) {
+		const EditorTileChange &change = changes[i];
+		SetTileState(*Map.Field(change.Index), redo ? change.After : change.Before);
+
+		const Vec2i pos(change.Index % Map.Info.MapWidth, change.Index / Map.Info.MapWidth);
+		UI.Minimap.UpdateSeenXY(pos);
+		UI.Minimap.UpdateXY(pos);
+	}
+}
+
 /**
 **  Change tile from abstract tile-type.
 **
@@ -91,6 +259,46 @@ static unsigned QuadFromTile(const Vec2i &pos)
 	return Map.Tileset->getQuadFromTile(tile);
 }
 
+/**
+**  Set the tile of a field, without fixing its surroundings.
+**
+**  @param pos        map tile coordinate.
+**  @param tileIndex  Tileset tile index.
+*/
+void EditorSetTileIndex(const Vec2i &pos, int tileIndex)
+{
+	Assert(Map.Info.IsPointOnMap(pos));
+
+	TileEditRecord(pos);
+
+	CMapField &mf = *Map.Field(pos);
+	mf.setTileIndex(*Map.Tileset, tileIndex, 0);
+	mf.playerInfo.SeenTile = mf.getGraphicTile();
+
+	// a terrain edit updates the minimap once at its end
+	if (!TileEditDepth) {
+		UI.Minimap.UpdateSeenXY(pos);
+		UI.Minimap.UpdateXY(pos);
+	}
+}
+
+/**
+**  Fix the surroundings of a changed tile, or leave it to the end of the
+**  current terrain edit.
+*/
+static void TileChanged(const Vec2i &pos, const Vec2i &lock_pos)
+{
+	if (TileEditDepth && !TileEditFixing) {
+		unsigned char &mark = TileEditMarks[Map.getIndex(pos)];
+		if (!(mark & TileEditPainted)) {
+			mark |= TileEditPainted;
+			TileEditFixups.push_back(pos);
+		}
+		return;
+	}
+	EditorChangeSurrounding(pos, lock_pos);
+}
+
 /**
 **  Editor change tile.
 **
@@ -124,17 +332,13 @@ void EditorChangeTile(const Vec2i &pos, int tileIndex, const Vec2i &lock_pos, bo
 			tile += i;
 		}
 	}
-	mf.setTileIndex(*Map.Tileset, tile, 0);
-	mf.playerInfo.SeenTile = mf.getGraphicTile();
-
-	UI.Minimap.UpdateSeenXY(pos);
-	UI.Minimap.UpdateXY(pos);
+	EditorSetTileIndex(pos, tile);
 
 	if (!mf.isDecorative() && changeSurroundings) {
 		if (TileToolNoFixup) {
 			mf.Flags |= MapFieldDecorative;
 		} else {
-			EditorChangeSurrounding(pos, lock_pos);
+			TileChanged(pos, lock_pos);
 		}
 	}
 }
@@ -148,6 +352,7 @@ void EditorChangeTile(const Vec2i &pos, int tileIndex, const Vec2i &lock_pos, bo
 static void EditorChangeSurrounding(const Vec2i &pos, const Vec2i &lock_pos)
 {
 	if (TileToolNoFixup) {
+		TileEditRecord(pos);
 		CMapField &mf = *Map.Field(pos);
 		mf.Flags |= MapFieldDecorative;
 		return;
@@ -156,6 +361,15 @@ static void EditorChangeSurrounding(const Vec2i &pos, const Vec2i &lock_pos)
 	// Special case 1) Walls.
 	CMapField &mf = *Map.Field(pos);
 	if (mf.isAWall()) {
+		// SetWall also fixes the wall tiles around
+		for (int dy = -1; dy <= 1; ++dy) {
+			for (int dx = -1; dx <= 1; ++dx) {
+				const Vec2i neighbor(pos.x + dx, pos.y + dy);
+				if (Map.Info.IsPointOnMap(neighbor)) {
+					TileEditRecord(neighbor);
+				}
+			}
+		}
 		Map.SetWall(pos, mf.isHuman());
 		return;
 	}
@@ -185,7 +399,7 @@ static void EditorChangeSurrounding(const Vec2i &pos, const Vec2i &lock_pos)
 		} else if (!f->isDecorative()) {
 			unsigned q2 = QuadFromTile(pos + offset);
 			unsigned u = (q2 & TH_QUAD_M) | ((quad >> 16) & BH_QUAD_M);
-			if (u != q2 && (pos + offset) != lock_pos) {
+			if (u != q2 && (pos + offset) != lock_pos && !IsTileEditPainted(pos + offset)) {
 				int tile = Map.Tileset->tileFromQuad(u & BH_QUAD_M, u);
 				if (tile) {
 					did_change = true;
@@ -203,7 +417,7 @@ static void EditorChangeSurrounding(const Vec2i &pos, const Vec2i &lock_pos)
 		} else if (!f->isDecorative()) {
 			unsigned q2 = QuadFromTile(pos + offset);
 			unsigned u = (q2 & BH_QUAD_M) | ((quad << 16) & TH_QUAD_M);
-			if (u != q2 && (pos + offset) != lock_pos) {
+			if (u != q2 && (pos + offset) != lock_pos && !IsTileEditPainted(pos + offset)) {
 				int tile = Map.Tileset->tileFromQuad(u & TH_QUAD_M, u);
 				if (tile) {
 					did_change = true;
@@ -221,7 +435,7 @@ static void EditorChangeSurrounding(const Vec2i &pos, const Vec2i &lock_pos)
 		} else if (!f->isDecorative()) {
 			unsigned q2 = QuadFromTile(pos + offset);
 			unsigned u = (q2 & LH_QUAD_M) | ((quad >> 8) & RH_QUAD_M);
-			if (u != q2 && (pos + offset) != lock_pos) {
+			if (u != q2 && (pos + offset) != lock_pos && !IsTileEditPainted(pos + offset)) {
 				int tile = Map.Tileset->tileFromQuad(u & RH_QUAD_M, u);
 				if (tile) {
 					did_change = true;
@@ -239,7 +453,7 @@ static void EditorChangeSurrounding(const Vec2i &pos, const Vec2i &lock_pos)
 		} else if (!f->isDecorative()) {
 			unsigned q2 = QuadFromTile(pos + offset);
 			unsigned u = (q2 & RH_QUAD_M) | ((quad << 8) & LH_QUAD_M);
-			if (u != q2 && (pos + offset) != lock_pos) {
+			if (u != q2 && (pos + offset) != lock_pos && !IsTileEditPainted(pos + offset)) {
 				int tile = Map.Tileset->tileFromQuad(u & LH_QUAD_M, u);
 				if (tile) {
 					did_change = true;
@@ -261,7 +475,7 @@ static void EditorChangeSurrounding(const Vec2i &pos, const Vec2i &lock_pos)
 */
 void EditorTileChanged(const Vec2i &pos)
 {
-	EditorChangeSurrounding(pos, pos);
+	TileChanged(pos, pos);
 }
 
 /**
@@ -291,12 +505,14 @@ static void TileFill(const Vec2i &pos, int tile, int size)
 	bool changeSurroundings = (ipos.x > 0 || ipos.y > 0 || 
 			Map.Info.MapWidth - 1 > apos.x || Map.Info.MapHeight - 1 > apos.y);
 
+	EditorBeginTileEdit();
 	Vec2i itPos;
 	for (itPos.x = ipos.x; itPos.x <= apos.x; ++itPos.x) {
 		for (itPos.y = ipos.y; itPos.y <= apos.y; ++itPos.y) {
 			EditorChangeTile(itPos, tile, itPos, changeSurroundings);
 		}
 	}
+	EditorEndTileEdit(NULL);
 }
 
 static std::mt19937 MersenneTwister(std::chrono::steady_clock::now().time_since_epoch().count());
@@ -315,6 +531,7 @@ static void EditorRandomizeTile(int tile, int count, int max_size)
 {
 	const Vec2i mpos(Map.Info.MapWidth - 1, Map.Info.MapHeight - 1);
 
+	EditorBeginTileEdit();
 	for (int i = 0; i < count; ++i) {
 		const Vec2i rpos(rng() % ((1 + mpos.x) / 2), rng() % ((1 + mpos.y) / 2));
 		const Vec2i mirror = mpos - rpos;
@@ -327,6 +544,7 @@ static void EditorRandomizeTile(int tile, int count, int max_size)
 		TileFill(mirrorv, tile, rz);
 		TileFill(mirror, tile, rz);
 	}
+	EditorEndTileEdit(NULL);
 }
 
 /**
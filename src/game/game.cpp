@@ -391,31 +391,14 @@ int WriteMapSetup(const char *mapSetup, CMap &map, int writeTerrain, Vec2i newSi
 		f->printf("LoadTileModels(\"%s\")\n\n", map.TileModelsFileName.c_str());
 
 		if (writeTerrain) {
-		   	if (newSize.x != 0 && newSize.y != 0) {
-				f->printf("for x=0,%d,1 do\n", newSize.x - 1);
-				f->printf("    for y=0,%d,1 do\n", newSize.y - 1);
-				f->printf("        SetTile(%d, x, y, 0)\n", Map.Tileset->getDefaultTileIndex());
-				f->printf("    end\n");
-				f->printf("end\n");
-			} else {
+		   	if (newSize.x == 0 || newSize.y == 0) {
 				newSize.x = map.Info.MapWidth;
 				newSize.y = map.Info.MapHeight;
 			}
 
 			f->printf("-- Tiles Map\n");
-			for (int i = 0; i < map.Info.MapHeight; ++i) {
-				for (int j = 0; j < map.Info.MapWidth; ++j) {
-					const CMapField &mf = map.Fields[j + i * map.Info.MapWidth];
-					const int tile = mf.getGraphicTile();
-					const int n = map.Tileset->findTileIndexByTile(tile);
-					const int value = mf.Value;
-					const int x = j + offset.x;
-					const int y = i + offset.y;
-					if (x < newSize.x && y < newSize.y) {
-						f->printf("SetTile(%3d, %d, %d, %d)\n", n, x, y, value);
-					}
-				}
-			}
+			f->printf("LoadMapTerrain(__file__ .. \".terrain\")\n");
+			SaveMapTerrain(std::string(mapSetup) + ".terrain.gz", map, newSize, offset);
 		}
 
 		if (newSize.x == 0 || newSize.y == 0) {
@@ -1107,6 +1090,7 @@ void CleanGame()
 {
 	EndReplayLog();
 	CleanMessages();
+	CleanPanelCaches();
 
 	RestoreColorCyclingSurface();
 	CleanGame_Lua();
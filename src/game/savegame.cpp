@@ -131,13 +131,16 @@ int SaveGame(const std::string &filename)
 	file.printf("local oldCreateUnit = CreateUnit\n");
 	file.printf("local oldSetResourcesHeld = SetResourcesHeld\n");
 	file.printf("local oldSetTile = SetTile\n");
+	file.printf("local oldLoadMapTerrain = LoadMapTerrain\n");
 	file.printf("function CreateUnit() end\n");
 	file.printf("function SetResourcesHeld() end\n");
 	file.printf("function SetTile() end\n");
+	file.printf("function LoadMapTerrain() end\n");
 	file.printf("Load(\"%s\")\n", Map.Info.Filename.c_str());
 	file.printf("CreateUnit = oldCreateUnit\n");
 	file.printf("SetResourcesHeld = oldSetResourcesHeld\n");
 	file.printf("SetTile = oldSetTile\n");
+	file.printf("LoadMapTerrain = oldLoadMapTerrain\n");
 	//
 	// Parseable header
 	//
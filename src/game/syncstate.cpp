@@ -0,0 +1,245 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name syncstate.cpp - The full state sync check. */
+//
+//      (c) Copyright 2024 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+//----------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------
+
+#include "stratagus.h"
+
+#include "syncstate.h"
+
+#include "map.h"
+#include "player.h"
+#include "unit.h"
+#include "unit_manager.h"
+#include "unittype.h"
+
+//----------------------------------------------------------------------------
+// Functions
+//----------------------------------------------------------------------------
+
+/**
+**  Mix a value into a hash (FNV-1a on 32 bit words).
+*/
+static inline void HashMix(uint32_t &hash, uint32_t value)
+{
+	hash = (hash ^ value) * 16777619u;
+}
+
+static const uint32_t HashSeed = 2166136261u;
+
+static void HashUnit(uint32_t &hash, const CUnit &unit)
+{
+	HashMix(hash, unit.Destroyed);
+	if (unit.Destroyed || unit.Type == NULL) {
+		return;
+	}
+	HashMix(hash, unit.Type->Slot);
+	HashMix(hash, unit.Player ? unit.Player->Index : -1);
+	HashMix(hash, unit.Removed);
+	HashMix(hash, unit.tilePos.x);
+	HashMix(hash, unit.tilePos.y);
+	HashMix(hash, unit.IX);
+	HashMix(hash, unit.IY);
+	HashMix(hash, unit.Orders.empty() ? -1 : unit.CurrentAction());
+	HashMix(hash, unit.CurrentResource);
+	HashMix(hash, unit.ResourcesHeld);
+	if (unit.Variable) {
+		const unsigned int count = UnitTypeVar.GetNumberVariable();
+		for (unsigned int i = 0; i != count; ++i) {
+			HashMix(hash, unit.Variable[i].Value);
+			HashMix(hash, unit.Variable[i].Max);
+		}
+	}
+}
+
+static void HashPlayer(uint32_t &hash, const CPlayer &player)
+{
+	for (int i = 0; i != MaxCosts; ++i) {
+		HashMix(hash, player.Resources[i]);
+		HashMix(hash, player.StoredResources[i]);
+		HashMix(hash, player.MaxResources[i]);
+	}
+	HashMix(hash, player.Supply);
+	HashMix(hash, player.Demand);
+	HashMix(hash, player.NumBuildings);
+	HashMix(hash, player.Score);
+	HashMix(hash, player.TotalKills);
+}
+
+static int MapRowsPerPart()
+{
+	return std::max(1, (Map.Info.MapHeight + SyncStateMapParts - 1) / SyncStateMapParts);
+}
+
+/**
+**  Compute the hashes of the current game state.
+**
+**  @param cycle  Current game cycle.
+*/
+void CSyncState::Compute(unsigned long cycle)
+{
+	this->Cycle = cycle;
+
+	const unsigned int slotCount = UnitManager->GetUsedSlotCount();
+	std::vector<uint32_t> &units = this->Parts[SyncStateUnits];
+	units.assign((slotCount + SyncStateUnitsPerPart - 1) / SyncStateUnitsPerPart, HashSeed);
+	for (unsigned int i = 0; i != slotCount; ++i) {
+		HashUnit(units[i / SyncStateUnitsPerPart], UnitManager->GetSlotUnit(i));
+	}
+
+	std::vector<uint32_t> &players = this->Parts[SyncStatePlayers];
+	players.assign(NumPlayers, HashSeed);
+	for (int i = 0; i != NumPlayers; ++i) {
+		HashPlayer(players[i], Players[i]);
+	}
+
+	std::vector<uint32_t> &map = this->Parts[SyncStateMap];
+	map.clear();
+	if (Map.Fields) {
+		const int rowsPerPart = MapRowsPerPart();
+		map.assign((Map.Info.MapHeight + rowsPerPart - 1) / rowsPerPart, HashSeed);
+		for (int y = 0; y != Map.Info.MapHeight; ++y) {
+			uint32_t &hash = map[y / rowsPerPart];
+			const CMapField *mf = Map.Field(0, y);
+			for (int x = 0; x != Map.Info.MapWidth; ++x, ++mf) {
+				HashMix(hash, mf->Flags);
+				HashMix(hash, mf->Value);
+			}
+		}
+	}
+
+	for (int i = 0; i != SyncStateSubsystemCount; ++i) {
+		this->Hash[i] = HashSeed;
+		HashMix(this->Hash[i], this->Parts[i].size());
+		for (size_t j = 0; j != this->Parts[i].size(); ++j) {
+			HashMix(this->Hash[i], this->Parts[i][j]);
+		}
+	}
+}
+
+/**
+**  Compare part hashes received from another computer.
+**
+**  @param subsystem  Subsystem of the parts.
+**  @param offset     Index of the first received part.
+**  @param parts      Received part hashes.
+**
+**  @return index of the first different part, or -1 if all are equal.
+*/
+int CSyncState::FindFirstDifferentPart(int subsystem, unsigned int offset, const std::vector<uint32_t> &parts) const
+{
+	const std::vector<uint32_t> &ours = this->Parts[subsystem];
+
+	for (size_t i = 0; i != parts.size(); ++i) {
+		if (offset + i >= ours.size() || ours[offset + i] != parts[i]) {
+			return offset + i;
+		}
+	}
+	return -1;
+}
+
+const char *CSyncState::GetSubsystemName(int subsystem)
+{
+	switch (subsystem) {
+		case SyncStateUnits: return "units";
+		case SyncStatePlayers: return "players";
+		case SyncStateMap: return "map";
+		default: return "unknown";
+	}
+}
+
+/**
+**  Write the current state of the objects of a part,
+**  to compare them with the dump of another computer.
+**
+**  @param file       Output file.
+**  @param subsystem  Subsystem of the part.
+**  @param part       Index of the part.
+*/
+void CSyncState::DumpPart(FILE *file, int subsystem, int part)
+{
+	switch (subsystem) {
+		case SyncStateUnits: {
+			const unsigned int slotCount = UnitManager->GetUsedSlotCount();
+			const unsigned int end = std::min<unsigned int>((part + 1) * SyncStateUnitsPerPart, slotCount);
+			for (unsigned int i = part * SyncStateUnitsPerPart; i < end; ++i) {
+				const CUnit &unit = UnitManager->GetSlotUnit(i);
+				if (unit.Destroyed || unit.Type == NULL) {
+					fprintf(file, "unit %u: destroyed\n", i);
+					continue;
+				}
+				fprintf(file, "unit %u: %s player %d%s pos %d,%d (%d,%d) order %d resource %d:%d\n",
+						i, unit.Type->Ident.c_str(), unit.Player ? unit.Player->Index : -1,
+						unit.Removed ? " removed" : "", unit.tilePos.x, unit.tilePos.y, unit.IX, unit.IY,
+						unit.Orders.empty() ? -1 : unit.CurrentAction(), unit.CurrentResource, unit.ResourcesHeld);
+				if (unit.Variable) {
+					const unsigned int count = UnitTypeVar.GetNumberVariable();
+					for (unsigned int j = 0; j != count; ++j) {
+						fprintf(file, "  %s %d/%d\n", UnitTypeVar.VariableNameLookup[j],
+								unit.Variable[j].Value, unit.Variable[j].Max);
+					}
+				}
+			}
+			break;
+		}
+		case SyncStatePlayers: {
+			if (part >= NumPlayers) {
+				break;
+			}
+			const CPlayer &player = Players[part];
+			fprintf(file, "player %d: supply %d demand %d buildings %d score %d kills %d\n",
+					part, player.Supply, player.Demand, player.NumBuildings, player.Score, player.TotalKills);
+			for (int i = 0; i != MaxCosts; ++i) {
+				fprintf(file, "  %s %d stored %d max %d\n", DefaultResourceNames[i].c_str(),
+						player.Resources[i], player.StoredResources[i], player.MaxResources[i]);
+			}
+			break;
+		}
+		case SyncStateMap: {
+			if (!Map.Fields) {
+				break;
+			}
+			const int rowsPerPart = MapRowsPerPart();
+			const int end = std::min((part + 1) * rowsPerPart, (int)Map.Info.MapHeight);
+			for (int y = part * rowsPerPart; y < end; ++y) {
+				for (int x = 0; x != Map.Info.MapWidth; ++x) {
+					const CMapField &mf = *Map.Field(x, y);
+					fprintf(file, "field %d,%d: flags %X value %u\n", x, y, mf.Flags, mf.Value);
+				}
+			}
+			break;
+		}
+	}
+}
+
+//@}
@@ -307,4 +307,9 @@ namespace gcn
 	{
 		mUseDirtyDrawing = useDirtyDrawing;
 	}
+
+	bool Gui::getUseDirtyDrawing() const
+	{
+		return mUseDirtyDrawing;
+	}
 }
@@ -180,6 +180,13 @@ namespace gcn
 
 		virtual void setUseDirtyDrawing(bool useDirtyDrawing);
 
+        /**
+         * Checks if the top widget is only drawn when it is dirty.
+         *
+         * @return true if dirty drawing is used.
+         */
+		virtual bool getUseDirtyDrawing() const;
+
     protected:
         bool mTopHasMouse;
         bool mTabbing;
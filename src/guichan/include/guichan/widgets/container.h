@@ -180,6 +180,15 @@ namespace gcn
          */
         virtual void drawChildren(Graphics* graphics);
 
+        /**
+         * Draws one child of the Container, with its border, if it is
+         * visible.
+         *
+         * @param graphics the Graphics object to draw with.
+         * @param widget the child to draw.
+         */
+        virtual void drawChild(Graphics* graphics, Widget* widget);
+
         /**
          * Calls the logic function for all children of Container. The Widgets
          * logic function will be called in the order the Widgets were added
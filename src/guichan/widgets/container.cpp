@@ -127,27 +127,34 @@ namespace gcn
         WidgetIterator iter;
         for (iter = mWidgets.begin(); iter != mWidgets.end(); iter++)
         {
-            if ((*iter)->isVisible())
-            {
-                // If the widget has a border,
-                // draw it before drawing the widget
-                if ((*iter)->getBorderSize() > 0)
-                {
-                    Rectangle rec = (*iter)->getDimension();
-                    rec.x -= (*iter)->getBorderSize();
-                    rec.y -= (*iter)->getBorderSize();
-                    rec.width += 2 * (*iter)->getBorderSize();
-                    rec.height += 2 * (*iter)->getBorderSize();
-                    graphics->pushClipArea(rec);
-                    (*iter)->drawBorder(graphics);
-                    graphics->popClipArea();
-                }
+            drawChild(graphics, *iter);
+        }
+    }
 
-                graphics->pushClipArea((*iter)->getDimension());
-                (*iter)->draw(graphics);
-                graphics->popClipArea();
-            }
+    void Container::drawChild(Graphics* graphics, Widget* widget)
+    {
+        if (!widget->isVisible())
+        {
+            return;
         }
+
+        // If the widget has a border,
+        // draw it before drawing the widget
+        if (widget->getBorderSize() > 0)
+        {
+            Rectangle rec = widget->getDimension();
+            rec.x -= widget->getBorderSize();
+            rec.y -= widget->getBorderSize();
+            rec.width += 2 * widget->getBorderSize();
+            rec.height += 2 * widget->getBorderSize();
+            graphics->pushClipArea(rec);
+            widget->drawBorder(graphics);
+            graphics->popClipArea();
+        }
+
+        graphics->pushClipArea(widget->getDimension());
+        widget->draw(graphics);
+        graphics->popClipArea();
     }
 
     void Container::setOpaque(bool opaque)
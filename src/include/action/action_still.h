@@ -37,7 +37,9 @@
 class COrder_Still : public COrder
 {
 public:
-	explicit COrder_Still(bool stand) : COrder(stand ? UnitActionStandGround : UnitActionStill), State(0), Sleep(0) {}
+	explicit COrder_Still(bool stand) :
+		COrder(stand ? UnitActionStandGround : UnitActionStill), State(0), Sleep(0),
+		Quiet(false), QuietSince(0) {}
 
 	virtual COrder_Still *Clone() const { return new COrder_Still(*this); }
 
@@ -52,10 +54,14 @@ public:
 	virtual void UpdatePathFinderData(PathFinderInput &input) { UpdatePathFinderData_NotCalled(input); }
 private:
 	bool AutoAttackStand(CUnit &unit);
+	bool AutoAttackStill(CUnit &unit);
 	bool AutoCastStand(CUnit &unit);
+	bool MayHaveEnemyInRange(const CUnit &unit, int range) const;
 
 	unsigned char State;
 	unsigned char Sleep;
+	bool Quiet;                /// No enemy was found by the last attack scan
+	unsigned long QuietSince;  /// Game cycle of the last attack scan which found no enemy
 };
 
 //@}
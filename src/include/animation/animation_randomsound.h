@@ -45,7 +45,7 @@ public:
 	virtual void Action(CUnit &unit, int &move, int scale) const;
 	virtual void Init(const char *s, lua_State *l);
 
-	void MapSound();
+	void MapSound(bool prefetch = false);
 private:
 	std::vector<SoundConfig> sounds;
 };
@@ -133,6 +133,15 @@ extern std::string PrintDependencies(const CPlayer &player, const ButtonAction &
 extern bool CheckDependByIdent(const CPlayer &player, const std::string &target);
 /// Check a dependency by unit type
 extern bool CheckDependByType(const CPlayer &player, const CUnitType &type);
+/// Check a dependency by upgrade
+extern bool CheckDependByUpgrade(const CPlayer &player, const CUpgrade &upgrade);
+
+/// Tell the dependency cache that a unit count of a player has changed
+extern void DependUnitTypeCountChanged(const CPlayer &player, const CUnitType &type);
+/// Tell the dependency cache that an upgrade of a player has changed
+extern void DependUpgradeChanged(const CPlayer &player, int id);
+/// Throw away the dependency cache of a player
+extern void DependPlayerReset(const CPlayer &player);
 //@}
 
 #endif // !__DEPEND_H__
@@ -0,0 +1,116 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name distancefield.h - The resource distance fields header file. */
+//
+//      (c) Copyright 2024 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#ifndef __DISTANCEFIELD_H__
+#define __DISTANCEFIELD_H__
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include <vector>
+#include "vec2i.h"
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+class CPlayer;
+class CUnit;
+class CUnitType;
+
+/**
+**  Number of steps from each tile to the nearest source tile.
+**
+**  Steps go to the 8 neighbours, like TerrainTraversal. A path can only
+**  cross passable tiles; source tiles have distance 0 and blocked tiles
+**  are never reached.
+**
+**  When a tile changes its state, UpdateTile() repairs only the
+**  distances which depend on it: the tiles which lose their shortest
+**  path are reset, then refilled from their still valid neighbours.
+*/
+class CDistanceField
+{
+public:
+	enum TileState {
+		Blocked,
+		Passable,
+		Source
+	};
+	static constexpr unsigned short Infinity = 0xFFFF;
+
+	void Init(int width, int height);
+	void SetState(const Vec2i &pos, TileState state) { states[Index(pos)] = state; }
+	void Build();
+	void UpdateTile(const Vec2i &pos, TileState state);
+
+	TileState GetState(const Vec2i &pos) const { return TileState(states[Index(pos)]); }
+	unsigned short Get(const Vec2i &pos) const { return distances[Index(pos)]; }
+	bool FindNearestSource(const Vec2i &startPos, Vec2i *sourcePos) const;
+
+private:
+	unsigned int Index(const Vec2i &pos) const { return pos.y * width + pos.x; }
+	bool IsInside(const Vec2i &pos) const { return 0 <= pos.x && pos.x < width && 0 <= pos.y && pos.y < height; }
+	unsigned short SupportedDistance(const Vec2i &pos) const;
+
+private:
+	int width;
+	int height;
+	std::vector<unsigned short> distances;  /// Steps to the nearest source
+	std::vector<unsigned char> states;      /// TileState of each tile
+};
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+/// Find the nearest tile with resmask, using the player distance field
+extern bool DistanceFieldFindTerrain(const CPlayer &player, int movemask, int resmask, int range,
+									 const Vec2i &startPos, Vec2i *terrainPos);
+/// Find the nearest reachable deposit, using the player distance field
+extern CUnit *DistanceFieldFindDeposit(const CUnit &unit, int range, int resource);
+
+/// Tell the distance fields that the flags of a tile have changed
+extern void DistanceFieldsTileChanged(const Vec2i &pos);
+/// Tell the deposit fields that a unit which may be a deposit has changed
+extern void DistanceFieldsDepotChanged(const CUnitType &type);
+/// Tell the deposit fields that the diplomacy between players has changed
+extern void DistanceFieldsAlliancesChanged();
+/// Tell the distance fields that a player has explored a tile
+extern void DistanceFieldsTileExplored(const CPlayer &player, const Vec2i &pos);
+/// Drop the distance fields which depend on the explored tiles
+extern void DistanceFieldsExploredChanged();
+/// Free all the distance fields
+extern void CleanDistanceFields();
+
+//@}
+
+#endif // !__DISTANCEFIELD_H__
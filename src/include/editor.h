@@ -43,6 +43,7 @@
 --  Declarations
 ----------------------------------------------------------------------------*/
 
+class CMapField;
 class CUnitType;
 
 
@@ -108,6 +109,26 @@ public:
 
 };
 
+/// Terrain of a map field, as restored by the editor undo
+struct EditorTileState {
+	bool operator==(const EditorTileState &rhs) const
+	{
+		return Tile == rhs.Tile && SeenTile == rhs.SeenTile && Flags == rhs.Flags && Value == rhs.Value;
+	}
+
+	unsigned short Tile;      /// Graphic tile
+	unsigned short SeenTile;  /// Last seen tile
+	unsigned int Flags;       /// Field flags, without the unit flags
+	unsigned int Value;       /// Wall HP or resources
+};
+
+/// A map field changed by a terrain edit
+struct EditorTileChange {
+	unsigned int Index;       /// Map field index
+	EditorTileState Before;   /// Terrain before the edit
+	EditorTileState After;    /// Terrain after the edit
+};
+
 /*----------------------------------------------------------------------------
 --  Variables
 ----------------------------------------------------------------------------*/
@@ -139,7 +160,16 @@ extern void EditorCclRegister();
 /// Update surroundings for tile changes
 extern void EditorTileChanged(const Vec2i &pos);
 
-extern void EditorChangeTile(const Vec2i &pos, int tileIndex, int d, bool changeSurroundings);
+extern void EditorChangeTile(const Vec2i &pos, int tileIndex, const Vec2i &lock_pos, bool changeSurroundings);
+/// Set the tile of a field without fixing its surroundings
+extern void EditorSetTileIndex(const Vec2i &pos, int tileIndex);
+
+/// Start a terrain edit, which fixes the surroundings once at its end
+extern void EditorBeginTileEdit();
+/// End a terrain edit and get the fields it changed
+extern void EditorEndTileEdit(std::vector<EditorTileChange> *changes);
+/// Put back the terrain before (or after) an edit
+extern void EditorRestoreTiles(const std::vector<EditorTileChange> &changes, bool redo);
 
 //@}
 
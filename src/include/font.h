@@ -68,6 +68,7 @@
 ----------------------------------------------------------------------------*/
 class CGraphic;
 class CFontColor;
+struct SDL_Surface;
 
 /// Font definition
 class CFont : public gcn::Font
@@ -98,10 +99,8 @@ public:
 	void Reload() const;
 	void Clean();
 
-	CGraphic *GetFontColorGraphic(const CFontColor &fontColor) const;
-
-	template<bool CLIP>
-	unsigned int DrawChar(CGraphic &g, int utf8, int x, int y, const CFontColor &fc) const;
+	SDL_Surface *GetFontColorGraphic(const CFontColor &fontColor) const;
+	void GetGlyph(int utf8, int *gx, int *gy, int *w) const;
 
 	void DynamicLoad() const;
 
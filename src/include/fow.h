@@ -86,6 +86,7 @@ public:
     void Draw(CViewport &viewport);
     
     uint8_t GetVisibilityForTile(const Vec2i tilePos) const;
+    bool TakeVisibilityChanges(std::vector<unsigned int> &tiles);
 
 private:
     void InitEnhanced();
@@ -96,10 +97,6 @@ private:
     void GenerateFog();
     void FogUpscale4x4();
 
-    uint8_t DeterminePattern(const size_t index, const uint8_t visFlag) const;
-    void FillUpscaledRec(uint32_t *texture, const uint16_t textureWidth, size_t index, 
-                         const uint8_t patternVisible, const uint8_t patternExplored) const;
-
     void UpscaleBilinear(const uint8_t *const src, const SDL_Rect &srcRect, const int16_t srcWidth,
                          SDL_Surface *const trgSurface, const SDL_Rect &trgRect) const;
 
@@ -155,6 +152,8 @@ private:
     std::vector<uint8_t> VisTable;            /// vision table for whole map + 1 tile around (for simplification of upscale algorithm purposes)
     size_t               VisTable_Index0 {0}; /// index in the vision table for [0:0] map tile
     size_t               VisTableWidth   {0}; /// width of the vision table
+    std::vector<unsigned int> VisChanges;     /// Map indexes of the tiles whose visibility changed since TakeVisibilityChanges
+    bool                 AllVisChanged   {true}; /// All the tiles have to be considered changed
     CEasedTexture        FogTexture;          /// Upscaled fog texture (alpha-channel values only) for whole map 
                                               /// + 1 tile to the left and up (for simplification of upscale algorithm purposes).
     std::vector<uint8_t> RenderedFog;         /// Back buffer for bilinear upscaling in to viewports
@@ -207,53 +206,6 @@ private:
 extern CFogOfWar *FogOfWar;
 
 
-/**
-**  Determine upscale patterns (index in the upscale table) for Visible and Explored layers
-**
-**  @param  index       tile in the vision table 
-**  @param  visFlag     layer to determine pattern for
-**
-*/
-inline uint8_t CFogOfWar::DeterminePattern(const size_t index, const uint8_t visFlag) const
-{
-    Assert(visFlag == VisionType::cVisible || visFlag == (VisionType::cExplored | VisionType::cVisible));
-
-    uint8_t n1, n2, n3, n4;
-    size_t offset = index;
-
-    n1 = (visFlag & VisTable[offset]);
-    n2 = (visFlag & VisTable[offset + 1]);
-    offset += VisTableWidth;
-    n3 = (visFlag & VisTable[offset]);
-    n4 = (visFlag & VisTable[offset + 1]);
-    
-    n1 >>= n1 - VisionType::cExplored;
-    n2 >>= n2 - VisionType::cExplored;
-    n3 >>= n3 - VisionType::cExplored;
-    n4 >>= n4 - VisionType::cExplored;
-    
-    return ( (n1 << 3) | (n2 << 2) | (n3 << 1) | n4 );
-}
-
-/**
-**  Fill 4x4 sized tile in the fog texture according to the patterns
-**
-**  @param  texture         pointer to the texture to fill
-**  @param  textureWidth    width of the texture
-**  @param  index           index of the tile to fill
-**  @param  patternVisible  index int the upscale table for Visible layer
-**  @param  patternExplored index int the upscale table for Explored layer
-**
-*/
-inline void CFogOfWar::FillUpscaledRec(uint32_t *texture, const uint16_t textureWidth, size_t index, 
-                                        const uint8_t patternVisible, const uint8_t patternExplored) const
-{
-    for (uint8_t scan_line = 0; scan_line < 4; scan_line++) {
-        texture[index] = UpscaleTableVisible[patternVisible][scan_line] + CurrUpscaleTableExplored[patternExplored][scan_line];
-        index += textureWidth;
-    }
-}
-
 inline uint8_t CFogOfWar::GetVisibilityForTile(const Vec2i tilePos) const
 {
     return VisTable[VisTable_Index0 + tilePos.x + VisTableWidth * tilePos.y];
@@ -91,13 +91,16 @@ public:
     
     void Clean();
     void Blur(uint8_t *const texture);
+
+    void SetVectorized(const bool enable) { Vectorized = enable; }
 private:
-    void ProceedIteration(uint8_t *source, uint8_t *target, const uint8_t radius);
+    void ProceedIteration(uint8_t *texture, uint8_t *backBuffer, const uint8_t radius);
 
 private:
     float   Radius          {2}; /// From 1 to 3 is optimal. With 3 result is very smooth, 
                                  /// but it opens about 1/2 extra tiles around SightRange circle
     uint8_t NumOfIterations {3}; /// 2-3 is optimal, with higher values result enhancing not so radicaly
+    bool    Vectorized   {true}; /// Use the SIMD passes if there are any for this CPU. The scalar ones are their reference
 
     std::vector<uint8_t> HalfBoxes; /// Radiuses (box sizes) for box blur iterations
     std::vector<uint8_t> WorkingTexture;  /// Back buffer
@@ -105,6 +108,12 @@ private:
     uint16_t TextureHeight {0};
 };
 
+/// 4x4 upscale the vision table into the fog texture
+extern void UpscaleVisTable4x4(const uint8_t *const visTable, const size_t visTableWidth,
+                               uint32_t *const texture, const uint16_t textureWidth, const uint16_t textureHeight,
+                               const uint32_t (*tableVisible)[4], const uint32_t (*tableExplored)[4],
+                               const bool vectorized = true);
+
 /// returns pixel value for current frame
 inline uint8_t CEasedTexture::GetPixel(const uint16_t x, const uint16_t y)
 {
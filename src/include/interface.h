@@ -369,6 +369,8 @@ extern void UpdateMessages();
 extern void DrawMessages();
 /// Draw the player resource in resource line
 extern void DrawResources();
+/// Free the cached info panel and resource line
+extern void CleanPanelCaches();
 /// Set message to display
 extern void SetMessage(const char *fmt, ...) PRINTF_VAARG_ATTRIBUTE(1, 2);
 /// Set message to display with event point
@@ -84,6 +84,7 @@
 ----------------------------------------------------------------------------*/
 
 #include <string>
+#include <vector>
 
 #ifndef __MAP_TILE_H__
 #include "tile.h"
@@ -112,6 +113,8 @@ class CUnitType;
 #define MaxMapWidth  1024  /// max map width supported
 #define MaxMapHeight 1024  /// max map height supported
 
+#define MapSectorShift 3   /// Unit entries are tracked by sectors of 8x8 tiles
+
 /*----------------------------------------------------------------------------
 --  Map info structure
 ----------------------------------------------------------------------------*/
@@ -238,6 +241,13 @@ public:
 	/// Remove unit from cache
 	void Remove(CUnit &unit);
 
+	/// Has a unit of the players entered the area since the cycle
+	bool HasUnitEnteredSince(const Vec2i &minPos, const Vec2i &maxPos, unsigned int playerMask, unsigned long cycle) const;
+	/// Forget the unit entries, sized for the map
+	void ResetSectorEntryCycles();
+	/// Restore a unit entry of a saved game
+	void SetSectorEntryCycle(unsigned int index, unsigned long cycle);
+
 	void Clamp(Vec2i &pos) const;
 
 	//Warning: we expect typical usage as xmin = x - range
@@ -264,6 +274,12 @@ private:
 	/// Regenerate the forest.
 	void RegenerateForestTile(const Vec2i &pos);
 
+	std::vector<unsigned int> RegrowthCandidates; /// Index of the fields with removed trees
+	bool RegrowthCandidatesValid { false };      /// False if RegrowthCandidates must be rebuilt
+
+	/// Last game cycle a unit of each player entered each sector, [sector * PlayerMax + player]
+	std::vector<unsigned long> SectorEntryCycles;
+
 public:
 	CMapField *Fields;              	/// fields on map
 	bool NoFogOfWar;           			/// fog of war disabled
@@ -357,6 +373,10 @@ inline void SetTile(unsigned int tile, int x, int y, int value = 0)
 	const Vec2i pos(x, y);
 	SetTile(tile, pos, value);
 }
+/// Set the tiles from a binary terrain file
+extern int LoadMapTerrain(const std::string &file);
+/// Write the tiles of a map to a binary terrain file
+extern void SaveMapTerrain(const std::string &file, const CMap &map, Vec2i size, Vec2i offset);
 
 /// register ccl features
 extern void MapCclRegister();
@@ -420,6 +420,12 @@ public:
 
 	static Missile *Init(const MissileType &mtype, const PixelPos &startPos, const PixelPos &destPos);
 
+	/// Missiles reuse the memory of the deleted ones
+	static void *operator new(size_t size);
+	static void operator delete(void *p, size_t size);
+	/// Free the memory kept for reuse
+	static void FreePool();
+
 	virtual void Action() = 0;
 
 	void DrawMissile(const CViewport &vp) const;
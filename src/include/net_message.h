@@ -35,6 +35,7 @@
 #include <vector>
 
 #include "settings.h"
+#include "syncstate.h"
 
 /*----------------------------------------------------------------------------
 --  Declarations
@@ -48,6 +49,8 @@
 
 #define MaxNetworkCommands 9  /// Max Commands In A Packet
 
+#define MaxNetworkPacketSize 1024  /// Max size of an in-game packet
+
 /**
 **  Network systems active in current game.
 */
@@ -68,6 +71,10 @@ public:
 	uint16_t Port;         /// Port on host
 	uint16_t PlyNr;        /// Player number
 	char PlyName[NetPlayerNameSize];  /// Name of player
+
+	// Runtime only, not serialized
+	unsigned long Rtt;        /// Smoothed round trip time in ms
+	unsigned long RttJitter;  /// Smoothed round trip time deviation in ms
 };
 
 ENUM_CLASS SlotOption : uint8_t {
@@ -230,7 +237,7 @@ private:
 	CInitMessage_Header header;
 public:
 	char PlyName[NetPlayerNameSize];  /// Name of player
-	int32_t Stratagus;  /// Stratagus engine version
+	int32_t Stratagus;  /// Network protocol version, the engine version with the message revision
 	uint32_t Version;   /// Lua files version
 };
 
@@ -260,7 +267,7 @@ public:
 private:
 	CInitMessage_Header header;
 public:
-	int32_t Stratagus;  /// Stratagus engine version
+	int32_t Stratagus;  /// Network protocol version, the engine version with the message revision
 };
 
 class CInitMessage_LuaFilesMismatch
@@ -375,6 +382,12 @@ enum _message_type_ {
 
 	MessageChat,                   /// Chat message
 
+	MessagePing,                   /// Round trip time probe (server to client)
+	MessagePong,                   /// Round trip time probe answer
+	MessageLag,                    /// Change network lag
+	MessageSyncState,              /// Full game state hashes
+	MessageSyncStateParts,         /// Game state part hashes, to locate a desync
+
 	MessageCommandStop,            /// Unit command stop
 	MessageCommandStand,           /// Unit command stand ground
 	MessageCommandDefend,          /// Unit command defend
@@ -503,6 +516,72 @@ public:
 	uint16_t player;
 };
 
+/**
+**  Network ping/pong message, used to measure the round trip time.
+*/
+class CNetworkPing
+{
+public:
+	CNetworkPing() : ticks(0) {}
+	size_t Serialize(unsigned char *buf) const;
+	size_t Deserialize(const unsigned char *buf);
+	static size_t Size() { return 4; };
+
+public:
+	uint32_t ticks;  /// Sender ticks when the ping was sent
+};
+
+/**
+**  Network lag change message.
+*/
+class CNetworkCommandLag
+{
+public:
+	CNetworkCommandLag() : lag(0) {}
+	size_t Serialize(unsigned char *buf) const;
+	size_t Deserialize(const unsigned char *buf);
+	static size_t Size() { return 2; };
+
+public:
+	uint16_t lag;  /// New network lag in game cycles
+};
+
+/**
+**  Network full game state hashes message.
+*/
+class CNetworkSyncState
+{
+public:
+	CNetworkSyncState() : player(0), cycle(0) { memset(hash, 0, sizeof(hash)); }
+	size_t Serialize(unsigned char *buf) const;
+	size_t Deserialize(const unsigned char *buf);
+	static size_t Size() { return 2 + 4 + 4 * SyncStateSubsystemCount; };
+
+public:
+	uint16_t player;                         /// Sender
+	uint32_t cycle;                          /// Game cycle of the hashed state
+	uint32_t hash[SyncStateSubsystemCount];  /// Hash per subsystem
+};
+
+/**
+**  Network game state part hashes message.
+*/
+class CNetworkSyncStateParts
+{
+public:
+	CNetworkSyncStateParts() : player(0), cycle(0), subsystem(0), offset(0) {}
+	size_t Serialize(unsigned char *buf) const;
+	size_t Deserialize(const unsigned char *buf);
+	size_t Size() const { return 2 + 4 + 1 + 2 + 2 + 4 * parts.size(); }
+
+public:
+	uint16_t player;              /// Sender
+	uint32_t cycle;               /// Game cycle of the hashed state
+	uint8_t subsystem;            /// Subsystem of the parts
+	uint16_t offset;              /// Index of the first part
+	std::vector<uint32_t> parts;  /// Part hashes
+};
+
 /**
 **  Network Selection Update
 */
@@ -544,10 +623,31 @@ public:
 	uint8_t OrigPlayer;                /// Host address
 };
 
+/**
+**  Copy of the commands of an earlier update, piggybacked on a packet
+**  so that a single lost packet does not stall the game.
+*/
+class CNetworkRedundantCommands
+{
+public:
+	CNetworkRedundantCommands() : Cycle(0), NumCommands(0) { memset(Type, 0, sizeof(Type)); }
+
+	size_t Serialize(unsigned char *buf) const;
+	size_t Deserialize(const unsigned char *buf, unsigned int len);
+	size_t Size() const { return Serialize(NULL); }
+
+	uint8_t Cycle;                     /// Destination game cycle
+	uint8_t NumCommands;               /// Number of commands
+	uint8_t Type[MaxNetworkCommands];  /// Commands in block
+	std::vector<unsigned char> Command[MaxNetworkCommands];
+};
+
 /**
 **  Network packet.
 **
 **  This is sent over the network.
+**  The commands of the packet cycle are followed by
+**  optional redundant copies of the previous updates.
 */
 class CNetworkPacket
 {
@@ -555,9 +655,11 @@ public:
 	size_t Serialize(unsigned char *buf, int numcommands) const;
 	void Deserialize(const unsigned char *buf, unsigned int len, int *numcommands);
 	size_t Size(int numcommands) const;
+	static size_t CommandSize(const std::vector<unsigned char> &command);
 
 	CNetworkPacketHeader Header;  /// Packet Header Info
 	std::vector<unsigned char> Command[MaxNetworkCommands];
+	std::vector<CNetworkRedundantCommands> Redundant;  /// Previous updates
 };
 
 //@}
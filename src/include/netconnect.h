@@ -40,21 +40,33 @@ class CHost;
 --  Defines
 ----------------------------------------------------------------------------*/
 
-/// Network protocol major version
+/// Network protocol major version (maximum 99)
 #define NetworkProtocolMajorVersion StratagusMajorVersion
 /// Network protocol minor version (maximum 99)
 #define NetworkProtocolMinorVersion StratagusMinorVersion
 /// Network protocol patch level (maximum 99)
 #define NetworkProtocolPatchLevel   StratagusPatchLevel
-/// Network protocol version (1,2,3) -> 10203
-#define NetworkProtocolVersion \
+/// Revision of the in-game messages on top of the engine version, bump it when they change
+#define NetworkProtocolRevision     1
+/// Engine part of the network protocol version (1,2,3) -> 10203
+#define NetworkProtocolEngineVersion \
 	(NetworkProtocolMajorVersion * 10000 + NetworkProtocolMinorVersion * 100 + \
 	 NetworkProtocolPatchLevel)
+/// Network protocol version (1,2,3) revision 4 -> 4010203
+#define NetworkProtocolVersion \
+	(NetworkProtocolRevision * 1000000 + NetworkProtocolEngineVersion)
+
+/// Engine part of a network protocol version
+#define NetworkProtocolEngineOf(v) ((v) % 1000000)
+/// Message revision part of a network protocol version
+#define NetworkProtocolRevisionOf(v) ((v) / 1000000)
 
 /// Network protocol printf format string
-#define NetworkProtocolFormatString "%d.%d.%d"
+#define NetworkProtocolFormatString "%d.%d.%d-r%d"
 /// Network protocol printf format arguments
-#define NetworkProtocolFormatArgs(v) (v) / 10000, ((v) / 100) % 100, (v) % 100
+#define NetworkProtocolFormatArgs(v) \
+	NetworkProtocolEngineOf(v) / 10000, (NetworkProtocolEngineOf(v) / 100) % 100, \
+	NetworkProtocolEngineOf(v) % 100, NetworkProtocolRevisionOf(v)
 
 /*----------------------------------------------------------------------------
 --  Declarations
@@ -55,6 +55,9 @@ public:
 	unsigned int gameCyclesPerUpdate;  /// Network update each # game cycles
 	unsigned int NetworkLag;      /// Network lag (# update cycles)
 	unsigned int timeoutInS;      /// Number of seconds until player times out
+	unsigned int redundantUpdates; /// Number of previous updates resent in each packet
+	bool adaptiveLag;             /// Server adapts the lag to the measured round trip times
+	unsigned int syncStateInterval; /// Game cycles between full state sync checks, 0 to disable
 
 public:
 	static const int defaultPort = 6660; /// Default communication port
@@ -81,6 +84,7 @@ extern void NetworkEvent();  /// Handle network events
 extern void NetworkSync();   /// Hold in sync
 extern void NetworkQuitGame();  /// Quit game: warn other users
 extern void NetworkRecover();   /// Recover network
+extern void NetworkPrintStatistics(unsigned long ticks); /// Print network statistics of the game
 extern void NetworkCommands();  /// Get all network commands
 extern void NetworkSendChatMessage(const std::string &msg);  /// Send chat message
 /// Send network command.
@@ -0,0 +1,126 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name netimpairment.h - Simulated network impairment. */
+//
+//      (c) Copyright 2024 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+#ifndef NETIMPAIRMENT_H
+#define NETIMPAIRMENT_H
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "network/netsockets.h"
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/**
+**  Network conditions to simulate on outgoing UDP packets.
+**
+**  Used to test the lockstep, resend and recover logic under latency,
+**  jitter, reordering and loss without a real network.
+*/
+class CNetworkImpairment
+{
+public:
+	CNetworkImpairment() : Delay(0), Jitter(0), NormalJitter(false), Loss(0), Duplicate(0), Reorder(0), Seed(0) {}
+
+	bool Parse(const std::string &spec);
+	bool IsEnabled() const { return Delay || Jitter || Loss || Duplicate || Reorder; }
+
+public:
+	unsigned int Delay;      /// Mean one way delay in ms
+	unsigned int Jitter;     /// Delay deviation in ms
+	bool NormalJitter;       /// Jitter is normally distributed (standard deviation) instead of uniform
+	unsigned int Loss;       /// Lost packets in percent
+	unsigned int Duplicate;  /// Duplicated packets in percent
+	unsigned int Reorder;    /// Packets held back behind the next ones in percent
+	unsigned int Seed;       /// Random seed, to replay the same conditions
+
+	static CNetworkImpairment Instance;
+};
+
+/**
+**  Outgoing packets delayed by a simulated network.
+*/
+class CImpairedPacketQueue
+{
+public:
+	explicit CImpairedPacketQueue(const CNetworkImpairment &impairment);
+
+	void Push(const CHost &host, const void *buf, unsigned int len, unsigned long now);
+	bool Pop(unsigned long now, CHost *host, std::vector<unsigned char> *data);
+	bool IsEmpty() const { return Packets.empty(); }
+	unsigned long NextDue() const { return Packets.top().Due; }
+
+	class CStatistic
+	{
+	public:
+		CStatistic() : sentCount(0), droppedCount(0), duplicatedCount(0), reorderedCount(0) {}
+	public:
+		unsigned int sentCount;
+		unsigned int droppedCount;
+		unsigned int duplicatedCount;
+		unsigned int reorderedCount;
+	};
+	const CStatistic &getStatistic() const { return Statistic; }
+
+private:
+	unsigned long ComputeDelay();
+
+	struct Packet {
+		unsigned long Due;       /// Time to really send the packet
+		unsigned long Sequence;  /// Keep send order for equal due times
+		CHost Host;
+		std::vector<unsigned char> Data;
+	};
+	struct Later {
+		bool operator()(const Packet &lhs, const Packet &rhs) const
+		{
+			return lhs.Due != rhs.Due ? lhs.Due > rhs.Due : lhs.Sequence > rhs.Sequence;
+		}
+	};
+
+	CNetworkImpairment Impairment;
+	std::priority_queue<Packet, std::vector<Packet>, Later> Packets;
+	std::mt19937 Random;
+	unsigned long Sequence;
+	CStatistic Statistic;
+};
+
+//@}
+
+#endif // !NETIMPAIRMENT_H
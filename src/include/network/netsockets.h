@@ -51,6 +51,7 @@ private:
 	int port;
 };
 
+class CImpairedPacketQueue;
 class CUDPSocket_Impl;
 class CTCPSocket_Impl;
 
@@ -68,6 +69,8 @@ public:
 	int HasDataToRead(int timeout);
 	bool IsValid() const;
 	int GetSocketAddresses(unsigned long *ips, int maxAddr);
+	/// Simulated network the packets are sent through, NULL if none
+	const CImpairedPacketQueue *GetImpairment() const;
 
 #ifdef DEBUG
 
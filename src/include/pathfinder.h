@@ -42,7 +42,7 @@
 --  Declarations
 ----------------------------------------------------------------------------*/
 
-#include <queue>
+#include <vector>
 #include "vec2i.h"
 
 class CUnit;
@@ -131,13 +131,27 @@ enum VisitResult {
 	VisitResult_Cancel
 };
 
+/**
+**  Breadth first traversal of the map.
+**
+**  The working memory is taken from a pool and reused between
+**  traversals. Init() only increments a generation stamp, so a search
+**  costs the area it visits, not the area of the map. SetWindow() can
+**  also restrict a range-limited search to its bounding box.
+*/
 class TerrainTraversal
 {
 public:
 	typedef short int dataType;
 public:
+	TerrainTraversal();
+	~TerrainTraversal();
+
 	void SetSize(unsigned int width, unsigned int height);
 	void Init();
+	void SetWindow(const Vec2i &minPos, const Vec2i &maxPos);
+	void SetWindowAround(const Vec2i &pos, int range);
+	void SetWindowAround(const CUnit &unit, int range);
 
 	void PushPos(const Vec2i &pos);
 	void PushNeighboor(const Vec2i &pos);
@@ -153,27 +167,46 @@ public:
 	// Accept pos to be at one inside the real map
 	dataType Get(const Vec2i &pos) const;
 
-private:
-	void Set(const Vec2i &pos, dataType value);
+	static void FreeWorkspaces();
 
 	struct PosNode {
 		PosNode(const Vec2i &pos, const Vec2i &from) : pos(pos), from(from) {}
 		Vec2i pos;
 		Vec2i from;
 	};
+	struct Workspace {
+		Workspace() : generation(0) {}
+
+		std::vector<dataType> values;        /// Distance from start, valid if stamp is current
+		std::vector<unsigned short> stamps;  /// Generation which has written the value
+		unsigned short generation;           /// Current generation
+		std::vector<PosNode> queue;          /// Nodes to visit, from queueHead
+	};
+
+private:
+	TerrainTraversal(const TerrainTraversal &);
+	TerrainTraversal &operator =(const TerrainTraversal &);
+
+	unsigned int Index(const Vec2i &pos) const { return m_extented_width + 1 + pos.y * m_extented_width + pos.x; }
+	void Set(const Vec2i &pos, dataType value);
 
 private:
-	std::vector<dataType> m_values;
-	std::queue<PosNode> m_queue;
+	Workspace *m_workspace;
+	size_t m_queueHead;
 	unsigned int m_extented_width;
 	unsigned int m_height;
+	Vec2i m_windowMin;
+	Vec2i m_windowMax;
 };
 
 template <typename T>
 bool TerrainTraversal::Run(T &context)
 {
-	for (; m_queue.empty() == false; m_queue.pop()) {
-		const PosNode &posNode = m_queue.front();
+	std::vector<PosNode> &queue = m_workspace->queue;
+
+	while (m_queueHead != queue.size()) {
+		// Copy, Visit may push new nodes.
+		const PosNode posNode = queue[m_queueHead++];
 
 		switch (context.Visit(*this, posNode.pos, posNode.from)) {
 			case VisitResult_Finished: return true;
@@ -72,6 +72,13 @@ extern int LuaLoadFile(const std::string &file, const std::string &strArg = "",
 extern int LuaCall(int narg, int clear, bool exitOnError = true);
 extern int LuaCall(lua_State *L, int narg, int nresults, int base, bool exitOnError = true);
 
+/// Profile the lua calls, and warn when a function takes more than budget microseconds in a cycle
+extern void SetLuaProfiling(bool enable, int budget = 0);
+/// Forget the collected costs of the lua calls
+extern void ResetLuaProfile();
+/// Print the collected costs of the lua calls
+extern void PrintLuaProfile();
+
 #define LuaError(l, args) \
 	do { \
 		PrintFunction(); \
@@ -182,6 +189,9 @@ enum EnumUnit {
 */
 struct NumberDesc;
 
+/// Compiled form of a number description.
+struct NumberProgram;
+
 /**
 ** Unit description
 **  Use to describe complex unit in script to use when game running.
@@ -241,6 +251,7 @@ struct NumberDesc {
 			StringDesc *ResType;  /// Resource type
 		} PlayerData; /// conditional string.
 	} D;
+	mutable NumberProgram *Program = nullptr; /// Compiled on first evaluation.
 };
 
 /**
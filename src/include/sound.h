@@ -185,6 +185,9 @@ extern CSound *RegisterSound(const std::vector<std::string> &files);
 ///  Create a special sound group with two sounds
 extern CSound *RegisterTwoGroups(CSound *first, CSound *second);
 
+/// Decode the samples of a sound in the background
+extern void PrefetchSound(const CSound *sound);
+
 /// Initialize client side of the sound layer.
 extern void InitSoundClient();
 
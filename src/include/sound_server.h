@@ -67,13 +67,19 @@ extern bool UnitSoundIsPlaying(Origin *origin);
 extern bool SampleIsPlaying(Mix_Chunk *sample);
 /// Load music
 extern Mix_Music *LoadMusic(const std::string &name);
-/// Load a sample
+/// Load a sample, its data is decoded later
 extern Mix_Chunk *LoadSample(const std::string &name);
 extern void FreeSample(Mix_Chunk *sample);
+/// Decode a sample in the background
+extern void PrefetchSample(Mix_Chunk *sample);
+/// Decode a sample now, if it is not decoded yet
+extern bool DecodeSample(Mix_Chunk *sample);
 /// Play a sample
 extern int PlaySample(Mix_Chunk *sample, Origin *origin = NULL);
 /// Play a sample, registering a "finished" callback
 extern int PlaySample(Mix_Chunk *sample, void (*callback)(int channel));
+/// Play a sample now, or as soon as it is decoded
+extern void PlaySampleWhenDecoded(Mix_Chunk *sample, int volume);
 /// Play a sound file
 extern int PlaySoundFile(const std::string &name);
 
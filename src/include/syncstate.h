@@ -0,0 +1,84 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name syncstate.h - The full state sync check header file. */
+//
+//      (c) Copyright 2024 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#ifndef __SYNCSTATE_H__
+#define __SYNCSTATE_H__
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/**
+**  Parts of the game state which are hashed separately.
+*/
+enum SyncStateSubsystem {
+	SyncStateUnits,    /// Unit positions, orders, resources and variables
+	SyncStatePlayers,  /// Player resources, supply and score
+	SyncStateMap,      /// Map field flags and resource values
+	SyncStateSubsystemCount
+};
+
+#define SyncStateUnitsPerPart 32  /// Unit slots hashed in one part
+#define SyncStateMapParts 64      /// Map is hashed in this number of row bands
+
+/**
+**  Hash of the game state at a game cycle.
+**
+**  Each subsystem is split in parts (unit slot ranges, players, map row
+**  bands) so that peers can locate the first diverging object.
+*/
+class CSyncState
+{
+public:
+	CSyncState() : Cycle(0) {}
+
+	void Compute(unsigned long cycle);
+	int FindFirstDifferentPart(int subsystem, unsigned int offset, const std::vector<uint32_t> &parts) const;
+
+	static const char *GetSubsystemName(int subsystem);
+	static void DumpPart(FILE *file, int subsystem, int part);
+
+public:
+	unsigned long Cycle;                                /// Game cycle of the state
+	uint32_t Hash[SyncStateSubsystemCount];             /// Hash per subsystem
+	std::vector<uint32_t> Parts[SyncStateSubsystemCount]; /// Hash per part of subsystem
+};
+
+//@}
+
+#endif // !__SYNCSTATE_H__
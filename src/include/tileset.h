@@ -187,6 +187,7 @@ public:
 	void buildTable(lua_State *l);
 	int parseTilesetTileFlags(lua_State *l, uint64_t *back, int *j);
 	int findTileIndex(unsigned char baseTerrain, unsigned char mixTerrain = 0) const;
+	void clearTerrainTables();
 
 private:
 	unsigned int getOrAddSolidTileIndexByName(const std::string &name);
@@ -197,6 +198,8 @@ private:
 	void parseSolid(lua_State *l);
 	void parseMixed(lua_State *l);
 	int findTilePath(int base, int goal, int length, std::vector<char> &marks, int *tileIndex) const;
+	int findTilePath(int base, int goal, int *tileIndex) const;
+	void buildTerrainTables() const;
 public:
 	std::string Name;           /// Nice name to display
 	std::string ImageFile;      /// File containing image data
@@ -216,6 +219,14 @@ private:
 	uint8_t graphicalTileSizeShiftY; /// 1<<shift size for graphical tiles in Y direction
 	
 	std::vector<SolidTerrainInfo> solidTerrainTypes; /// Information about solid terrains.
+
+	// Terrain lookup tables, built by BuildTilesetTables or on first use
+	mutable int terrainCount = 0;                   /// Highest terrain used by a tile + 1
+	mutable std::vector<int> terrainTileTable;      /// First tile index of each (base, mix) pair, -1 if none
+	mutable std::vector<int> graphicTileTable;      /// First tile index of each graphic tile, -1 if none
+	mutable std::vector<std::vector<std::pair<int, int>>> terrainMixes; /// (tile index, other terrain) of the mixed tiles of each terrain
+	mutable std::vector<unsigned char> tilePathLength; /// Tile path length between each pair of terrains
+	mutable std::vector<int> tilePathTile;          /// First mixed tile of the tile path between each pair of terrains
 #if 1
 	std::vector<int> mixedLookupTable;  /// Lookup for what part of tile used
 	unsigned topOneTreeTile;   /// Tile for one tree top
@@ -52,6 +52,8 @@ public:
 
 	/// Tell how show the variable Index.
 	virtual void Draw(const CUnit &unit, CFont *defaultfont) const = 0;
+	/// True if what is drawn can change while the unit stays the same.
+	virtual bool IsVolatile() const { return false; }
 
 	virtual void Parse(lua_State *l) = 0;
 
@@ -75,6 +77,7 @@ public:
 	}
 
 	virtual void Draw(const CUnit &unit, CFont *defaultfont) const;
+	virtual bool IsVolatile() const { return Text && Text->e != EString_Dir; }
 	virtual void Parse(lua_State *l);
 
 private:
@@ -138,6 +141,7 @@ class CContentTypeIcon : public CContentType
 {
 public:
 	virtual void Draw(const CUnit &unit, CFont *defaultfont) const;
+	virtual bool IsVolatile() const { return UnitRef != UnitRefItSelf; }
 	virtual void Parse(lua_State *l);
 
 private:
@@ -177,6 +181,7 @@ public:
 	}
 
 	virtual void Draw(const CUnit &unit, CFont *defaultfont) const;
+	virtual bool IsVolatile() const { return ValueFunc != NULL; }
 	virtual void Parse(lua_State *l);
 
 private:
@@ -62,6 +62,7 @@ class CMapField;
 class COrder;
 class CPlayer;
 class CUnit;
+class CUnitColdData;
 class CUnitColors;
 class CUnitPtr;
 class CUnitStats;
@@ -131,12 +132,43 @@ enum _directions_ {
 #define NextDirection 32        /// Next direction N->NE->E...
 #define UnitNotSeen 0x7fffffff  /// Unit not seen, used by CUnit::SeenFrame
 
+/**
+**  The unit data which the simulation rarely touches.
+**
+**  It lives in a side array of the unit manager, so that the per cycle
+**  loops do not drag it through the cache with the rest of CUnit.
+*/
+class CUnitColdData
+{
+public:
+	void Init();
+
+	std::bitset<UpgradeMax> IndividualUpgrades; /// individual upgrades which the unit has
+
+	/* Seen stuff. */
+	int VisCount[PlayerMax];     /// Unit visibility counts
+	struct _seen_stuff_ {
+		_seen_stuff_() : CFrame(NULL), Type(NULL), tilePos(-1, -1) {}
+		const CConstructionFrame  *CFrame;  /// Seen construction frame
+		int         Frame;                  /// last seen frame/stage of buildings
+		const CUnitType  *Type;             /// Pointer to last seen unit-type
+		Vec2i       tilePos;                /// Last unit->tilePos Seen
+		signed char IX;                     /// Seen X image displacement to map position
+		signed char IY;                     /// seen Y image displacement to map position
+		unsigned    Constructed : 1;        /// Unit seen construction
+		unsigned    State : 3;              /// Unit seen build/upgrade state
+unsigned    Destroyed : PlayerMax;  /// Unit seen destroyed or not
+unsigned    ByPlayer : PlayerMax;   /// Track unit seen by player
+	} Seen;
+};
+
 /// The big unit structure
 class CUnit
 {
 public:
-	CUnit() : tilePos(-1, -1), pathFinderData(NULL), SavedOrder(NULL), NewOrder(NULL), CriticalOrder(NULL), Colors(-1),
-				AutoCastSpell(NULL), SpellCoolDownTimers(NULL), Variable(NULL) { Init(); }
+	explicit CUnit(CUnitColdData *cold = NULL) : tilePos(-1, -1), Variable(NULL), CriticalOrder(NULL), pathFinderData(NULL),
+				Colors(-1), SavedOrder(NULL), NewOrder(NULL), AutoCastSpell(NULL), SpellCoolDownTimers(NULL),
+				Cold(cold) { Init(); }
 	~CUnit();
 
 	void Init();
@@ -240,8 +272,8 @@ public:
 			return IsAliveOnMap();
 		} else {
 			return Type->BoolFlag[VISIBLEUNDERFOG_INDEX].value
-				   && (Seen.ByPlayer & (1 << player.Index))
-				   && !(Seen.Destroyed & (1 << player.Index));
+				   && (Cold->Seen.ByPlayer & (1 << player.Index))
+				   && !(Cold->Seen.Destroyed & (1 << player.Index));
 		}
 	}
 
@@ -318,52 +350,30 @@ public:
 		int unitSlot;       /// index in UnitManager::units
 	};
 public:
-	// @note int is faster than shorts
-	unsigned int     Refs;         /// Reference counter
-	unsigned int     ReleaseCycle; /// When this unit could be recycled
-	CUnitManagerData UnitManagerData;
-	size_t PlayerSlot;  /// index in Player->Units
+	// Per cycle state first: UnitActionsEachCycle touches mostly these fields.
 
-	int    InsideCount;   /// Number of units inside.
-	int    BoardCount;    /// Number of units transported inside.
-	CUnit *UnitInside;    /// Pointer to one of the units inside.
-	CUnit *Container;     /// Pointer to the unit containing it (or 0)
-	CUnit *NextContained; /// Next unit in the container.
-	CUnit *PrevContained; /// Previous unit in the container.
-
-	CUnit *NextWorker; //pointer to next assigned worker to "Goal" resource.
-	struct {
-		CUnit *Workers; /// pointer to first assigned worker to this resource.
-		int Assigned; /// how many units are assigned to harvesting from the resource.
-		int Active; /// how many units are harvesting from the resource.
-	} Resource; /// Resource still
+	std::vector<COrder *> Orders; /// orders to process
+	struct _unit_anim_ {
+		const CAnimation *Anim;      /// Anim
+		const CAnimation *CurrAnim;  /// CurrAnim
+		int Wait;                    /// Wait
+		int Unbreakable;             /// Unbreakable
+	} Anim;
+	unsigned int Wait;          /// action counter
 
 	Vec2i tilePos; /// Map position X
-
 	unsigned int Offset;/// Map position as flat index offset (x + y * w)
 
 	const CUnitType  *Type;        /// Pointer to unit-type (peon,...)
 	CPlayer    *Player;            /// Owner of this unit
 	const CUnitStats *Stats;       /// Current unit stats
-	int         CurrentSightRange; /// Unit's Current Sight Range
-
-	// Pathfinding stuff:
-	PathFinderData *pathFinderData;
-
-	// DISPLAY:
-	int         Frame;      /// Image frame: <0 is mirrored
-	int  Colors;            /// custom colors
-	bool IndividualUpgrades[UpgradeMax];      /// individual upgrades which the unit has
+	CVariable *Variable; /// array of User Defined variables.
 
 	signed char IX;         /// X image displacement to map position
 	signed char IY;         /// Y image displacement to map position
 	unsigned char Direction; //: 8; /// angle (0-255) unit looking
 	unsigned char CurrentResource;
-	int ResourcesHeld;      /// Resources Held by a unit
 
-	unsigned char DamagedType;   /// Index of damage type of unit which damaged this unit
-	unsigned long Attacked;      /// gamecycle unit was last attacked
-	unsigned long Summoned;      /// GameCycle unit was summoned using spells
 	unsigned Blink : 3;          /// Let selection rectangle blink
 	unsigned Moving : 1;         /// The unit is moving
 	unsigned ReCast : 1;         /// Recast again next cycle
@@ -386,53 +396,67 @@ public:
 
 	unsigned JustMoved : 3;      /// The unit last moved of its own accord this amount of cycles of standing still ago
 
+	int         Frame;      /// Image frame: <0 is mirrored
+	unsigned long TTL;  /// time to live
+
+	COrder *CriticalOrder;      /// order to do as possible in breakable animation.
+	CUnit *Container;     /// Pointer to the unit containing it (or 0)
+	CUnit *Goal; /// Generic/Teleporter goal pointer
+
+	// The rest is used by some actions, the AI, the display and the save games.
+
+	// @note int is faster than shorts
+	unsigned int     Refs;         /// Reference counter
+	unsigned int     ReleaseCycle; /// When this unit could be recycled
+	CUnitManagerData UnitManagerData;
+	size_t PlayerSlot;  /// index in Player->Units
+
+	int    InsideCount;   /// Number of units inside.
+	int    BoardCount;    /// Number of units transported inside.
+	CUnit *UnitInside;    /// Pointer to one of the units inside.
+	CUnit *NextContained; /// Next unit in the container.
+	CUnit *PrevContained; /// Previous unit in the container.
+
+	CUnit *NextWorker; //pointer to next assigned worker to "Goal" resource.
+	struct {
+		CUnit *Workers; /// pointer to first assigned worker to this resource.
+		int Assigned; /// how many units are assigned to harvesting from the resource.
+		int Active; /// how many units are harvesting from the resource.
+	} Resource; /// Resource still
+
+	int         CurrentSightRange; /// Unit's Current Sight Range
+
+	// Pathfinding stuff:
+	PathFinderData *pathFinderData;
+
+	// DISPLAY:
+	int  Colors;            /// custom colors
+
+	int ResourcesHeld;      /// Resources Held by a unit
+
+	unsigned char DamagedType;   /// Index of damage type of unit which damaged this unit
+	unsigned long Attacked;      /// gamecycle unit was last attacked
+	unsigned long Summoned;      /// GameCycle unit was summoned using spells
+
 	unsigned TeamSelected;  /// unit is selected by a team member.
 	CPlayer *RescuedFrom;        /// The original owner of a rescued unit.
 	/// NULL if the unit was not rescued.
-	/* Seen stuff. */
-	int VisCount[PlayerMax];     /// Unit visibility counts
-	struct _seen_stuff_ {
-		_seen_stuff_() : CFrame(NULL), Type(NULL), tilePos(-1, -1) {}
-		const CConstructionFrame  *CFrame;  /// Seen construction frame
-		int         Frame;                  /// last seen frame/stage of buildings
-		const CUnitType  *Type;             /// Pointer to last seen unit-type
-		Vec2i       tilePos;                /// Last unit->tilePos Seen
-		signed char IX;                     /// Seen X image displacement to map position
-		signed char IY;                     /// seen Y image displacement to map position
-		unsigned    Constructed : 1;        /// Unit seen construction
-		unsigned    State : 3;              /// Unit seen build/upgrade state
-unsigned    Destroyed : PlayerMax;  /// Unit seen destroyed or not
-unsigned    ByPlayer : PlayerMax;   /// Track unit seen by player
-	} Seen;
-
-	CVariable *Variable; /// array of User Defined variables.
-
-	unsigned long TTL;  /// time to live
 
 	unsigned int GroupId;       /// unit belongs to this group id
 	unsigned int LastGroup;     /// unit belongs to this last group
 
-	unsigned int Wait;          /// action counter
 	int Threshold;              /// The counter while ai unit couldn't change target.
 	int UnderAttack;			/// The counter while small ai can ignore non aggressive targets if searching attacker.
 
-	struct _unit_anim_ {
-		const CAnimation *Anim;      /// Anim
-		const CAnimation *CurrAnim;  /// CurrAnim
-		int Wait;                    /// Wait
-		int Unbreakable;             /// Unbreakable
-	} Anim, WaitBackup;
-
+	_unit_anim_ WaitBackup;     /// Anim saved while the unit is waiting
 
-	std::vector<COrder *> Orders; /// orders to process
 	COrder *SavedOrder;         /// order to continue after current
 	COrder *NewOrder;           /// order for new trained units
-	COrder *CriticalOrder;      /// order to do as possible in breakable animation.
 
 	char *AutoCastSpell;        /// spells to auto cast
 	int *SpellCoolDownTimers;   /// how much time unit need to wait before spell will be ready
 
-	CUnit *Goal; /// Generic/Teleporter goal pointer
+	CUnitColdData *Cold;        /// Rarely used data, allocated by the unit manager
 };
 
 #define NoUnitP (CUnit *)0        /// return value: for no unit found
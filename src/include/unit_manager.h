@@ -44,6 +44,7 @@
 ----------------------------------------------------------------------------*/
 
 class CUnit;
+class CUnitColdData;
 class CFile;
 struct lua_State;
 
@@ -53,6 +54,7 @@ public:
 	typedef std::vector<CUnit *>::iterator Iterator;
 public:
 	CUnitManager();
+	~CUnitManager();
 	void Init();
 
 	CUnit *AllocUnit();
@@ -77,10 +79,16 @@ public:
 	CUnit &GetSlotUnit(int index) const;
 	unsigned int GetUsedSlotCount() const;
 
+private:
+	CUnit *NewSlotUnit();
+	void FreeSlotUnits();
+
 private:
 	std::vector<CUnit *> units;
 	std::vector<CUnit *> unitSlots;
 	std::list<CUnit *> releasedUnits;
+	std::vector<CUnit *> unitBlocks;         /// Storage of the unit slots, by blocks
+	std::vector<CUnitColdData *> coldBlocks; /// Rarely used data of the unit slots, by blocks
 	CUnit *lastCreated;
 };
 
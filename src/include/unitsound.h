@@ -47,6 +47,7 @@
 ----------------------------------------------------------------------------*/
 
 class CSound;
+class CUnitType;
 
 /**
 **  Sound definition
@@ -57,7 +58,7 @@ public:
 	SoundConfig() : Sound(NULL) {}
 	SoundConfig(std::string name) : Name(name), Sound(NULL) {}
 
-	bool MapSound();
+	bool MapSound(bool prefetch = false);
 	void SetSoundRange(unsigned char range);
 
 public:
@@ -105,6 +106,12 @@ extern void LoadUnitSounds();
 */
 extern void MapUnitSounds();
 
+/**
+**  Decodes the sounds of a unit type in the background, when the first
+**  unit of the type enters a running game.
+*/
+extern void PrefetchUnitTypeSounds(const CUnitType &type);
+
 //@}
 
 #endif // !__UNITSOUND_H__
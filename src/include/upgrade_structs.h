@@ -37,6 +37,7 @@
 --  Includes
 ----------------------------------------------------------------------------*/
 
+#include <algorithm>
 #include <vector>
 
 /*----------------------------------------------------------------------------
@@ -182,17 +183,18 @@ public:
 class CUpgradeModifier
 {
 public:
-	CUpgradeModifier() : UpgradeId(0), ModifyPercent(NULL), SpeedResearch(0), ConvertTo(NULL)
-	{
-		memset(ChangeUnits, 0, sizeof(ChangeUnits));
-		memset(ChangeUpgrades, 0, sizeof(ChangeUpgrades));
-		memset(ApplyTo, 0, sizeof(ApplyTo));
-	}
+	CUpgradeModifier() : UpgradeId(0), ModifyPercent(NULL), SpeedResearch(0), ConvertTo(NULL) {}
 	~CUpgradeModifier()
 	{
 		delete [] this->ModifyPercent;
 	}
 
+	/// Does this modifier apply to the unit-type with that slot
+	bool AppliesTo(int slot) const
+	{
+		return std::binary_search(ApplyTo.begin(), ApplyTo.end(), slot);
+	}
+
 	int UpgradeId;                      /// used to filter required modifier
 
 	CUnitStats Modifier;                /// modifier of unit stats.
@@ -200,13 +202,12 @@ public:
 	int SpeedResearch;                  /// speed factor for researching
 	int ImproveIncomes[MaxCosts];		/// improve incomes
 
-	// allow/forbid bitmaps -- used as chars for example:
-	// `?' -- leave as is, `F' -- forbid, `A' -- allow
+	// allow/forbid changes, only the touched entries are stored:
+	// `F' -- forbid, `A' -- allow, `R' -- acquire
 	// TODO: see below allow more semantics?
-	// TODO: pointers or ids would be faster and less memory use
-	int  ChangeUnits[UnitTypeMax];      /// add/remove allowed units
-	char ChangeUpgrades[UpgradeMax];    /// allow/forbid upgrades
-	char ApplyTo[UnitTypeMax];          /// which unit types are affected
+	std::vector<std::pair<int, int>> ChangeUnits;     /// (unit-type slot, added allowed units)
+	std::vector<std::pair<int, char>> ChangeUpgrades; /// (upgrade id, allow/forbid)
+	std::vector<int> ApplyTo;           /// sorted slots of affected unit types
 
 	CUnitType *ConvertTo;               /// convert to this unit-type.
 };
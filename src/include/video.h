@@ -95,6 +95,13 @@ public:
 		short int x;
 		short int y;
 	};
+	struct frame_box_t {
+		short int x;
+		short int y;
+		short int w;
+		short int h;
+	};
+	struct rle_frames_t;
 
 protected:
 	CGraphic() : Surface(NULL), SurfaceFlip(NULL), frame_map(NULL),
@@ -102,6 +109,10 @@ protected:
 		Refs(1), Resized(false)
 	{
 		frameFlip_map = NULL;
+		shadow_map = NULL;
+		shadowFlip_map = NULL;
+		box_map = NULL;
+		rle_frames = NULL;
 	}
 	~CGraphic() {}
 
@@ -156,6 +167,12 @@ public:
 	void DrawFrameClipTransX(unsigned frame, int x, int y, int alpha,
 							 SDL_Surface *surface = TheScreen) const;
 
+	// Draw shadow frame, darkening the target surface
+	void DrawShadowFrameClip(unsigned frame, int x, int y,
+							 SDL_Surface *surface = TheScreen) const;
+	void DrawShadowFrameClipX(unsigned frame, int x, int y,
+							  SDL_Surface *surface = TheScreen) const;
+
 
 	static CGraphic *New(const std::string &file, int w = 0, int h = 0);
 	static CGraphic *ForceNew(const std::string &file, int w = 0, int h = 0);
@@ -187,7 +204,12 @@ public:
 	SDL_Surface *SurfaceFlip;  /// Flipped surface
 	frame_pos_t *frame_map;
 	frame_pos_t *frameFlip_map;
+	frame_box_t *shadow_map;      /// Covered part of each shadow frame, NULL if not a shadow
+	frame_box_t *shadowFlip_map;  /// Covered part of each flipped shadow frame
+	frame_box_t *box_map;         /// Part of each frame which is not transparent
+	mutable rle_frames_t *rle_frames; /// Run length encoded frames, made on the first draw which can use them
 	void GenFramesMap();
+	void GenFrameBoxes();
 	int Width;                 /// Width of a frame
 	int Height;                /// Height of a frame
 	int NumFrames;             /// Number of frames
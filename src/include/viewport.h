@@ -31,6 +31,8 @@
 #define VIEWPORT_H
 
 //@{
+#include <vector>
+
 #include "fow.h"
 #include "vec2i.h"
 class CUnit;
@@ -102,6 +104,8 @@ public:
 
 	void Restrict(int &screenPosX, int &screenPosY) const;
 	void Clean();
+	/// Forget the units of the last frame
+	void ClearDrawnUnits() { DrawnUnits.clear(); }
 
 	static bool isGridEnabled()
 	{
@@ -149,6 +153,7 @@ public:
 
 	CUnit *Unit;              /// Bound to this unit
 private:
+	std::vector<CUnit *> DrawnUnits;     /// Units of the last frame, in draw order
 	SDL_Surface *FogSurface { nullptr }; /// Texture for fog of war. Viewport sized.
 	static bool ShowGrid;
 
@@ -472,6 +472,7 @@ class MenuScreen : public gcn::Container
 {
 public:
 	MenuScreen();
+	virtual ~MenuScreen();
 
 	int run(bool loop = true);
 	void stop(int result = 0, bool stopAll = false);
@@ -482,12 +483,18 @@ public:
 	void setDrawMenusUnder(bool drawUnder) { this->drawUnder = drawUnder; }
 	bool getDrawMenusUnder() const { return this->drawUnder; }
 
+private:
+	void drawChildrenCached(gcn::Graphics *graphics);
+	void freeDrawCache();
+
 private:
 	bool runLoop;
 	int loopResult;
 	gcn::Widget *oldtop;
 	LuaActionListener *logiclistener;
 	bool drawUnder;
+	SDL_Surface *drawCache;                     /// Screen after drawing the clean leading children
+	std::vector<gcn::Widget *> drawCacheWidgets; /// Children drawn into drawCache
 };
 
 #endif
@@ -0,0 +1,595 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name distancefield.cpp - The resource distance fields. */
+//
+//      (c) Copyright 2024 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include "stratagus.h"
+
+#include "distancefield.h"
+
+#include "actions.h"
+#include "map.h"
+#include "player.h"
+#include "settings.h"
+#include "tileset.h"
+#include "unit.h"
+#include "unittype.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+/// Same neighbours, in the same order, as TerrainTraversal
+static const Vec2i DistanceFieldOffsets[] = {Vec2i(0, -1), Vec2i(-1, 0), Vec2i(1, 0), Vec2i(0, 1),
+											 Vec2i(-1, -1), Vec2i(1, -1), Vec2i(-1, 1), Vec2i(1, 1)
+											};
+
+/// Tiles released by the last CDistanceField::UpdateTile, kept to avoid allocations
+static std::vector<Vec2i> ReleasedTiles;
+/// Distance of the released tiles before they were released
+static std::vector<unsigned short> ReleasedDistances;
+
+/**
+**  Area of a deposit which is a source of a deposit distance field.
+*/
+struct DepositArea {
+	bool operator <(const DepositArea &rhs) const { return Unit < rhs.Unit; }
+	bool operator ==(const DepositArea &rhs) const
+	{
+		return Unit == rhs.Unit && Pos == rhs.Pos && Size == rhs.Size;
+	}
+
+	CUnit *Unit;
+	Vec2i Pos;
+	Vec2i Size;
+};
+
+/**
+**  Distance field kept up to date for one kind of search.
+*/
+struct DistanceFieldEntry {
+	int Player;      /// Player owning the deposits, or whose explored tiles restrict the field, or -1
+	bool ExploredOnly; /// Only use the tiles explored by Player
+	int MoveMask;    /// Movement mask of the searching units
+	int ResMask;     /// Searched terrain flags, 0 for a deposit field
+	int Resource;    /// Resource stored by the deposits of a deposit field
+	std::vector<DepositArea> Deposits; /// Current sources of a deposit field, sorted
+	bool DepositsValid = false; /// Deposits are up to date with the units of the players
+	CDistanceField Field;
+};
+
+/// All the distance fields, created on first use
+static std::vector<DistanceFieldEntry *> DistanceFields;
+
+/*----------------------------------------------------------------------------
+--  CDistanceField
+----------------------------------------------------------------------------*/
+
+/**
+**  Allocate the field with all tiles blocked.
+**
+**  @param width   Map width.
+**  @param height  Map height.
+*/
+void CDistanceField::Init(int width, int height)
+{
+	this->width = width;
+	this->height = height;
+	distances.assign(width * height, Infinity);
+	states.assign(width * height, Blocked);
+}
+
+/**
+**  Compute all the distances from the tile states (multi-source BFS).
+*/
+void CDistanceField::Build()
+{
+	std::vector<Vec2i> queue;
+
+	std::fill(distances.begin(), distances.end(), Infinity);
+	for (Vec2i pos(0, 0); pos.y != height; ++pos.y) {
+		for (pos.x = 0; pos.x != width; ++pos.x) {
+			if (states[Index(pos)] == Source) {
+				distances[Index(pos)] = 0;
+				queue.push_back(pos);
+			}
+		}
+	}
+	for (size_t head = 0; head != queue.size(); ++head) {
+		const Vec2i pos = queue[head];
+		const unsigned short next = distances[Index(pos)] + 1;
+
+		for (int i = 0; i != 8; ++i) {
+			const Vec2i newPos = pos + DistanceFieldOffsets[i];
+
+			if (IsInside(newPos) && states[Index(newPos)] == Passable && distances[Index(newPos)] == Infinity) {
+				distances[Index(newPos)] = next;
+				queue.push_back(newPos);
+			}
+		}
+	}
+}
+
+/**
+**  Distance which the neighbours of pos can give to it.
+*/
+unsigned short CDistanceField::SupportedDistance(const Vec2i &pos) const
+{
+	unsigned short best = Infinity;
+
+	for (int i = 0; i != 8; ++i) {
+		const Vec2i newPos = pos + DistanceFieldOffsets[i];
+
+		if (IsInside(newPos) && distances[Index(newPos)] < best) {
+			best = distances[Index(newPos)];
+		}
+	}
+	return best == Infinity ? Infinity : best + 1;
+}
+
+/**
+**  Change the state of a tile and repair the distances.
+**
+**  @param pos    Map tile position.
+**  @param state  New state of the tile.
+*/
+void CDistanceField::UpdateTile(const Vec2i &pos, TileState state)
+{
+	const unsigned int index = Index(pos);
+
+	if (states[index] == state) {
+		return;
+	}
+	states[index] = state;
+
+	// Release the tiles whose shortest path went through pos.
+	// They are visited by increasing distance, so a tile is released
+	// only if none of its neighbours at distance - 1 is kept.
+	ReleasedTiles.clear();
+	ReleasedDistances.clear();
+	if (state != Source && distances[index] != Infinity) {
+		ReleasedTiles.push_back(pos);
+		ReleasedDistances.push_back(distances[index]);
+		distances[index] = Infinity;
+	}
+	for (size_t head = 0; head != ReleasedTiles.size(); ++head) {
+		const Vec2i releasedPos = ReleasedTiles[head];
+		const unsigned short next = ReleasedDistances[head] + 1;
+
+		for (int i = 0; i != 8; ++i) {
+			const Vec2i newPos = releasedPos + DistanceFieldOffsets[i];
+
+			if (IsInside(newPos) == false
+				|| states[Index(newPos)] != Passable
+				|| distances[Index(newPos)] != next
+				|| SupportedDistance(newPos) == next) {
+				continue;
+			}
+			ReleasedTiles.push_back(newPos);
+			ReleasedDistances.push_back(next);
+			distances[Index(newPos)] = Infinity;
+		}
+	}
+
+	// Refill from the tiles which are still valid.
+	typedef std::pair<unsigned short, unsigned int> OpenTile;
+	std::priority_queue<OpenTile, std::vector<OpenTile>, std::greater<OpenTile> > open;
+
+	if (state == Source) {
+		distances[index] = 0;
+		open.push(OpenTile(0, index));
+	} else if (state == Passable) {
+		ReleasedTiles.push_back(pos);
+	}
+	for (size_t i = 0; i != ReleasedTiles.size(); ++i) {
+		const Vec2i &releasedPos = ReleasedTiles[i];
+		const unsigned int releasedIndex = Index(releasedPos);
+
+		if (states[releasedIndex] != Passable) {
+			continue;
+		}
+		const unsigned short distance = SupportedDistance(releasedPos);
+		if (distance < distances[releasedIndex]) {
+			distances[releasedIndex] = distance;
+			open.push(OpenTile(distance, releasedIndex));
+		}
+	}
+	while (open.empty() == false) {
+		const OpenTile openTile = open.top();
+		open.pop();
+
+		if (openTile.first != distances[openTile.second]) {
+			continue;
+		}
+		const Vec2i openPos(openTile.second % width, openTile.second / width);
+		const unsigned short next = openTile.first + 1;
+
+		for (int i = 0; i != 8; ++i) {
+			const Vec2i newPos = openPos + DistanceFieldOffsets[i];
+
+			if (IsInside(newPos) && states[Index(newPos)] == Passable && next < distances[Index(newPos)]) {
+				distances[Index(newPos)] = next;
+				open.push(OpenTile(next, Index(newPos)));
+			}
+		}
+	}
+}
+
+/**
+**  Follow the distances down to the nearest source.
+**
+**  @param startPos   Map tile position to start from.
+**  @param sourcePos  OUT: Map tile position of the source.
+**
+**  @return           True if a source can be reached from startPos.
+*/
+bool CDistanceField::FindNearestSource(const Vec2i &startPos, Vec2i *sourcePos) const
+{
+	if (IsInside(startPos) == false || distances[Index(startPos)] == Infinity) {
+		return false;
+	}
+	Vec2i pos = startPos;
+	for (unsigned short distance = distances[Index(pos)]; distance != 0; --distance) {
+		for (int i = 0; i != 8; ++i) {
+			const Vec2i newPos = pos + DistanceFieldOffsets[i];
+
+			if (IsInside(newPos) && distances[Index(newPos)] == distance - 1) {
+				pos = newPos;
+				break;
+			}
+		}
+	}
+	*sourcePos = pos;
+	return true;
+}
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+/**
+**  State of a tile in a field, without its deposits.
+*/
+static CDistanceField::TileState GetTerrainTileState(const DistanceFieldEntry &entry, const Vec2i &pos)
+{
+	const CMapField &mf = *Map.Field(pos);
+
+	if (entry.ExploredOnly && !mf.playerInfo.IsExplored(Players[entry.Player])) {
+		return CDistanceField::Blocked;
+	}
+	if (entry.ResMask && mf.CheckMask(entry.ResMask)) {
+		return CDistanceField::Source;
+	}
+	return CanMoveToMask(pos, entry.MoveMask) ? CDistanceField::Passable : CDistanceField::Blocked;
+}
+
+/**
+**  Find or create the field.
+*/
+static DistanceFieldEntry &GetDistanceField(int player, bool exploredOnly, int movemask, int resmask, int resource)
+{
+	for (size_t i = 0; i != DistanceFields.size(); ++i) {
+		DistanceFieldEntry &entry = *DistanceFields[i];
+
+		if (entry.Player == player && entry.ExploredOnly == exploredOnly && entry.MoveMask == movemask
+			&& entry.ResMask == resmask && entry.Resource == resource) {
+			return entry;
+		}
+	}
+	DistanceFieldEntry *entry = new DistanceFieldEntry;
+
+	entry->Player = player;
+	entry->ExploredOnly = exploredOnly;
+	entry->MoveMask = movemask;
+	entry->ResMask = resmask;
+	entry->Resource = resource;
+	entry->Field.Init(Map.Info.MapWidth, Map.Info.MapHeight);
+	for (Vec2i pos(0, 0); pos.y != Map.Info.MapHeight; ++pos.y) {
+		for (pos.x = 0; pos.x != Map.Info.MapWidth; ++pos.x) {
+			entry->Field.SetState(pos, GetTerrainTileState(*entry, pos));
+		}
+	}
+	entry->Field.Build();
+	DistanceFields.push_back(entry);
+	return *entry;
+}
+
+/**
+**  Set the state of all the tiles of a deposit.
+*/
+static void UpdateDepositArea(DistanceFieldEntry &entry, const DepositArea &area, bool isSource)
+{
+	for (Vec2i pos(0, area.Pos.y); pos.y != area.Pos.y + area.Size.y; ++pos.y) {
+		for (pos.x = area.Pos.x; pos.x != area.Pos.x + area.Size.x; ++pos.x) {
+			if (Map.Info.IsPointOnMap(pos)) {
+				entry.Field.UpdateTile(pos, isSource ? CDistanceField::Source : GetTerrainTileState(entry, pos));
+			}
+		}
+	}
+}
+
+/**
+**  Add the deposits of a player which can store the resource.
+*/
+static void AddDeposits(CPlayer &player, int resource, std::vector<DepositArea> &deposits)
+{
+	for (std::vector<CUnit *>::iterator it = player.UnitBegin(); it != player.UnitEnd(); ++it) {
+		CUnit &unit = **it;
+
+		if (unit.Type->CanStore[resource] && unit.IsAliveOnMap()
+			&& (unit.CurrentAction() != UnitActionBuilt || unit.CurrentOrder()->Finished)) {
+			DepositArea area;
+
+			area.Unit = &unit;
+			area.Pos = unit.tilePos;
+			area.Size = Vec2i(unit.Type->TileWidth, unit.Type->TileHeight);
+			deposits.push_back(area);
+		}
+	}
+}
+
+/**
+**  Bring the sources of a deposit field up to date with the deposits
+**  the player can use now.
+**
+**  Nothing is done until DistanceFieldsDepotChanged() or
+**  DistanceFieldsAlliancesChanged() invalidates the field.
+*/
+static void UpdateDeposits(DistanceFieldEntry &entry, CPlayer &player)
+{
+	if (entry.DepositsValid) {
+		return;
+	}
+	entry.DepositsValid = true;
+
+	std::vector<DepositArea> deposits;
+
+	AddDeposits(player, entry.Resource, deposits);
+	if (GameSettings.AllyDepositsAllowed) {
+		for (int i = 0; i < PlayerMax - 1; ++i) {
+			if (i != player.Index && Players[i].IsAllied(player) && player.IsAllied(Players[i])) {
+				AddDeposits(Players[i], entry.Resource, deposits);
+			}
+		}
+	}
+	std::sort(deposits.begin(), deposits.end());
+	if (deposits == entry.Deposits) {
+		return;
+	}
+	for (size_t i = 0; i != entry.Deposits.size(); ++i) {
+		if (std::find(deposits.begin(), deposits.end(), entry.Deposits[i]) == deposits.end()) {
+			UpdateDepositArea(entry, entry.Deposits[i], false);
+		}
+	}
+	for (size_t i = 0; i != deposits.size(); ++i) {
+		UpdateDepositArea(entry, deposits[i], true);
+	}
+	entry.Deposits.swap(deposits);
+}
+
+/**
+**  Find the closest piece of terrain with the given flags.
+**
+**  The field of each player and movement mask is shared by all its
+**  units, so this is a walk down the distances instead of a search.
+**  AI players are not restricted to their explored tiles and share
+**  their fields.
+**
+**  @param player      Only use fields explored by player, unless AI.
+**  @param movemask    The movement mask to reach that location.
+**  @param resmask     Result tile mask.
+**  @param range       Maximum distance for the search.
+**  @param startPos    Map start position for the search.
+**  @param terrainPos  OUT: Map position of tile.
+**
+**  @return            True if found.
+*/
+bool DistanceFieldFindTerrain(const CPlayer &player, int movemask, int resmask, int range,
+							  const Vec2i &startPos, Vec2i *terrainPos)
+{
+	if (Map.Info.IsPointOnMap(startPos) == false) {
+		return false;
+	}
+	const bool exploredOnly = !player.AiEnabled;
+	const DistanceFieldEntry &entry = GetDistanceField(exploredOnly ? player.Index : -1, exploredOnly, movemask, resmask, -1);
+
+	if (entry.Field.Get(startPos) > range) {
+		return false;
+	}
+	Vec2i pos;
+	if (entry.Field.FindNearestSource(startPos, &pos) == false) {
+		return false;
+	}
+	if (terrainPos) {
+		*terrainPos = pos;
+	}
+	return true;
+}
+
+/**
+**  Find the nearest deposit for a resource.
+**
+**  Deposit fields are kept per player, resource and movement mask, and
+**  updated when the usable deposits change.
+**
+**  @param unit      The unit that wants to find a deposit.
+**  @param range     Maximum distance to the deposit.
+**  @param resource  Resource to find deposit from.
+**
+**  @return          NULL or deposit unit
+*/
+CUnit *DistanceFieldFindDeposit(const CUnit &unit, int range, int resource)
+{
+	const int movemask = unit.Type->MovementMask & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit);
+	DistanceFieldEntry &entry = GetDistanceField(unit.Player->Index, false, movemask, 0, resource);
+
+	UpdateDeposits(entry, *unit.Player);
+	if (entry.Deposits.empty()) {
+		return NULL;
+	}
+
+	// The unit may be inside a building: start from its tiles or around them.
+	const CUnit *startUnit = GetFirstContainer(unit);
+	const Vec2i start = startUnit->tilePos - Vec2i(1, 1);
+	const Vec2i end = startUnit->tilePos + Vec2i(startUnit->Type->TileWidth, startUnit->Type->TileHeight);
+	unsigned int bestDistance = CDistanceField::Infinity;
+	Vec2i bestPos;
+
+	for (Vec2i pos(0, start.y); pos.y <= end.y; ++pos.y) {
+		for (pos.x = start.x; pos.x <= end.x; ++pos.x) {
+			if (Map.Info.IsPointOnMap(pos) == false || entry.Field.Get(pos) == CDistanceField::Infinity) {
+				continue;
+			}
+			const bool around = pos.x == start.x || pos.x == end.x || pos.y == start.y || pos.y == end.y;
+			const unsigned int distance = entry.Field.Get(pos) + (around ? 1 : 0);
+
+			if (distance < bestDistance) {
+				bestDistance = distance;
+				bestPos = pos;
+			}
+		}
+	}
+	if (bestDistance == CDistanceField::Infinity || bestDistance > (unsigned int)range) {
+		return NULL;
+	}
+	Vec2i depositPos;
+	entry.Field.FindNearestSource(bestPos, &depositPos);
+	for (size_t i = 0; i != entry.Deposits.size(); ++i) {
+		const DepositArea &area = entry.Deposits[i];
+
+		if (area.Pos.x <= depositPos.x && depositPos.x < area.Pos.x + area.Size.x
+			&& area.Pos.y <= depositPos.y && depositPos.y < area.Pos.y + area.Size.y) {
+			return area.Unit;
+		}
+	}
+	return NULL;
+}
+
+/**
+**  Tell the distance fields that the flags of a tile have changed.
+**
+**  @param pos  Map tile position.
+*/
+void DistanceFieldsTileChanged(const Vec2i &pos)
+{
+	for (size_t i = 0; i != DistanceFields.size(); ++i) {
+		DistanceFieldEntry &entry = *DistanceFields[i];
+
+		// Deposit tiles are only changed by UpdateDeposits.
+		if (entry.ResMask == 0 && entry.Field.GetState(pos) == CDistanceField::Source) {
+			continue;
+		}
+		entry.Field.UpdateTile(pos, GetTerrainTileState(entry, pos));
+	}
+}
+
+/**
+**  Tell the deposit fields that a unit of this type has been placed,
+**  removed, moved, finished or has changed its owner.
+**
+**  @param type  Type of the unit.
+*/
+void DistanceFieldsDepotChanged(const CUnitType &type)
+{
+	for (size_t i = 0; i != DistanceFields.size(); ++i) {
+		DistanceFieldEntry &entry = *DistanceFields[i];
+
+		if (entry.ResMask == 0 && type.CanStore[entry.Resource]) {
+			entry.DepositsValid = false;
+		}
+	}
+}
+
+/**
+**  Tell the deposit fields that the diplomacy between players has changed.
+*/
+void DistanceFieldsAlliancesChanged()
+{
+	for (size_t i = 0; i != DistanceFields.size(); ++i) {
+		DistanceFields[i]->DepositsValid = false;
+	}
+}
+
+/**
+**  Tell the distance fields that a player has explored a tile.
+**
+**  @param player  Player who explored the tile.
+**  @param pos     Map tile position.
+*/
+void DistanceFieldsTileExplored(const CPlayer &player, const Vec2i &pos)
+{
+	for (size_t i = 0; i != DistanceFields.size(); ++i) {
+		DistanceFieldEntry &entry = *DistanceFields[i];
+
+		if (entry.ExploredOnly && entry.Player == player.Index) {
+			entry.Field.UpdateTile(pos, GetTerrainTileState(entry, pos));
+		}
+	}
+}
+
+/**
+**  Drop the fields restricted to explored tiles.
+**
+**  Used when many tiles are explored at once, the fields are
+**  rebuilt on next use.
+*/
+void DistanceFieldsExploredChanged()
+{
+	std::vector<DistanceFieldEntry *>::iterator it = DistanceFields.begin();
+
+	while (it != DistanceFields.end()) {
+		if ((*it)->ExploredOnly) {
+			delete *it;
+			it = DistanceFields.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+/**
+**  Free all the distance fields.
+*/
+void CleanDistanceFields()
+{
+	for (size_t i = 0; i != DistanceFields.size(); ++i) {
+		delete DistanceFields[i];
+	}
+	DistanceFields.clear();
+}
+
+//@}
@@ -106,6 +106,9 @@ void CFogOfWar::Init()
     
     VisTable_Index0 = VisTableWidth + 1;
 
+    VisChanges.clear();
+    AllVisChanged = true;
+
     switch (Settings.Type) {
         case FogOfWarTypes::cTiled:
         case FogOfWarTypes::cTiledLegacy:
@@ -202,6 +205,9 @@ void CFogOfWar::Clean(const bool isHardClean /*= false*/)
     VisTableWidth   = 0;
     VisTable_Index0 = 0;
 
+    VisChanges.clear();
+    AllVisChanged = true;
+
     switch (Settings.Type) {
         case FogOfWarTypes::cTiled:
         case FogOfWarTypes::cTiledLegacy:
@@ -314,6 +320,8 @@ void CFogOfWar::GenerateFog()
         const uint16_t lBound = (thisThread    ) * Map.Info.MapHeight / numOfThreads;
         const uint16_t uBound = (thisThread + 1) * Map.Info.MapHeight / numOfThreads;
 
+        std::vector<unsigned int> changes;
+
         for (uint16_t row = lBound; row < uBound; row++) {
 
             const size_t visIndex = VisTable_Index0 + row * VisTableWidth;
@@ -321,21 +329,51 @@ void CFogOfWar::GenerateFog()
 
             for (uint16_t col = 0; col < Map.Info.MapWidth; col++) {
 
-                uint8_t &visCell = VisTable[visIndex + col];
-                visCell = 0; /// Clear it before check for players
+                uint8_t vis = 0;
                 const CMapField *mapField = Map.Field(mapIndex + col);
                 for (const uint8_t player : playersToRenderView) {
-                    visCell = std::max<uint8_t>(visCell, mapField->playerInfo.Visible[player]);
-                    if (visCell >= visibleThreshold) {
-                        visCell = 2;
+                    vis = std::max<uint8_t>(vis, mapField->playerInfo.Visible[player]);
+                    if (vis >= visibleThreshold) {
+                        vis = 2;
                         break;
                     }
                 }
+                uint8_t &visCell = VisTable[visIndex + col];
+                if (visCell != vis) {
+                    visCell = vis;
+                    if (!AllVisChanged) {
+                        changes.push_back(mapIndex + col);
+                    }
+                }
             }
         }
+        #pragma omp critical
+        VisChanges.insert(VisChanges.end(), changes.begin(), changes.end());
+    }
+    /// Past this, going through all the tiles is cheaper for the consumers
+    if (VisChanges.size() > size_t(Map.Info.MapWidth) * Map.Info.MapHeight / 4) {
+        VisChanges.clear();
+        AllVisChanged = true;
     }
 }
 
+/**
+**  Get the tiles whose visibility changed since the last call.
+**
+**  @param tiles  Filled with the map indexes of the changed tiles.
+**
+**  @return       true if all the tiles have to be considered changed, tiles is empty then.
+*/
+bool CFogOfWar::TakeVisibilityChanges(std::vector<unsigned int> &tiles)
+{
+    const bool allChanged = AllVisChanged;
+
+    tiles.clear();
+    tiles.swap(VisChanges);
+    AllVisChanged = false;
+    return allChanged;
+}
+
 /**
 **  Proceed fog of war state update
 **
@@ -492,38 +530,11 @@ void CFogOfWar::FogUpscale4x4()
     **              [0][0][0][0]         0 - full opacity
     */
 
-    /// Because we work with 4x4 scaled map tiles here, the textureIndex is in 32bits chunks (byte * 4)
-    uint32_t *const fogTexture = (uint32_t*)FogTexture.GetNext();
-    
-    /// Fog texture width and height in 32bit chunks
-    const uint16_t textureWidth  = FogTexture.GetWidth()  / 4;
-    const uint16_t textureHeight = FogTexture.GetHeight() / 4;
-    const uint16_t nextRowOffset = textureWidth * 4;
-
-    #pragma omp parallel
-    {
-
-        const uint16_t thisThread   = omp_get_thread_num();
-        const uint16_t numOfThreads = omp_get_num_threads();
-        
-        const uint16_t lBound = (thisThread    ) * textureHeight / numOfThreads;
-        const uint16_t uBound = (thisThread + 1) * textureHeight / numOfThreads;
-
-        /// in fact it's viewport.MapPos.y -1 & viewport.MapPos.x -1 because of VisTable starts from [-1:-1]
-        size_t visIndex      = lBound * VisTableWidth;
-        size_t textureIndex  = lBound * nextRowOffset;
-        
-        for (uint16_t row = lBound; row < uBound; row++) {
-            for (uint16_t col = 0; col < textureWidth; col++) {
-                /// Fill the 4x4 scaled tile
-                FillUpscaledRec(fogTexture, textureWidth, textureIndex + col, 
-                                DeterminePattern(visIndex + col, VisionType::cVisible), 
-                                DeterminePattern(visIndex + col, VisionType::cVisible | VisionType::cExplored));
-            }
-            visIndex     += VisTableWidth;
-            textureIndex += nextRowOffset;
-        }
-    } // pragma omp parallel
+    /// Because we work with 4x4 scaled map tiles here, the texture is in 32bits chunks (byte * 4)
+    /// in fact it starts from viewport.MapPos.y -1 & viewport.MapPos.x -1 because of VisTable starts from [-1:-1]
+    UpscaleVisTable4x4(VisTable.data(), VisTableWidth,
+                       (uint32_t*)FogTexture.GetNext(), FogTexture.GetWidth() / 4, FogTexture.GetHeight() / 4,
+                       UpscaleTableVisible, CurrUpscaleTableExplored);
 }
 
 /**
@@ -39,11 +39,29 @@
 #include "stratagus.h"
 #include "fow_utils.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FOW_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FOW_NEON
+#endif
 
 /*----------------------------------------------------------------------------
 --  Defines
 ----------------------------------------------------------------------------*/
 
+#if defined(FOW_SSE2) || defined(FOW_NEON)
+#define FOW_SIMD
+#endif
+
+constexpr uint32_t FixedOneHalf = 32768; /// 0.5 in 16.16 fixed point math of the box blur
+constexpr uint8_t  MaxVectorizedRadius = 63; /// Box sums of bigger radiuses overflow the int16_t sums of the scalar passes
+
+/// Vision table layers (CFogOfWar::VisionType)
+constexpr uint8_t VisExplored = 0b001;
+constexpr uint8_t VisVisible  = 0b010;
+
 
 /*----------------------------------------------------------------------------
 --  Variables
@@ -249,6 +267,258 @@ void CBlurer::Clean()
 }
 
 
+/**
+**  Horizontal box blur pass over a range of rows
+**
+**  @param  source  source texture
+**  @param  target  target texture
+**  @param  width   width of the textures
+**  @param  lBound  first row to blur
+**  @param  uBound  row after the last one to blur
+**  @param  radius  blur radius (box size)
+**  @param  iarr    1 / (2 * radius + 1) in 16.16 fixed point
+**
+*/
+static void BlurRowsScalar(const uint8_t *source, uint8_t *target, const uint16_t width,
+                           const uint16_t lBound, const uint16_t uBound, const uint8_t radius, const uint32_t iarr)
+{
+    for (uint16_t i = lBound; i < uBound; i++) {
+
+        size_t ti = size_t(i) * width; 
+        size_t li = ti;
+        size_t ri = ti + radius;
+
+        const uint8_t leftBorder  = source[ti];
+        const uint8_t rightBorder = source[ti + width - 1];
+              int16_t sum         = int16_t(radius + 1) * leftBorder;
+
+        for (uint16_t j = 0; j < radius; j++) { 
+            sum += source[ti + j]; 
+        }
+        for (uint16_t j = 0; j <= radius; j++) {
+            sum += source[ri++] - leftBorder; 
+            target[ti++] = (iarr * sum + FixedOneHalf) >> 16;
+        }
+        for (uint16_t j = radius + 1; j < width - radius; j++) {
+            sum += source[ri++] - source[li++];
+            target[ti++] = (iarr * sum + FixedOneHalf) >> 16;
+        }
+        for (uint16_t j = width - radius; j < width; j++) {
+            sum += rightBorder - source[li++];   
+            target[ti++] = (iarr * sum + FixedOneHalf) >> 16;
+        }
+    }
+}
+
+/**
+**  Vertical box blur pass over a range of columns
+**
+**  @param  source  source texture
+**  @param  target  target texture
+**  @param  width   width of the textures
+**  @param  height  height of the textures
+**  @param  lBound  first column to blur
+**  @param  uBound  column after the last one to blur
+**  @param  radius  blur radius (box size)
+**  @param  iarr    1 / (2 * radius + 1) in 16.16 fixed point
+**
+*/
+static void BlurColumnsScalar(const uint8_t *source, uint8_t *target, const uint16_t width, const uint16_t height,
+                              const uint16_t lBound, const uint16_t uBound, const uint8_t radius, const uint32_t iarr)
+{
+    for (uint16_t i = lBound; i < uBound; i++) {
+
+        size_t ti = i;
+        size_t li = ti;
+        size_t ri = ti + radius * width;
+
+        const uint8_t leftBorder  = source[ti];
+        const uint8_t rightBorder = source[ti + width * (height - 1)];
+              int16_t sum         = int16_t(radius + 1) * leftBorder;
+
+        for (uint16_t j = 0; j < radius; j++) {
+            sum += source[ti + j * width];
+        }
+        for (uint16_t j = 0; j <= radius ; j++) { 
+            sum += source[ri] - leftBorder;
+            target[ti] = (iarr * sum + FixedOneHalf) >> 16;
+            ri += width;
+            ti += width;
+        }
+        for (uint16_t j = radius + 1; j < height - radius; j++) { 
+            sum += source[ri] - source[li];
+            target[ti] = (iarr * sum + FixedOneHalf) >> 16;
+            li += width;
+            ri += width;
+            ti += width;
+        }
+        for (uint16_t j = height - radius; j < height; j++) { 
+            sum += rightBorder - source[li];
+            target[ti] = (iarr * sum + FixedOneHalf) >> 16;
+            li += width;
+            ti += width;
+        }
+    }
+}
+
+#ifdef FOW_SSE2
+/// (iarr * sum + 0.5) >> 16 for 8 box sums, exactly like the scalar passes do it in 32 bits
+static inline __m128i BoxAverage(const __m128i sum, const __m128i iarr)
+{
+    const __m128i high = _mm_mulhi_epu16(sum, iarr);
+    const __m128i low  = _mm_mullo_epi16(sum, iarr);
+    return _mm_add_epi16(high, _mm_srli_epi16(low, 15));
+}
+
+/// Blur 16 texels of a row, box points to the first texel of the first box
+static inline void BlurRowBlock(const uint8_t *box, const uint16_t boxSize, const uint32_t iarr, uint8_t *target)
+{
+    const __m128i zero   = _mm_setzero_si128();
+    const __m128i iarr16 = _mm_set1_epi16(int16_t(iarr));
+          __m128i sumLo  = zero;
+          __m128i sumHi  = zero;
+
+    for (uint16_t k = 0; k < boxSize; k++) {
+        const __m128i texels = _mm_loadu_si128((const __m128i *)&box[k]);
+        sumLo = _mm_add_epi16(sumLo, _mm_unpacklo_epi8(texels, zero));
+        sumHi = _mm_add_epi16(sumHi, _mm_unpackhi_epi8(texels, zero));
+    }
+    _mm_storeu_si128((__m128i *)target, _mm_packus_epi16(BoxAverage(sumLo, iarr16), BoxAverage(sumHi, iarr16)));
+}
+
+/// Blur a strip of 16 columns starting at column x
+static void BlurColumnStrip(const uint8_t *source, uint8_t *target, const uint16_t width, const uint16_t height,
+                            const uint16_t x, const uint8_t radius, const uint32_t iarr)
+{
+    const __m128i zero   = _mm_setzero_si128();
+    const __m128i iarr16 = _mm_set1_epi16(int16_t(iarr));
+    const auto    row    = [&](const int y) {
+        return _mm_loadu_si128((const __m128i *)&source[size_t(std::clamp(y, 0, height - 1)) * width + x]);
+    };
+
+    const __m128i border = row(0);
+    const __m128i times  = _mm_set1_epi16(radius + 1);
+          __m128i sumLo  = _mm_mullo_epi16(_mm_unpacklo_epi8(border, zero), times);
+          __m128i sumHi  = _mm_mullo_epi16(_mm_unpackhi_epi8(border, zero), times);
+
+    for (uint16_t j = 0; j < radius; j++) {
+        const __m128i texels = row(j);
+        sumLo = _mm_add_epi16(sumLo, _mm_unpacklo_epi8(texels, zero));
+        sumHi = _mm_add_epi16(sumHi, _mm_unpackhi_epi8(texels, zero));
+    }
+    for (uint16_t j = 0; j < height; j++) {
+        const __m128i in  = row(j + radius);
+        const __m128i out = row(j - radius - 1);
+        sumLo = _mm_sub_epi16(_mm_add_epi16(sumLo, _mm_unpacklo_epi8(in, zero)), _mm_unpacklo_epi8(out, zero));
+        sumHi = _mm_sub_epi16(_mm_add_epi16(sumHi, _mm_unpackhi_epi8(in, zero)), _mm_unpackhi_epi8(out, zero));
+        _mm_storeu_si128((__m128i *)&target[size_t(j) * width + x],
+                         _mm_packus_epi16(BoxAverage(sumLo, iarr16), BoxAverage(sumHi, iarr16)));
+    }
+}
+#endif // FOW_SSE2
+
+#ifdef FOW_NEON
+/// (iarr * sum + 0.5) >> 16 for 8 box sums, exactly like the scalar passes do it in 32 bits
+static inline uint8x8_t BoxAverage(const uint16x8_t sum, const uint16x4_t iarr)
+{
+    return vmovn_u16(vcombine_u16(vrshrn_n_u32(vmull_u16(vget_low_u16(sum), iarr), 16),
+                                  vrshrn_n_u32(vmull_u16(vget_high_u16(sum), iarr), 16)));
+}
+
+/// Blur 16 texels of a row, box points to the first texel of the first box
+static inline void BlurRowBlock(const uint8_t *box, const uint16_t boxSize, const uint32_t iarr, uint8_t *target)
+{
+    const uint16x4_t iarr16 = vdup_n_u16(uint16_t(iarr));
+          uint16x8_t sumLo  = vdupq_n_u16(0);
+          uint16x8_t sumHi  = vdupq_n_u16(0);
+
+    for (uint16_t k = 0; k < boxSize; k++) {
+        const uint8x16_t texels = vld1q_u8(&box[k]);
+        sumLo = vaddw_u8(sumLo, vget_low_u8(texels));
+        sumHi = vaddw_u8(sumHi, vget_high_u8(texels));
+    }
+    vst1q_u8(target, vcombine_u8(BoxAverage(sumLo, iarr16), BoxAverage(sumHi, iarr16)));
+}
+
+/// Blur a strip of 16 columns starting at column x
+static void BlurColumnStrip(const uint8_t *source, uint8_t *target, const uint16_t width, const uint16_t height,
+                            const uint16_t x, const uint8_t radius, const uint32_t iarr)
+{
+    const uint16x4_t iarr16 = vdup_n_u16(uint16_t(iarr));
+    const auto       row    = [&](const int y) {
+        return vld1q_u8(&source[size_t(std::clamp(y, 0, height - 1)) * width + x]);
+    };
+
+    const uint8x16_t border = row(0);
+          uint16x8_t sumLo  = vmulq_n_u16(vmovl_u8(vget_low_u8(border)), radius + 1);
+          uint16x8_t sumHi  = vmulq_n_u16(vmovl_u8(vget_high_u8(border)), radius + 1);
+
+    for (uint16_t j = 0; j < radius; j++) {
+        const uint8x16_t texels = row(j);
+        sumLo = vaddw_u8(sumLo, vget_low_u8(texels));
+        sumHi = vaddw_u8(sumHi, vget_high_u8(texels));
+    }
+    for (uint16_t j = 0; j < height; j++) {
+        const uint8x16_t in  = row(j + radius);
+        const uint8x16_t out = row(j - radius - 1);
+        sumLo = vsubw_u8(vaddw_u8(sumLo, vget_low_u8(in)), vget_low_u8(out));
+        sumHi = vsubw_u8(vaddw_u8(sumHi, vget_high_u8(in)), vget_high_u8(out));
+        vst1q_u8(&target[size_t(j) * width + x], vcombine_u8(BoxAverage(sumLo, iarr16), BoxAverage(sumHi, iarr16)));
+    }
+}
+#endif // FOW_NEON
+
+#ifdef FOW_SIMD
+/**
+**  Vectorized horizontal box blur pass, gives the same result as BlurRowsScalar
+**
+**  Each row is copied with radius border texels on both sides, so that every box
+**  is a plain sum of 2 * radius + 1 texels, 16 boxes at a time.
+**
+*/
+static void BlurRowsVectorized(const uint8_t *source, uint8_t *target, const uint16_t width,
+                               const uint16_t lBound, const uint16_t uBound, const uint8_t radius, const uint32_t iarr)
+{
+    const uint16_t boxSize = 2 * radius + 1;
+    std::vector<uint8_t> padded(width + 2 * radius);
+
+    for (uint16_t i = lBound; i < uBound; i++) {
+        const uint8_t *row    = &source[size_t(i) * width];
+              uint8_t *trgRow = &target[size_t(i) * width];
+
+        std::fill_n(padded.begin(), radius, row[0]);
+        std::copy_n(row, width, padded.begin() + radius);
+        std::fill_n(padded.begin() + radius + width, radius, row[width - 1]);
+
+        uint16_t j = 0;
+        for (; j + 16 <= width; j += 16) {
+            BlurRowBlock(&padded[j], boxSize, iarr, &trgRow[j]);
+        }
+        for (; j < width; j++) {
+            uint32_t sum = 0;
+            for (uint16_t k = 0; k < boxSize; k++) {
+                sum += padded[j + k];
+            }
+            trgRow[j] = (iarr * sum + FixedOneHalf) >> 16;
+        }
+    }
+}
+
+/**
+**  Vectorized vertical box blur pass, gives the same result as BlurColumnsScalar
+**
+*/
+static void BlurColumnsVectorized(const uint8_t *source, uint8_t *target, const uint16_t width, const uint16_t height,
+                                  const uint16_t lBound, const uint16_t uBound, const uint8_t radius, const uint32_t iarr)
+{
+    uint16_t i = lBound;
+    for (; i + 16 <= uBound; i += 16) {
+        BlurColumnStrip(source, target, width, height, i, radius, iarr);
+    }
+    BlurColumnsScalar(source, target, width, height, i, uBound, radius, iarr);
+}
+#endif // FOW_SIMD
+
 /**
 ** Blur a texture (optimized for 1 chanel (alpha) textures)
 **
@@ -259,42 +529,28 @@ void CBlurer::Blur(uint8_t *const texture)
 {
     if (Radius * NumOfIterations == 0) { return; }
     
-    uint8_t *source = texture;
-    uint8_t *target = WorkingTexture.data();
-
-    for (uint8_t i = 0; i < HalfBoxes.size(); i++) {
-        if (i > 0) {
-            uint8_t *const swap = source;
-            source = target;
-            target = swap;
-        }
-        ProceedIteration(source, target, HalfBoxes[i]); 
-    }
-    if (target != texture) {
-        std::copy(WorkingTexture.begin(), WorkingTexture.end(), texture);
+    for (const uint8_t radius : HalfBoxes) {
+        ProceedIteration(texture, WorkingTexture.data(), radius); 
     }
 }
 
 /**
 **  Proceed one iteration of box bluring
 **
-**  @param  source  source texture (which has to be blured)
-**  @param  target  target texture (where result will be)
-**  @param  radius  blur radius (box size) for current iteration
+**  @param  texture     texture which has to be blured, the result will be there too
+**  @param  backBuffer  texture for the result of the horizontal pass
+**  @param  radius      blur radius (box size) for current iteration
 **
 */
-void CBlurer::ProceedIteration(uint8_t *source, uint8_t *target, const uint8_t radius)
+void CBlurer::ProceedIteration(uint8_t *texture, uint8_t *backBuffer, const uint8_t radius)
 {
-    constexpr uint32_t fixedOneHalf = 32768; // 0.5
-    
-    std::copy_n(&source[0], WorkingTexture.size(), target);
-
-    uint8_t *swap = source;
-    source = target;
-    target = swap; 
-
     /// *fixed point math
     const uint32_t iarr = (1 << 16) / (2 * radius + 1);
+
+    /// The vectorized passes keep the box sums and iarr in 16 bits
+#ifdef FOW_SIMD
+    const bool vectorized = Vectorized && radius > 0 && radius <= MaxVectorizedRadius;
+#endif
     
     /// Horizontal blur pass
     #pragma omp parallel
@@ -305,79 +561,257 @@ void CBlurer::ProceedIteration(uint8_t *source, uint8_t *target, const uint8_t r
         const uint16_t lBound = TextureHeight * (thisThread    ) / numOfThreads;
         const uint16_t uBound = TextureHeight * (thisThread + 1) / numOfThreads;
 
-        for (uint16_t i = lBound; i < uBound; i++) {
-
-            size_t ti = size_t(i) * TextureWidth; 
-            size_t li = ti;
-            size_t ri = ti + radius;
-
-            const uint8_t leftBorder  = source[ti];
-            const uint8_t rightBorder = source[ti + TextureWidth - 1];
-                  int16_t sum         = int16_t(radius + 1) * leftBorder;
-
-            for (uint16_t j = 0; j < radius; j++) { 
-                sum += source[ti + j]; 
-            }
-            for (uint16_t j = 0; j <= radius; j++) {
-                sum += source[ri++] - leftBorder; 
-                target[ti++] = (iarr * sum + fixedOneHalf) >> 16;
-            }
-            for (uint16_t j = radius + 1; j < TextureWidth - radius; j++) {
-                sum += source[ri++] - source[li++];
-                target[ti++] = (iarr * sum + fixedOneHalf) >> 16;
-            }
-            for (uint16_t j = TextureWidth - radius; j < TextureWidth; j++) {
-                sum += rightBorder - source[li++];   
-                target[ti++] = (iarr * sum + fixedOneHalf) >> 16;
-            }
+#ifdef FOW_SIMD
+        if (vectorized) {
+            BlurRowsVectorized(texture, backBuffer, TextureWidth, lBound, uBound, radius, iarr);
+        } else
+#endif
+        {
+            BlurRowsScalar(texture, backBuffer, TextureWidth, lBound, uBound, radius, iarr);
         }
     } // pragma omp parallel
 
-    swap = source;
-    source = target;
-    target = swap;  
-
     /// Vertical blur pass
     #pragma omp parallel
     {
         const uint16_t thisThread   = omp_get_thread_num();
         const uint16_t numOfThreads = omp_get_num_threads();
         
-        const uint16_t lBound = TextureWidth * (thisThread    ) / numOfThreads;
-        const uint16_t uBound = TextureWidth * (thisThread + 1) / numOfThreads;
+        /// Split the columns into 16 wide strips for the vectorized pass, the last thread takes the rest
+        const uint16_t numOfStrips = TextureWidth / 16;
+        const uint16_t lBound = numOfStrips * (thisThread    ) / numOfThreads * 16;
+        const uint16_t uBound = thisThread + 1 == numOfThreads ? TextureWidth
+                                                               : numOfStrips * (thisThread + 1) / numOfThreads * 16;
+
+#ifdef FOW_SIMD
+        if (vectorized) {
+            BlurColumnsVectorized(backBuffer, texture, TextureWidth, TextureHeight, lBound, uBound, radius, iarr);
+        } else
+#endif
+        {
+            BlurColumnsScalar(backBuffer, texture, TextureWidth, TextureHeight, lBound, uBound, radius, iarr);
+        }
+    } // pragma omp parallel
+}
 
-        for (uint16_t i = lBound; i < uBound; i++) {
+/**
+**  Determine upscale pattern (index in the upscale table) of a 2x2 square of the vision table
+**
+**  @param  vis             top left tile of the square in the vision table
+**  @param  visTableWidth   width of the vision table
+**  @param  visFlag         layer to determine pattern for
+**
+*/
+static inline uint8_t UpscalePattern(const uint8_t *vis, const size_t visTableWidth, const uint8_t visFlag)
+{
+    /// 1 if the tile is in the layer. Tiles out of the layer are 0, don't shift them by -1
+    const auto inLayer = [visFlag](const uint8_t tile) -> uint8_t {
+        const uint8_t n = visFlag & tile;
+        return n ? n >> (n - VisExplored) : 0;
+    };
+    const uint8_t n1 = inLayer(vis[0]);
+    const uint8_t n2 = inLayer(vis[1]);
+    const uint8_t n3 = inLayer(vis[visTableWidth]);
+    const uint8_t n4 = inLayer(vis[visTableWidth + 1]);
+    
+    return ( (n1 << 3) | (n2 << 2) | (n3 << 1) | n4 );
+}
 
-            size_t ti = i;
-            size_t li = ti;
-            size_t ri = ti + radius * TextureWidth;
+#ifdef FOW_SSE2
+/**
+**  Determine the upscale patterns of 16 neighbour tiles, Visible layer in the high nibble
+**  and Explored layer in the low nibble. Same bits as UpscalePattern gives:
+**  for the Visible layer it is bit 1 of the tile, for the Explored one bit 0 xor bit 1.
+*/
+static inline void UpscalePatterns16(const uint8_t *vis, const size_t visTableWidth, uint8_t *patterns)
+{
+    const __m128i one = _mm_set1_epi8(1);
+    const auto    layers = [&](const uint8_t *tiles) {
+        const __m128i tile    = _mm_loadu_si128((const __m128i *)tiles);
+        const __m128i shifted = _mm_srli_epi16(tile, 1);
+        const __m128i visible  = _mm_and_si128(shifted, one);
+        const __m128i explored = _mm_and_si128(_mm_xor_si128(tile, shifted), one);
+        return _mm_or_si128(_mm_slli_epi16(visible, 4), explored);
+    };
+    const __m128i n1 = layers(vis);
+    const __m128i n2 = layers(vis + 1);
+    const __m128i n3 = layers(vis + visTableWidth);
+    const __m128i n4 = layers(vis + visTableWidth + 1);
+
+    const __m128i result = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(n1, 3), _mm_slli_epi16(n2, 2)),
+                                        _mm_or_si128(_mm_slli_epi16(n3, 1), n4));
+    _mm_storeu_si128((__m128i *)patterns, result);
+}
 
-            const uint8_t leftBorder  = source[ti];
-            const uint8_t rightBorder = source[ti + TextureWidth * (TextureHeight - 1)];
-                  int16_t sum         = int16_t(radius + 1) * leftBorder;
+/// Fill 4 neighbour 4x4 tiles, one store for each scanline
+static inline void FillUpscaledTiles4(uint32_t *texture, const uint16_t textureWidth,
+                                      const uint8_t *patterns, const uint32_t (*upscaleTable)[4])
+{
+    const __m128i tile0 = _mm_load_si128((const __m128i *)upscaleTable[patterns[0]]);
+    const __m128i tile1 = _mm_load_si128((const __m128i *)upscaleTable[patterns[1]]);
+    const __m128i tile2 = _mm_load_si128((const __m128i *)upscaleTable[patterns[2]]);
+    const __m128i tile3 = _mm_load_si128((const __m128i *)upscaleTable[patterns[3]]);
+
+    const __m128i lines01Lo = _mm_unpacklo_epi32(tile0, tile1);
+    const __m128i lines01Hi = _mm_unpacklo_epi32(tile2, tile3);
+    const __m128i lines23Lo = _mm_unpackhi_epi32(tile0, tile1);
+    const __m128i lines23Hi = _mm_unpackhi_epi32(tile2, tile3);
+
+    _mm_storeu_si128((__m128i *)&texture[0],                _mm_unpacklo_epi64(lines01Lo, lines01Hi));
+    _mm_storeu_si128((__m128i *)&texture[textureWidth],     _mm_unpackhi_epi64(lines01Lo, lines01Hi));
+    _mm_storeu_si128((__m128i *)&texture[textureWidth * 2], _mm_unpacklo_epi64(lines23Lo, lines23Hi));
+    _mm_storeu_si128((__m128i *)&texture[textureWidth * 3], _mm_unpackhi_epi64(lines23Lo, lines23Hi));
+}
+#endif // FOW_SSE2
 
-            for (uint16_t j = 0; j < radius; j++) {
-                sum += source[ti + j * TextureWidth];
-            }
-            for (uint16_t j = 0; j <= radius ; j++) { 
-                sum += source[ri] - leftBorder;
-                target[ti] = (iarr * sum + fixedOneHalf) >> 16;
-                ri += TextureWidth;
-                ti += TextureWidth;
+#ifdef FOW_NEON
+/**
+**  Determine the upscale patterns of 16 neighbour tiles, Visible layer in the high nibble
+**  and Explored layer in the low nibble. Same bits as UpscalePattern gives:
+**  for the Visible layer it is bit 1 of the tile, for the Explored one bit 0 xor bit 1.
+*/
+static inline void UpscalePatterns16(const uint8_t *vis, const size_t visTableWidth, uint8_t *patterns)
+{
+    const uint8x16_t one    = vdupq_n_u8(1);
+    const auto       layers = [&](const uint8_t *tiles) {
+        const uint8x16_t tile     = vld1q_u8(tiles);
+        const uint8x16_t shifted  = vshrq_n_u8(tile, 1);
+        const uint8x16_t visible  = vandq_u8(shifted, one);
+        const uint8x16_t explored = vandq_u8(veorq_u8(tile, shifted), one);
+        return vorrq_u8(vshlq_n_u8(visible, 4), explored);
+    };
+    const uint8x16_t n1 = layers(vis);
+    const uint8x16_t n2 = layers(vis + 1);
+    const uint8x16_t n3 = layers(vis + visTableWidth);
+    const uint8x16_t n4 = layers(vis + visTableWidth + 1);
+
+    vst1q_u8(patterns, vorrq_u8(vorrq_u8(vshlq_n_u8(n1, 3), vshlq_n_u8(n2, 2)),
+                                vorrq_u8(vshlq_n_u8(n3, 1), n4)));
+}
+
+/// Fill 4 neighbour 4x4 tiles, one store for each scanline
+static inline void FillUpscaledTiles4(uint32_t *texture, const uint16_t textureWidth,
+                                      const uint8_t *patterns, const uint32_t (*upscaleTable)[4])
+{
+    const uint32x4x2_t tiles01 = vtrnq_u32(vld1q_u32(upscaleTable[patterns[0]]), vld1q_u32(upscaleTable[patterns[1]]));
+    const uint32x4x2_t tiles23 = vtrnq_u32(vld1q_u32(upscaleTable[patterns[2]]), vld1q_u32(upscaleTable[patterns[3]]));
+
+    vst1q_u32(&texture[0],                vcombine_u32(vget_low_u32(tiles01.val[0]),  vget_low_u32(tiles23.val[0])));
+    vst1q_u32(&texture[textureWidth],     vcombine_u32(vget_low_u32(tiles01.val[1]),  vget_low_u32(tiles23.val[1])));
+    vst1q_u32(&texture[textureWidth * 2], vcombine_u32(vget_high_u32(tiles01.val[0]), vget_high_u32(tiles23.val[0])));
+    vst1q_u32(&texture[textureWidth * 3], vcombine_u32(vget_high_u32(tiles01.val[1]), vget_high_u32(tiles23.val[1])));
+}
+#endif // FOW_NEON
+
+#ifdef FOW_SIMD
+/**
+**  Vectorized 4x4 upscale, gives the same result as the scalar one in UpscaleVisTable4x4
+**
+**  Visible and Explored tables are summed up beforehand for each pair of patterns,
+**  so each tile is one lookup of its 4 scanlines.
+**
+*/
+static void UpscaleVisTable4x4Vectorized(const uint8_t *const visTable, const size_t visTableWidth,
+                                         uint32_t *const texture, const uint16_t textureWidth, const uint16_t textureHeight,
+                                         const uint32_t (*tableVisible)[4], const uint32_t (*tableExplored)[4])
+{
+    alignas(16) uint32_t upscaleTable[256][4];
+    for (uint16_t pattern = 0; pattern < 256; pattern++) {
+        for (uint8_t scanLine = 0; scanLine < 4; scanLine++) {
+            upscaleTable[pattern][scanLine] = tableVisible[pattern >> 4][scanLine] + tableExplored[pattern & 0xF][scanLine];
+        }
+    }
+
+    #pragma omp parallel
+    {
+        const uint16_t thisThread   = omp_get_thread_num();
+        const uint16_t numOfThreads = omp_get_num_threads();
+        
+        const uint16_t lBound = (thisThread    ) * textureHeight / numOfThreads;
+        const uint16_t uBound = (thisThread + 1) * textureHeight / numOfThreads;
+
+        alignas(16) uint8_t patterns[16];
+
+        for (uint16_t row = lBound; row < uBound; row++) {
+            const uint8_t *vis  = &visTable[row * visTableWidth];
+                  uint32_t *tile = &texture[size_t(row) * textureWidth * 4];
+
+            uint16_t col = 0;
+            for (; col + 16 <= textureWidth; col += 16) {
+                UpscalePatterns16(&vis[col], visTableWidth, patterns);
+                for (uint8_t i = 0; i < 16; i += 4) {
+                    FillUpscaledTiles4(&tile[col + i], textureWidth, &patterns[i], upscaleTable);
+                }
             }
-            for (uint16_t j = radius + 1; j < TextureHeight - radius; j++) { 
-                sum += source[ri] - source[li];
-                target[ti] = (iarr * sum + fixedOneHalf) >> 16;
-                li += TextureWidth;
-                ri += TextureWidth;
-                ti += TextureWidth;
+            for (; col < textureWidth; col++) {
+                const uint8_t pattern = (UpscalePattern(&vis[col], visTableWidth, VisVisible) << 4)
+                                        | UpscalePattern(&vis[col], visTableWidth, VisVisible | VisExplored);
+                for (uint8_t scanLine = 0; scanLine < 4; scanLine++) {
+                    tile[col + scanLine * textureWidth] = upscaleTable[pattern][scanLine];
+                }
             }
-            for (uint16_t j = TextureHeight - radius; j < TextureHeight; j++) { 
-                sum += rightBorder - source[li];
-                target[ti] = (iarr * sum + fixedOneHalf) >> 16;
-                li += TextureWidth;
-                ti += TextureWidth;
+        }
+    } // pragma omp parallel
+}
+#endif // FOW_SIMD
+
+/**
+**  4x4 upscale the vision table into the fog texture
+**
+**  [1][2] checks neighbours (#2,#3,#4) for tile #1 to calculate upscale patterns
+**  [3][4] for Visible and Explored layers, and fills the 4x4 tile with
+**         sum of upscale table values for these patterns.
+**
+**  @param  visTable        vision table, from the tile to the left and up of the map.
+**                          It has one more column and row than the texture has tiles
+**  @param  visTableWidth   width of the vision table
+**  @param  texture         fog texture, in 32bits chunks (4 texels of a tile scanline)
+**  @param  textureWidth    fog texture width in 32bit chunks
+**  @param  textureHeight   fog texture height in tiles
+**  @param  tableVisible    scanlines of the tile for Visible layer patterns
+**  @param  tableExplored   scanlines of the tile for Explored layer patterns
+**  @param  vectorized      use the SIMD implementation if there is one for this CPU
+**
+*/
+void UpscaleVisTable4x4(const uint8_t *const visTable, const size_t visTableWidth,
+                        uint32_t *const texture, const uint16_t textureWidth, const uint16_t textureHeight,
+                        const uint32_t (*tableVisible)[4], const uint32_t (*tableExplored)[4],
+                        const bool vectorized /*= true*/)
+{
+#ifdef FOW_SIMD
+    if (vectorized) {
+        UpscaleVisTable4x4Vectorized(visTable, visTableWidth, texture, textureWidth, textureHeight, 
+                                     tableVisible, tableExplored);
+        return;
+    }
+#endif
+    const uint16_t nextRowOffset = textureWidth * 4;
+
+    #pragma omp parallel
+    {
+
+        const uint16_t thisThread   = omp_get_thread_num();
+        const uint16_t numOfThreads = omp_get_num_threads();
+        
+        const uint16_t lBound = (thisThread    ) * textureHeight / numOfThreads;
+        const uint16_t uBound = (thisThread + 1) * textureHeight / numOfThreads;
+
+        size_t visIndex      = lBound * visTableWidth;
+        size_t textureIndex  = lBound * nextRowOffset;
+        
+        for (uint16_t row = lBound; row < uBound; row++) {
+            for (uint16_t col = 0; col < textureWidth; col++) {
+                const uint8_t patternVisible  = UpscalePattern(&visTable[visIndex + col], visTableWidth, VisVisible);
+                const uint8_t patternExplored = UpscalePattern(&visTable[visIndex + col], visTableWidth, VisVisible | VisExplored);
+                /// Fill the 4x4 scaled tile
+                size_t index = textureIndex + col;
+                for (uint8_t scanLine = 0; scanLine < 4; scanLine++) {
+                    texture[index] = tableVisible[patternVisible][scanLine] + tableExplored[patternExplored][scanLine];
+                    index += textureWidth;
+                }
             }
+            visIndex     += visTableWidth;
+            textureIndex += nextRowOffset;
         }
     } // pragma omp parallel
 }
@@ -38,6 +38,7 @@
 
 #include "map.h"
 
+#include "distancefield.h"
 #include "fov.h"
 #include "iolib.h"
 #include "player.h"
@@ -148,6 +149,7 @@ void CMap::Reveal(MapRevealModes mode /* = MapRevealModes::cKnown */ )
 			}
 			MarkSeenTile(mf);
 		}
+		DistanceFieldsExploredChanged();
 	}
 
 	//  Global seen recount. Simple and effective.
@@ -155,7 +157,7 @@ void CMap::Reveal(MapRevealModes mode /* = MapRevealModes::cKnown */ )
 		//  Reveal neutral buildings. Gold mines:)
 		if (unit->Player->Type == PlayerTypes::PlayerNeutral) {
 			for (const CPlayer &player : Players) {
-				if (player.Type != PlayerTypes::PlayerNobody && (!(unit->Seen.ByPlayer & (1 << player.Index )))) {
+				if (player.Type != PlayerTypes::PlayerNobody && (!(unit->Cold->Seen.ByPlayer & (1 << player.Index )))) {
 					UnitGoesOutOfFog(*unit, player);
 					UnitGoesUnderFog(*unit, player);
 				}
@@ -341,6 +343,7 @@ void CMap::Create()
 	Assert(!this->Fields);
 
 	this->Fields = new CMapField[this->Info.MapWidth * this->Info.MapHeight];
+	this->ResetSectorEntryCycles();
 }
 
 /**
@@ -376,9 +379,14 @@ void CMap::Clean(const bool isHardClean /* = false*/)
 	UI.Minimap.Destroy();
 
 	FieldOfView.Clean();
+	CleanDistanceFields();
+	this->RegrowthCandidates.clear();
+	this->RegrowthCandidatesValid = false;
+	this->SectorEntryCycles.clear();
 	
 	FogOfWar->Clean(isHardClean);
-	for (CViewport *vp = UI.Viewports; vp < UI.Viewports + UI.NumViewports; ++vp) {
+	// The unused viewports may still hold units of a split view
+	for (CViewport *vp = UI.Viewports; vp < UI.Viewports + MAX_NUM_VIEWPORTS; ++vp) {
 		vp->Clean();
 	}
 
@@ -416,6 +424,18 @@ void CMap::Save(CFile &file) const
 			}
 		}
 	}
+	file.printf("},\n");
+	// Index and cycle of the unit entries, which decide when idle units look for enemies.
+	file.printf("  \"sector-entry-cycles\", {");
+	int count = 0;
+	for (size_t i = 0; i != this->SectorEntryCycles.size(); ++i) {
+		if (this->SectorEntryCycles[i] == 0) {
+			continue;
+		}
+		file.printf("%s%u, %lu", (count % 8) ? ", " : (count ? ",\n  " : "\n  "),
+					static_cast<unsigned int>(i), this->SectorEntryCycles[i]);
+		++count;
+	}
 	file.printf("}})\n");
 }
 
@@ -502,6 +522,10 @@ void CMap::FixTile(unsigned short type, int seen, const Vec2i &pos)
 			mf.setGraphicTile(removedtile);
 			mf.Flags &= ~flags;
 			mf.Value = 0;
+			DistanceFieldsTileChanged(pos);
+			if (type == MapFieldForest) {
+				this->RegrowthCandidates.push_back(index);
+			}
 			UI.Minimap.UpdateXY(pos);
 		}
 	} else if (seen && this->Tileset->isEquivalentTile(tile, mf.playerInfo.SeenTile)) { //Same Type
@@ -578,6 +602,8 @@ void CMap::ClearWoodTile(const Vec2i &pos)
 	mf.setGraphicTile(this->Tileset->getRemovedTreeTile());
 	mf.Flags &= ~(MapFieldCost4 | MapFieldCost5 | MapFieldCost6 | MapFieldForest | MapFieldUnpassable);
 	mf.Value = 0;
+	DistanceFieldsTileChanged(pos);
+	this->RegrowthCandidates.push_back(this->getIndex(pos));
 
 	UI.Minimap.UpdateXY(pos);
 	FixNeighbors(MapFieldForest, 0, pos);
@@ -596,6 +622,7 @@ void CMap::ClearRockTile(const Vec2i &pos)
 	mf.setGraphicTile(this->Tileset->getRemovedRockTile());
 	mf.Flags &= ~(MapFieldRocks | MapFieldUnpassable);
 	mf.Value = 0;
+	DistanceFieldsTileChanged(pos);
 
 	UI.Minimap.UpdateXY(pos);
 	FixNeighbors(MapFieldRocks, 0, pos);
@@ -667,11 +694,17 @@ void CMap::RegenerateForestTile(const Vec2i &pos)
 		}
 		FixNeighbors(MapFieldForest, 0, pos + offset);
 		FixNeighbors(MapFieldForest, 0, pos);
+		DistanceFieldsTileChanged(pos + offset);
+		DistanceFieldsTileChanged(pos);
 	}
 }
 
 /**
 **  Regenerate forest.
+**
+**  Only the fields with a removed tree are visited. They are kept
+**  sorted, so they are regenerated in the same order as a scan of the
+**  whole map, on all computers.
 */
 void CMap::RegenerateForest()
 {
@@ -681,12 +714,33 @@ void CMap::RegenerateForest()
 	if (ForestRegenerationFrequency != 1 && (GameCycle / CYCLES_PER_SECOND % ForestRegenerationFrequency) != 0) {
 		return; // not this second
 	}
-	Vec2i pos;
-	for (pos.y = 0; pos.y < Info.MapHeight; ++pos.y) {
-		for (pos.x = 0; pos.x < Info.MapWidth; ++pos.x) {
-			RegenerateForestTile(pos);
+	const unsigned int removedTreeTile = this->Tileset->getRemovedTreeTile();
+
+	if (!this->RegrowthCandidatesValid) {
+		// New or loaded map: find the removed trees once.
+		this->RegrowthCandidates.clear();
+		for (unsigned int i = 0; i != unsigned(Info.MapWidth * Info.MapHeight); ++i) {
+			if (this->Field(i)->getGraphicTile() == removedTreeTile) {
+				this->RegrowthCandidates.push_back(i);
+			}
+		}
+		this->RegrowthCandidatesValid = true;
+	} else {
+		std::sort(this->RegrowthCandidates.begin(), this->RegrowthCandidates.end());
+		this->RegrowthCandidates.erase(std::unique(this->RegrowthCandidates.begin(), this->RegrowthCandidates.end()),
+									   this->RegrowthCandidates.end());
+	}
+	size_t kept = 0;
+	for (size_t i = 0; i != this->RegrowthCandidates.size(); ++i) {
+		const unsigned int index = this->RegrowthCandidates[i];
+
+		RegenerateForestTile(Vec2i(index % Info.MapWidth, index / Info.MapWidth));
+		// Trees placed on the field above are dropped on next regeneration.
+		if (this->Field(index)->getGraphicTile() == removedTreeTile) {
+			this->RegrowthCandidates[kept++] = index;
 		}
 	}
+	this->RegrowthCandidates.resize(kept);
 }
 
 
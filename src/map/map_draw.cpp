@@ -427,7 +427,7 @@ void CViewport::Draw()
 	CurrentViewport = this;
 	{
 		// Now we need to sort units, missiles, particles by draw level and draw them
-		std::vector<CUnit *> unittable;
+		std::vector<CUnit *> &unittable = this->DrawnUnits;
 		std::vector<Missile *> missiletable;
 		std::vector<CParticle *> particletable;
 
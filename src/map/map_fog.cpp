@@ -40,6 +40,7 @@
 #include "map.h"
 
 #include "actions.h"
+#include "distancefield.h"
 #include "fov.h"
 #include "minimap.h"
 #include "player.h"
@@ -129,7 +130,7 @@ public:
 			//  If the unit goes out of fog, this can happen for any player that
 			//  this player shares vision with, and can't YET see the unit.
 			//  It will be able to see the unit after the Unit->VisCount ++
-			if (!unit->VisCount[p]) {
+			if (!unit->Cold->VisCount[p]) {
 				UnitGoesOutOfFog(*unit, *this->player);
 				for (const uint8_t pi : this->player->GetGaveVisionTo()) {
 					if (!unit->IsVisible(Players[pi])) {
@@ -137,29 +138,29 @@ public:
 					} 
 				}
 			}
-			unit->VisCount[p/*player->Index*/]++;
+			unit->Cold->VisCount[p/*player->Index*/]++;
 		} else {
 			/*
 			 * HACK: UGLY !!!
 			 * There is bug in Seen code conneded with
 			 * UnitActionDie and Cloaked units.
 			 */
-			if (!unit->VisCount[p] && unit->CurrentAction() == UnitActionDie) {
+			if (!unit->Cold->VisCount[p] && unit->CurrentAction() == UnitActionDie) {
 				return;
 			}
 
 			/// This could happen if shadow caster type of field of view is enabled, 
 			/// because of multiple calls for tiles in vertical/horizontal/diagonal lines
-			if(!unit->VisCount[p]) {
+			if(!unit->Cold->VisCount[p]) {
 				return;
 			}
 
-			unit->VisCount[p]--;
+			unit->Cold->VisCount[p]--;
 			//  If the unit goes under of fog, this can happen for any player that
 			//  this player shares vision to. First of all, before unmarking,
 			//  every player that this player shares vision to can see the unit.
 			//  Now we have to check who can't see the unit anymore.
-			if (!unit->VisCount[p]) {
+			if (!unit->Cold->VisCount[p]) {
 				UnitGoesUnderFog(*unit, *this->player);
 				for (const uint8_t pi : this->player->GetGaveVisionTo()) {
 					if (!unit->IsVisible(Players[pi])) {
@@ -217,10 +218,14 @@ void MapMarkTileSight(const CPlayer &player, const unsigned int index)
 		if (!Map.NoFogOfWar || *v == 0) {
 			UnitsOnTileMarkSeen(player, mf, 0);
 		}
+		const bool explored = *v == 1;
 		*v = 2;
 		if (mf.playerInfo.IsTeamVisible(*ThisPlayer)) {
 			Map.MarkSeenTile(mf);
 		}
+		if (!explored) {
+			DistanceFieldsTileExplored(player, Vec2i(index % Map.Info.MapWidth, index / Map.Info.MapWidth));
+		}
 	} else {
 		Assert(*v != 65535);
 		++*v;
@@ -441,6 +446,7 @@ void CViewport::AdjustFogSurface()
 
 void CViewport::Clean()
 {
+	this->DrawnUnits.clear();
 	if (this->FogSurface) {
 		CleanFog();
 	}
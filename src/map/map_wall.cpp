@@ -37,6 +37,7 @@
 
 #include "stratagus.h"
 #include "map.h"
+#include "distancefield.h"
 #include "fov.h"
 #include "tileset.h"
 #include "ui.h"
@@ -221,6 +222,7 @@ void CMap::RemoveWall(const Vec2i &pos)
 
 	MapFixWallTile(pos);
 	mf.Flags &= ~(MapFieldHuman | MapFieldWall | MapFieldUnpassable | MapFieldOpaque);
+	DistanceFieldsTileChanged(pos);
 	MapFixWallNeighbors(pos);
 	UI.Minimap.UpdateXY(pos);
 
@@ -255,6 +257,7 @@ void CMap::SetWall(const Vec2i &pos, bool humanwall)
 		const int value = UnitTypeOrcWall->MapDefaultStat.Variables[HP_INDEX].Max;
 		mf.setTileIndex(*Tileset, Tileset->getOrcWallTileIndex(0), value);
 	}
+	DistanceFieldsTileChanged(pos);
 
 	UI.Minimap.UpdateXY(pos);
 	MapFixWallTile(pos);
@@ -77,6 +77,14 @@ static int *Minimap2MapX;                  /// fast conversion table
 static int *Minimap2MapY;                  /// fast conversion table
 static int Map2MinimapX[MaxMapWidth];      /// fast conversion table
 static int Map2MinimapY[MaxMapHeight];     /// fast conversion table
+/// First minimap column showing the tile column, the next entry is the end
+static int Map2MinimapBeginX[MaxMapWidth + 1];
+/// First minimap row showing the tile row, the next entry is the end
+static int Map2MinimapBeginY[MaxMapHeight + 1];
+
+static uint32_t MinimapFogPixels[3];             /// Fog pixel of each visibility, as last drawn
+static bool MinimapFogValid {false};             /// MinimapFogSurface matches MinimapFogPixels
+static std::vector<unsigned int> MinimapFogTiles; /// Tiles whose fog changed, from the fog of war
 
 #define MAX_MINIMAP_EVENTS 8
 
@@ -106,8 +114,9 @@ void CMinimap::Create()
 	MinimapScaleX = (W * MINIMAP_FAC + n - 1) / n;
 	MinimapScaleY = (H * MINIMAP_FAC + n - 1) / n;
 
-	XOffset = (W - (Map.Info.MapWidth * MinimapScaleX) / MINIMAP_FAC + 1) / 2;
-	YOffset = (H - (Map.Info.MapHeight * MinimapScaleY) / MINIMAP_FAC + 1) / 2;
+	// The rounded up scale may overflow the minimap by a few pixels.
+	XOffset = std::max(0, (W - (Map.Info.MapWidth * MinimapScaleX) / MINIMAP_FAC + 1) / 2);
+	YOffset = std::max(0, (H - (Map.Info.MapHeight * MinimapScaleY) / MINIMAP_FAC + 1) / 2);
 
 	DebugPrint("MinimapScale %d %d (%d %d), X off %d, Y off %d\n" _C_
 			   MinimapScaleX / MINIMAP_FAC _C_ MinimapScaleY / MINIMAP_FAC _C_
@@ -133,6 +142,21 @@ void CMinimap::Create()
 	for (int i = 0; i < Map.Info.MapHeight; ++i) {
 		Map2MinimapY[i] = (i * MinimapScaleY) / MINIMAP_FAC;
 	}
+	// Inverse of Minimap2MapX and Minimap2MapY: pixels of each tile.
+	int mx = XOffset;
+	for (int i = 0; i <= Map.Info.MapWidth; ++i) {
+		while (mx < W - XOffset && Minimap2MapX[mx] < i) {
+			++mx;
+		}
+		Map2MinimapBeginX[i] = mx;
+	}
+	int my = YOffset;
+	for (int i = 0; i <= Map.Info.MapHeight; ++i) {
+		while (my < H - YOffset && Minimap2MapY[my] < i * Map.Info.MapWidth) {
+			++my;
+		}
+		Map2MinimapBeginY[i] = my;
+	}
 
 	// Palette updated from UpdateMinimapTerrain()
 	SDL_PixelFormat *f 	  = Map.TileGraphic->Surface->format;
@@ -144,6 +168,7 @@ void CMinimap::Create()
 	
 	const uint32_t fogColorSolid = FogOfWar->GetFogColorSDL() | (uint32_t(0xFF) << ASHIFT);
 	SDL_FillRect(MinimapFogSurface, NULL, fogColorSolid);
+	MinimapFogValid = false;
 	
 	UpdateTerrain();
 
@@ -236,7 +261,7 @@ void CMinimap::SetFogOpacityLevels(const uint8_t explored, const uint8_t reveale
 */
 void CMinimap::UpdateXY(const Vec2i &pos)
 {
-	if (!MinimapTerrainSurface) {
+	if (!MinimapTerrainSurface || !Map.Info.IsPointOnMap(pos)) {
 		return;
 	}
 
@@ -256,27 +281,10 @@ void CMinimap::UpdateXY(const Vec2i &pos)
 	//  Pixel 7,6 7,14, 15,6 15,14 are taken for the minimap picture.
 	//
 
-	const int ty = pos.y * Map.Info.MapWidth;
-	const int tx = pos.x;
-	for (int my = YOffset; my < H - YOffset; ++my) {
-		const int y = Minimap2MapY[my];
-		if (y < ty) {
-			continue;
-		}
-		if (y > ty) {
-			break;
-		}
-
-		for (int mx = XOffset; mx < W - XOffset; ++mx) {
-			const int x = Minimap2MapX[mx];
-
-			if (x < tx) {
-				continue;
-			}
-			if (x > tx) {
-				break;
-			}
-
+	const int y = pos.y * Map.Info.MapWidth;
+	const int x = pos.x;
+	for (int my = Map2MinimapBeginY[pos.y]; my < Map2MinimapBeginY[pos.y + 1]; ++my) {
+		for (int mx = Map2MinimapBeginX[pos.x]; mx < Map2MinimapBeginX[pos.x + 1]; ++mx) {
 			int tile = Map.Fields[x + y].playerInfo.SeenTile;
 			if (!tile) {
 				tile = Map.Fields[x + y].getGraphicTile();
@@ -312,7 +320,7 @@ static void DrawUnitOn(CUnit &unit, int red_phase)
 	if (Editor.Running || ReplayRevealMap || unit.IsVisible(*ThisPlayer) || unit.Player->IsRevealed()) {
 		type = unit.Type;
 	} else {
-		type = unit.Seen.Type;
+		type = unit.Cold->Seen.Type;
 		// This will happen for radar if the unit has not been seen and we
 		// have it on radar.
 		if (!type) {
@@ -363,6 +371,51 @@ static void DrawUnitOn(CUnit &unit, int red_phase)
 	}
 }
 
+/**
+**  Write the fog pixels of a tile, and of the margin pixels which show it.
+**
+**  The margins around the map repeat the first tile column and row.
+**
+**  @param minimap  The minimap.
+**  @param fog      Pixels of the minimap fog surface.
+**  @param pitch    Pitch of the fog surface, in pixels.
+**  @param tileX    Tile column.
+**  @param tileY    Tile row.
+**  @param pixel    Fog pixel of the tile.
+*/
+static void UpdateFogTile(const CMinimap &minimap, uint32_t *fog, int pitch, int tileX, int tileY, uint32_t pixel)
+{
+	const int W = minimap.W;
+	const int H = minimap.H;
+	const int XOffset = minimap.XOffset;
+	const int YOffset = minimap.YOffset;
+	const auto fill = [&](int x0, int x1, int y0, int y1) {
+		for (int y = y0; y < y1; ++y) {
+			std::fill(&fog[y * pitch + x0], &fog[y * pitch + x1], pixel);
+		}
+	};
+	const int x0 = Map2MinimapBeginX[tileX];
+	const int x1 = Map2MinimapBeginX[tileX + 1];
+	const int y0 = Map2MinimapBeginY[tileY];
+	const int y1 = Map2MinimapBeginY[tileY + 1];
+
+	fill(x0, x1, y0, y1);
+	if (tileX == 0) {
+		fill(0, XOffset, y0, y1);
+		fill(W - XOffset, W, y0, y1);
+	}
+	if (tileY == 0) {
+		fill(x0, x1, 0, YOffset);
+		fill(x0, x1, H - YOffset, H);
+	}
+	if (tileX == 0 && tileY == 0) {
+		fill(0, XOffset, 0, YOffset);
+		fill(W - XOffset, W, 0, YOffset);
+		fill(0, XOffset, H - YOffset, H);
+		fill(W - XOffset, W, H - YOffset, H);
+	}
+}
+
 /**
 **  Update the minimap with the current game information
 */
@@ -387,26 +440,46 @@ void CMinimap::Update()
 		SDL_BlitSurface(MinimapTerrainSurface, NULL, MinimapSurface, NULL);
 	}
 	const uint32_t fogColorSDL = FogOfWar->GetFogColorSDL();
+	// Only the tiles whose visibility changed are written, unless the fog
+	// colors or the surface changed since the last update.
+	const bool allFogChanged = FogOfWar->TakeVisibilityChanges(MinimapFogTiles);
 	if (!ReplayRevealMap) {
 		uint32_t *const minimapFog = static_cast<uint32_t *>(MinimapFogSurface->pixels);
-		size_t index = 0;
-		for (uint16_t my = 0; my < H; ++my) {
-			for (uint16_t mx = 0; mx < W; ++mx) {
-
-				const Vec2i tilePos(Minimap2MapX[mx], Minimap2MapY[my] / Map.Info.MapWidth);
-				const uint8_t vis = FogOfWar->GetVisibilityForTile(tilePos); 
-
-				const uint32_t fogAlpha = vis == 0 ? (GameSettings.RevealMap != MapRevealModes::cHidden ? Settings.FogRevealedOpacity : Settings.FogUnseenOpacity)
-											   	   : vis == 1 ? Settings.FogExploredOpacity 
-										   		   			  : Settings.FogVisibleOpacity;
+		const int fogPitch = MinimapFogSurface->pitch / sizeof(uint32_t);
+		const uint8_t fogAlpha[3] = {
+			GameSettings.RevealMap != MapRevealModes::cHidden ? Settings.FogRevealedOpacity : Settings.FogUnseenOpacity,
+			Settings.FogExploredOpacity,
+			Settings.FogVisibleOpacity
+		};
+		uint32_t fogPixels[3];
+		for (int i = 0; i != 3; ++i) {
+			fogPixels[i] = fogColorSDL | (uint32_t(fogAlpha[i]) << ASHIFT);
+		}
 
-				minimapFog[index++] = fogColorSDL | (fogAlpha << ASHIFT);
+		if (allFogChanged || !MinimapFogValid || memcmp(fogPixels, MinimapFogPixels, sizeof(fogPixels))) {
+			for (int tileY = 0; tileY != Map.Info.MapHeight; ++tileY) {
+				for (int tileX = 0; tileX != Map.Info.MapWidth; ++tileX) {
+					const uint8_t vis = FogOfWar->GetVisibilityForTile(Vec2i(tileX, tileY));
+					UpdateFogTile(*this, minimapFog, fogPitch, tileX, tileY, fogPixels[vis]);
+				}
+			}
+			memcpy(MinimapFogPixels, fogPixels, sizeof(fogPixels));
+			MinimapFogValid = true;
+		} else {
+			for (const unsigned int index : MinimapFogTiles) {
+				const int tileX = index % Map.Info.MapWidth;
+				const int tileY = index / Map.Info.MapWidth;
+				const uint8_t vis = FogOfWar->GetVisibilityForTile(Vec2i(tileX, tileY));
+				UpdateFogTile(*this, minimapFog, fogPitch, tileX, tileY, fogPixels[vis]);
 			}
 		}
 		/// Alpha blending the fog of war texture to minimap
 		/// TODO: switch to hardware rendering
 		const SDL_Rect fogRect {0, 0, W, H};
 		BlitSurfaceAlphaBlending_32bpp(MinimapFogSurface, &fogRect, MinimapSurface, &fogRect);
+	} else {
+		// The changes are lost meanwhile
+		MinimapFogValid = false;
 	}
 	//
 	// Draw units on map
@@ -36,6 +36,7 @@
 #include "stratagus.h"
 
 #include "map.h"
+#include "distancefield.h"
 #include "fov.h"
 #include "fow.h"
 #include "iolib.h"
@@ -97,6 +98,7 @@ static int CclStratagusMap(lua_State *l)
 
 					delete[] Map.Fields;
 					Map.Fields = new CMapField[Map.Info.MapWidth * Map.Info.MapHeight];
+					Map.ResetSectorEntryCycles();
 					// FIXME: this should be CreateMap or InitMap?
 				} else if (!strcmp(value, "fog-of-war")) {
 					Map.NoFogOfWar = false;
@@ -124,6 +126,16 @@ static int CclStratagusMap(lua_State *l)
 						lua_pop(l, 1);
 					}
 					lua_pop(l, 1);
+				} else if (!strcmp(value, "sector-entry-cycles")) {
+					lua_rawgeti(l, j + 1, k + 1);
+					if (!lua_istable(l, -1)) {
+						LuaError(l, "incorrect argument");
+					}
+					const int subsubargs = lua_rawlen(l, -1);
+					for (int i = 0; i + 1 < subsubargs; i += 2) {
+						Map.SetSectorEntryCycle(LuaToUnsignedNumber(l, -1, i + 1), LuaToUnsignedNumber(l, -1, i + 2));
+					}
+					lua_pop(l, 1);
 				} else {
 					LuaError(l, "Unsupported tag: %s" _C_ value);
 				}
@@ -774,13 +786,149 @@ void SetTile(unsigned int tileIndex, const Vec2i &pos, int value)
 				for (int j = 0; j < multiplier; j++) {
 					CMapField &mf = *Map.Field(Vec2i(pos.x + j, pos.y + i));
 					mf.setTileIndex(*Map.Tileset, tileIndex, value, subtile++);
+					DistanceFieldsTileChanged(Vec2i(pos.x + j, pos.y + i));
 				}
 			}
 		} else {
 			CMapField &mf = *Map.Field(pos);
 			mf.setTileIndex(*Map.Tileset, tileIndex, value);
+			DistanceFieldsTileChanged(pos);
+		}
+	}
+}
+
+/**
+**  Binary terrain file
+**
+**  Written by the editor instead of one SetTile call per tile. All
+**  numbers are 32 bit little endian:
+**
+**    "SMT1" width height
+**    width * height tile indexes, row by row
+**    width * height tile values, row by row
+**
+**  The file may be compressed, CFile reads it transparently.
+*/
+static const char MapTerrainMagic[4] = {'S', 'M', 'T', '1'};
+static const size_t MapTerrainHeaderSize = 12;
+
+static inline unsigned int ReadLE32(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static inline void WriteLE32(std::vector<unsigned char> &data, unsigned int value)
+{
+	data.push_back(value & 0xFF);
+	data.push_back((value >> 8) & 0xFF);
+	data.push_back((value >> 16) & 0xFF);
+	data.push_back((value >> 24) & 0xFF);
+}
+
+/**
+**  Set the tiles from a binary terrain file, starting at (0, 0).
+**
+**  @param file  Terrain file name
+**
+**  @return      0 on success, -1 if the file can't be read
+*/
+int LoadMapTerrain(const std::string &file)
+{
+	CFile fp;
+	if (fp.open(file.c_str(), CL_OPEN_READ) == -1) {
+		fprintf(stderr, "Can't open map terrain '%s'\n", file.c_str());
+		return -1;
+	}
+	std::vector<unsigned char> data;
+	unsigned char buf[65536];
+	int len;
+	while ((len = fp.read(buf, sizeof(buf))) > 0) {
+		data.insert(data.end(), buf, buf + len);
+	}
+	fp.close();
+
+	if (data.size() < MapTerrainHeaderSize || memcmp(&data[0], MapTerrainMagic, sizeof(MapTerrainMagic))) {
+		fprintf(stderr, "Invalid map terrain '%s'\n", file.c_str());
+		return -1;
+	}
+	const unsigned int width = ReadLE32(&data[4]);
+	const unsigned int height = ReadLE32(&data[8]);
+	const size_t count = size_t(width) * height;
+	if (width > 0xFFFF || height > 0xFFFF || data.size() != MapTerrainHeaderSize + count * 8) {
+		fprintf(stderr, "Invalid map terrain size in '%s'\n", file.c_str());
+		return -1;
+	}
+
+	const unsigned char *tiles = &data[MapTerrainHeaderSize];
+	const unsigned char *values = tiles + count * 4;
+	Vec2i pos;
+	for (pos.y = 0; pos.y < int(height); ++pos.y) {
+		for (pos.x = 0; pos.x < int(width); ++pos.x) {
+			SetTile(ReadLE32(tiles), pos, ReadLE32(values));
+			tiles += 4;
+			values += 4;
+		}
+	}
+	return 0;
+}
+
+/**
+**  Write the tiles of a map to a binary terrain file.
+**
+**  @param file    Terrain file name, compressed if it ends with .gz
+**  @param map     Map to save
+**  @param size    Size of the saved terrain; uncovered tiles get the default tile
+**  @param offset  Position of the map in the saved terrain
+*/
+void SaveMapTerrain(const std::string &file, const CMap &map, Vec2i size, Vec2i offset)
+{
+	const size_t count = size_t(size.x) * size.y;
+	std::vector<unsigned int> tiles(count, map.Tileset->getDefaultTileIndex());
+	std::vector<unsigned int> values(count, 0);
+
+	for (int i = 0; i < map.Info.MapHeight; ++i) {
+		for (int j = 0; j < map.Info.MapWidth; ++j) {
+			const int x = j + offset.x;
+			const int y = i + offset.y;
+			if (x < 0 || y < 0 || x >= size.x || y >= size.y) {
+				continue;
+			}
+			const CMapField &mf = map.Fields[j + i * map.Info.MapWidth];
+			tiles[x + y * size.x] = map.Tileset->findTileIndexByTile(mf.getGraphicTile());
+			values[x + y * size.x] = mf.Value;
 		}
 	}
+
+	std::vector<unsigned char> data;
+	data.reserve(MapTerrainHeaderSize + count * 8);
+	data.insert(data.end(), MapTerrainMagic, MapTerrainMagic + sizeof(MapTerrainMagic));
+	WriteLE32(data, size.x);
+	WriteLE32(data, size.y);
+	for (size_t i = 0; i != count; ++i) {
+		WriteLE32(data, tiles[i]);
+	}
+	for (size_t i = 0; i != count; ++i) {
+		WriteLE32(data, values[i]);
+	}
+
+	FileWriter *f = CreateFileWriter(file);
+	f->write(reinterpret_cast<const char *>(&data[0]), data.size());
+	delete f;
+}
+
+/**
+**  Set the tiles from a binary terrain file.
+**
+**  @param l  Lua state.
+*/
+static int CclLoadMapTerrain(lua_State *l)
+{
+	LuaCheckArgs(l, 1);
+	const std::string file = LibraryFileName(LuaToString(l, 1));
+	if (LoadMapTerrain(file) == -1) {
+		LuaError(l, "Can't load map terrain: %s" _C_ file.c_str());
+	}
+	return 0;
 }
 
 /**
@@ -897,6 +1045,7 @@ static int CclSetTileFlags(lua_State *l)
 	if (newBase) {
 		Map.Tileset->tiles[tilenumber].tileinfo.BaseTerrain = newBase;
 	}
+	Map.Tileset->clearTerrainTables();
 	return 0;
 }
 
@@ -1020,6 +1169,7 @@ void MapCclRegister()
 	lua_register(Lua, "ShowMapLocation", CclShowMapLocation);
 
 	lua_register(Lua, "SetTileSize", CclSetTileSize);
+	lua_register(Lua, "LoadMapTerrain", CclLoadMapTerrain);
 
 	lua_register(Lua, "SetFogOfWar", CclSetFogOfWar);
 	lua_register(Lua, "GetFogOfWar", CclGetFogOfWar);
@@ -648,6 +648,10 @@ void CTileset::buildTable(lua_State *l)
 	rockTable[19] = midOneRockTile;
 
 	buildWallReplacementTable();
+
+	//  Terrain lookups of the map editor and the random map transitions
+	clearTerrainTables();
+	buildTerrainTables();
 }
 
 void CTileset::buildWallReplacementTable()
@@ -223,6 +223,103 @@ void CTileset::clear()
 	memset(rockTable, 0, sizeof(rockTable));
 	memset(humanWallTable, 0, sizeof(humanWallTable));
 	memset(orcWallTable, 0, sizeof(orcWallTable));
+	clearTerrainTables();
+}
+
+/**
+**  Drop the terrain lookup tables, they are built again on next use.
+**  To be called when the terrain of tiles changes.
+*/
+void CTileset::clearTerrainTables()
+{
+	terrainCount = 0;
+	terrainTileTable.clear();
+	graphicTileTable.clear();
+	terrainMixes.clear();
+	tilePathLength.clear();
+	tilePathTile.clear();
+}
+
+/**
+**  Build the terrain lookup tables.
+**
+**  The tiles are visited like the former linear searches did, a solid
+**  section steps by 16 tiles and a mixed one by 256, so the tables give
+**  the same first matches. The tile paths are the results of
+**  findTilePath with only the start terrain marked: their length is the
+**  number of steps to a terrain mixed with the goal, found by relaxing
+**  all terrains TILE_PATH_MAX times.
+*/
+void CTileset::buildTerrainTables() const
+{
+	int count = 1;
+	for (size_t i = 0; i != tiles.size(); ++i) {
+		count = std::max<int>(count, std::max(tiles[i].tileinfo.BaseTerrain, tiles[i].tileinfo.MixTerrain) + 1);
+	}
+	terrainCount = count;
+	terrainTileTable.assign(count * count, -1);
+	terrainMixes.assign(count, std::vector<std::pair<int, int>>());
+	for (size_t i = 0; i != tiles.size();) {
+		const CTileInfo &info = tiles[i].tileinfo;
+		int &first = terrainTileTable[info.BaseTerrain * count + info.MixTerrain];
+		if (first == -1) {
+			first = i;
+		}
+		if (info.MixTerrain) {
+			terrainMixes[info.BaseTerrain].push_back(std::make_pair(int(i), int(info.MixTerrain)));
+		}
+		if (info.BaseTerrain && info.BaseTerrain != info.MixTerrain) {
+			terrainMixes[info.MixTerrain].push_back(std::make_pair(int(i), int(info.BaseTerrain)));
+		}
+		// Advance solid or mixed.
+		i += info.MixTerrain ? 256 : 16;
+	}
+
+	unsigned int maxTile = 0;
+	for (size_t i = 0; i != tiles.size(); ++i) {
+		maxTile = std::max<unsigned int>(maxTile, tiles[i].tile);
+	}
+	graphicTileTable.assign(maxTile + 1, -1);
+	for (size_t i = 0; i != tiles.size(); ++i) {
+		int &first = graphicTileTable[tiles[i].tile];
+		if (first == -1) {
+			first = i;
+		}
+	}
+
+	tilePathLength.assign(count * count, TILE_PATH_MAX);
+	tilePathTile.assign(count * count, -1);
+	std::vector<int> steps(count);
+	for (int goal = 0; goal != count; ++goal) {
+		// steps to a terrain mixed with the goal
+		for (int t = 0; t != count; ++t) {
+			const bool mixed = terrainTileTable[t * count + goal] != -1 || terrainTileTable[goal * count + t] != -1;
+			steps[t] = mixed ? 0 : TILE_PATH_MAX;
+		}
+		for (int length = 1; length < TILE_PATH_MAX; ++length) {
+			for (int t = 0; t != count; ++t) {
+				for (size_t k = 0; k != terrainMixes[t].size(); ++k) {
+					steps[t] = std::min(steps[t], steps[terrainMixes[t][k].second] + 1);
+				}
+			}
+		}
+		for (int base = 0; base != count; ++base) {
+			const int index = base * count + goal;
+			tilePathLength[index] = steps[base];
+			if (steps[base] == 0) {
+				tilePathTile[index] = terrainTileTable[index] != -1 ? terrainTileTable[index] : terrainTileTable[goal * count + base];
+			} else if (steps[base] < TILE_PATH_MAX) {
+				// first mixed tile which leads to the goal the fastest
+				for (size_t k = 0; k != terrainMixes[base].size(); ++k) {
+					const int next = terrainMixes[base][k].second;
+					if (next != base && steps[next] + 1 == steps[base]) {
+						tilePathTile[index] = terrainMixes[base][k].first;
+						break;
+					}
+				}
+			}
+		}
+	}
 }
 
 unsigned int CTileset::getDefaultTileIndex() const
@@ -330,20 +427,13 @@ unsigned int CTileset::getSolidTerrainCount() const
 
 int CTileset::findTileIndex(unsigned char baseTerrain, unsigned char mixTerrain) const
 {
-	const CTileInfo tileInfo(baseTerrain, mixTerrain);
-
-	for (size_t i = 0; i != tiles.size();) {
-		if (tiles[i].tileinfo == tileInfo) {
-			return i;
-		}
-		// Advance solid or mixed.
-		if (!tiles[i].tileinfo.MixTerrain) {
-			i += 16;
-		} else {
-			i += 256;
-		}
+	if (terrainTileTable.empty()) {
+		buildTerrainTables();
 	}
-	return -1;
+	if (baseTerrain >= terrainCount || mixTerrain >= terrainCount) {
+		return -1;
+	}
+	return terrainTileTable[baseTerrain * terrainCount + mixTerrain];
 }
 
 int CTileset::getTileIndex(unsigned char baseTerrain, unsigned char mixTerrain, unsigned int quad) const
@@ -388,38 +478,52 @@ int CTileset::findTilePath(int base, int goal, int length, std::vector<char> &ma
 		*tileIndex = tileres;
 		return length;
 	}
-	if (length >= TILE_PATH_MAX) {
+	if (length >= TILE_PATH_MAX || base < 0 || base >= terrainCount) {
 		return TILE_PATH_MAX;
 	}
 	// Find any mixed tile
 	int l = TILE_PATH_MAX;
-	for (size_t i = 0; i != tiles.size();) {
-		int j = 0;
-		if (base == tiles[i].tileinfo.BaseTerrain) {
-			j = tiles[i].tileinfo.MixTerrain;
-		} else if (base == tiles[i].tileinfo.MixTerrain) {
-			j = tiles[i].tileinfo.BaseTerrain;
-		}
-		if (j != 0 && marks[j] == 0) { // possible path found
+	const std::vector<std::pair<int, int>> &mixes = terrainMixes[base];
+	for (size_t i = 0; i != mixes.size(); ++i) {
+		const int j = mixes[i].second;
+		if (marks[j] == 0) { // possible path found
 			marks[j] = j;
 			int dummytileIndex;
 			const int n = findTilePath(j, goal, length + 1, marks, &dummytileIndex);
 			marks[j] = 0;
 			if (n < l) {
-				*tileIndex = i;
+				*tileIndex = mixes[i].first;
 				l = n;
 			}
 		}
-		// Advance solid or mixed.
-		if (tiles[i].tileinfo.MixTerrain == 0) {
-			i += 16;
-		} else {
-			i += 256;
-		}
 	}
 	return l;
 }
 
+/**
+**  Find a tile path, with only the start tile type marked as visited.
+**
+**  @param base       Start tile type.
+**  @param goal       Goal tile type.
+**  @param tileIndex  Set to the first tile of the path, if one is found.
+**
+**  @return           Path length, TILE_PATH_MAX if there is none.
+*/
+int CTileset::findTilePath(int base, int goal, int *tileIndex) const
+{
+	if (terrainTileTable.empty()) {
+		buildTerrainTables();
+	}
+	if (base < 0 || base >= terrainCount || goal < 0 || goal >= terrainCount) {
+		return TILE_PATH_MAX;
+	}
+	const int index = base * terrainCount + goal;
+	if (tilePathLength[index] < TILE_PATH_MAX) {
+		*tileIndex = tilePathTile[index];
+	}
+	return tilePathLength[index];
+}
+
 /**
 **  Get tile from quad.
 **
@@ -484,10 +588,7 @@ int CTileset::tileFromQuad(unsigned fixed, unsigned quad) const
 		return tileIndex;
 	}
 	// Find the best tile path.
-	std::vector<char> marks;
-	marks.resize(getSolidTerrainCount(), 0);
-	marks[type1] = type1;
-	if (findTilePath(type1, type2, 0, marks, &tileIndex) == TILE_PATH_MAX) {
+	if (findTilePath(type1, type2, &tileIndex) == TILE_PATH_MAX) {
 		DebugPrint("Huch, no mix found!!!!!!!!!!!\n");
 		const int res = findTileIndex(type1);
 		Assert(res != -1);
@@ -572,12 +673,10 @@ bool CTileset::isEquivalentTile(unsigned int tile1, unsigned int tile2) const
 
 int CTileset::findTileIndexByTile(unsigned int tile) const
 {
-	for (size_t i = 0; i != tiles.size(); ++i) {
-		if (tile == tiles[i].tile) {
-			return i;
-		}
+	if (graphicTileTable.empty()) {
+		buildTerrainTables();
 	}
-	return -1;
+	return tile < graphicTileTable.size() ? graphicTileTable[tile] : -1;
 }
 
 /**
@@ -66,6 +66,9 @@ unsigned int Missile::Count = 0;
 static std::vector<Missile *> GlobalMissiles;    /// all global missiles on map
 static std::vector<Missile *> LocalMissiles;     /// all local missiles on map
 
+/// Memory of the deleted missiles, by size in pointer units, for reuse
+static std::vector<std::vector<void *> > MissileFreeBlocks;
+
 /// lookup table for missile names
 typedef std::map<std::string, MissileType *> MissileTypeMap;
 static MissileTypeMap MissileTypes;
@@ -161,6 +164,57 @@ Missile::Missile() :
 	this->Slot = Missile::Count++;
 }
 
+/**
+**  Allocate a missile, from the memory of a deleted one if possible.
+**
+**  Battles create and delete missiles all the time, so the memory of
+**  each deleted missile is kept for the next one of the same size.
+**
+**  @param size  Size of the missile class.
+**
+**  @return      Memory for the missile.
+*/
+/* static */ void *Missile::operator new(size_t size)
+{
+	const size_t index = (size + sizeof(void *) - 1) / sizeof(void *);
+
+	if (index < MissileFreeBlocks.size() && !MissileFreeBlocks[index].empty()) {
+		void *p = MissileFreeBlocks[index].back();
+		MissileFreeBlocks[index].pop_back();
+		return p;
+	}
+	return ::operator new(size);
+}
+
+/**
+**  Keep the memory of a deleted missile for reuse.
+**
+**  @param p     Memory of the missile.
+**  @param size  Size of the missile class.
+*/
+/* static */ void Missile::operator delete(void *p, size_t size)
+{
+	const size_t index = (size + sizeof(void *) - 1) / sizeof(void *);
+
+	if (index >= MissileFreeBlocks.size()) {
+		MissileFreeBlocks.resize(index + 1);
+	}
+	MissileFreeBlocks[index].push_back(p);
+}
+
+/**
+**  Free the memory kept for the next missiles.
+*/
+/* static */ void Missile::FreePool()
+{
+	for (size_t i = 0; i != MissileFreeBlocks.size(); ++i) {
+		for (size_t j = 0; j != MissileFreeBlocks[i].size(); ++j) {
+			::operator delete(MissileFreeBlocks[i][j]);
+		}
+	}
+	MissileFreeBlocks.clear();
+}
+
 /**
 **  Initialize a new made missile.
 **
@@ -559,18 +613,23 @@ void Missile::DrawMissile(const CViewport &vp) const
 	}
 }
 
+static bool MissileSlotCompare(const Missile *const l, const Missile *const r)
+{
+	return l->Slot < r->Slot;
+}
+
 static bool MissileDrawLevelCompare(const Missile *const l, const Missile *const r)
 {
-	if (l->Type->DrawLevel == r->Type->DrawLevel) {
-		return l->Slot < r->Slot;
-	} else {
-		return l->Type->DrawLevel < r->Type->DrawLevel;
-	}
+	return l->Type->DrawLevel < r->Type->DrawLevel;
 }
 
 /**
 **  Sort visible missiles on map for display.
 **
+**  Missiles are made in slot order and their tables keep it, so merging
+**  the global and local ones gives the slot order; a stable sort by draw
+**  level then needs no other key.
+**
 **  @param vp         Viewport pointer.
 **  @param table      OUT : array of missile to display sorted by DrawLevel.
 */
@@ -590,6 +649,8 @@ void FindAndSortMissiles(const CViewport &vp, std::vector<Missile *> &table)
 		}
 	}
 
+	const size_t nglobal = table.size();
+
 	for (MissilePtrConstiterator i = LocalMissiles.begin(); i != LocalMissiles.end(); ++i) {
 		Missile &missile = *(*i);
 		if (missile.Delay || missile.Hidden) {
@@ -598,7 +659,8 @@ void FindAndSortMissiles(const CViewport &vp, std::vector<Missile *> &table)
 		// Local missile are visible.
 		table.push_back(&missile);
 	}
-	std::sort(table.begin(), table.end(), MissileDrawLevelCompare);
+	std::inplace_merge(table.begin(), table.begin() + nglobal, table.end(), MissileSlotCompare);
+	std::stable_sort(table.begin(), table.end(), MissileDrawLevelCompare);
 }
 
 /**
@@ -1161,16 +1223,21 @@ void Missile::NextMissileFrameCycle()
 /**
 **  Handle all missile actions of global/local missiles.
 **
+**  The living missiles are moved down over the dead ones while looping,
+**  so that the order of the table is kept in a single pass.
+**
 **  @param missiles  Table of missiles.
 */
 static void MissilesActionLoop(std::vector<Missile *> &missiles)
 {
-	for (size_t i = 0; i != missiles.size(); /* empty */) {
+	size_t alive = 0;
+
+	for (size_t i = 0; i != missiles.size(); ++i) {
 		Missile &missile = *missiles[i];
 
 		if (missile.Delay) {
 			missile.Delay--;
-			++i;
+			missiles[alive++] = &missile;
 			continue;  // delay start of missile
 		}
 		if (missile.TTL > 0) {
@@ -1178,22 +1245,21 @@ static void MissilesActionLoop(std::vector<Missile *> &missiles)
 		}
 		if (missile.TTL == 0) {
 			delete &missile;
-			missiles.erase(missiles.begin() + i);
 			continue;
 		}
 		Assert(missile.Wait);
 		if (--missile.Wait) {  // wait until time is over
-			++i;
+			missiles[alive++] = &missile;
 			continue;
 		}
 		missile.Action(); // may create other missiles, and so modifies the array
 		if (missile.TTL == 0) {
 			delete &missile;
-			missiles.erase(missiles.begin() + i);
 			continue;
 		}
-		++i;
+		missiles[alive++] = &missile;
 	}
+	missiles.resize(alive);
 }
 
 /**
@@ -1399,6 +1465,7 @@ void CleanMissiles()
 		delete *i;
 	}
 	LocalMissiles.clear();
+	Missile::FreePool();
 }
 
 void FreeBurningBuildingFrames()
@@ -192,6 +192,24 @@ size_t deserialize(const unsigned char *buf, std::vector<unsigned char> &data)
 	//Wyrmgus end
 }
 
+/**
+**  Deserialize a command buffer which must fit in the len remaining bytes.
+**
+**  @return the number of bytes read, or 0 if the buffer is truncated.
+*/
+static size_t deserializeBounded(const unsigned char *buf, unsigned int len, std::vector<unsigned char> &data)
+{
+	if (len < 2) {
+		return 0;
+	}
+	uint16_t size;
+	deserialize16(buf, &size);
+	if (2 + size + 3u > len) {
+		return 0;
+	}
+	return deserialize(buf, data);
+}
+
 //
 // CNetworkHost
 //
@@ -225,6 +243,8 @@ void CNetworkHost::Clear()
 	this->Port = 0;
 	this->PlyNr = 0;
 	memset(this->PlyName, 0, sizeof(this->PlyName));
+	this->Rtt = 0;
+	this->RttJitter = 0;
 }
 
 void CNetworkHost::SetName(const char *name)
@@ -343,7 +363,7 @@ CInitMessage_Hello::CInitMessage_Hello(const char *name) :
 	header(MessageInit_FromClient, ICMHello)
 {
 	strncpy_s(this->PlyName, sizeof(this->PlyName), name, _TRUNCATE);
-	this->Stratagus = StratagusVersion;
+	this->Stratagus = NetworkProtocolVersion;
 	this->Version = FileChecksums;
 }
 
@@ -405,7 +425,7 @@ void CInitMessage_Config::Deserialize(const unsigned char *p)
 CInitMessage_EngineMismatch::CInitMessage_EngineMismatch() :
 	header(MessageInit_FromServer, ICMEngineMismatch)
 {
-	this->Stratagus = StratagusVersion;
+	this->Stratagus = NetworkProtocolVersion;
 }
 
 const unsigned char *CInitMessage_EngineMismatch::Serialize() const
@@ -772,6 +792,104 @@ size_t CNetworkSelection::Size() const
 	return 2 + 2 + 2 * Units.size();
 }
 
+//
+// CNetworkSyncState
+//
+
+size_t CNetworkSyncState::Serialize(unsigned char *buf) const
+{
+	unsigned char *p = buf;
+	p += serialize16(p, this->player);
+	p += serialize32(p, this->cycle);
+	for (int i = 0; i != SyncStateSubsystemCount; ++i) {
+		p += serialize32(p, this->hash[i]);
+	}
+	return p - buf;
+}
+
+size_t CNetworkSyncState::Deserialize(const unsigned char *buf)
+{
+	const unsigned char *p = buf;
+	p += deserialize16(p, &this->player);
+	p += deserialize32(p, &this->cycle);
+	for (int i = 0; i != SyncStateSubsystemCount; ++i) {
+		p += deserialize32(p, &this->hash[i]);
+	}
+	return p - buf;
+}
+
+//
+// CNetworkSyncStateParts
+//
+
+size_t CNetworkSyncStateParts::Serialize(unsigned char *buf) const
+{
+	unsigned char *p = buf;
+
+	p += serialize16(p, this->player);
+	p += serialize32(p, this->cycle);
+	p += serialize8(p, this->subsystem);
+	p += serialize16(p, this->offset);
+	p += serialize16(p, uint16_t(this->parts.size()));
+	for (size_t i = 0; i != this->parts.size(); ++i) {
+		p += serialize32(p, this->parts[i]);
+	}
+	return p - buf;
+}
+
+size_t CNetworkSyncStateParts::Deserialize(const unsigned char *buf)
+{
+	const unsigned char *p = buf;
+
+	uint16_t size;
+	p += deserialize16(p, &this->player);
+	p += deserialize32(p, &this->cycle);
+	p += deserialize8(p, &this->subsystem);
+	p += deserialize16(p, &this->offset);
+	p += deserialize16(p, &size);
+	this->parts.resize(size);
+	for (size_t i = 0; i != this->parts.size(); ++i) {
+		p += deserialize32(p, &this->parts[i]);
+	}
+	return p - buf;
+}
+
+//
+// CNetworkPing
+//
+
+size_t CNetworkPing::Serialize(unsigned char *buf) const
+{
+	unsigned char *p = buf;
+	p += serialize32(p, this->ticks);
+	return p - buf;
+}
+
+size_t CNetworkPing::Deserialize(const unsigned char *buf)
+{
+	const unsigned char *p = buf;
+	p += deserialize32(p, &this->ticks);
+	return p - buf;
+}
+
+//
+// CNetworkCommandLag
+//
+
+size_t CNetworkCommandLag::Serialize(unsigned char *buf) const
+{
+	unsigned char *p = buf;
+	p += serialize16(p, this->lag);
+	return p - buf;
+}
+
+size_t CNetworkCommandLag::Deserialize(const unsigned char *buf)
+{
+	const unsigned char *p = buf;
+	p += deserialize16(p, &this->lag);
+	return p - buf;
+}
+
 //
 // CNetworkPacketHeader
 //
@@ -800,6 +918,59 @@ size_t CNetworkPacketHeader::Deserialize(const unsigned char *buf)
 	return p - buf;
 }
 
+//
+// CNetworkRedundantCommands
+//
+
+size_t CNetworkRedundantCommands::Serialize(unsigned char *buf) const
+{
+	size_t size = 0;
+
+	size += serialize8(buf ? buf + size : NULL, this->Cycle);
+	size += serialize8(buf ? buf + size : NULL, this->NumCommands);
+	for (int i = 0; i != this->NumCommands; ++i) {
+		size += serialize8(buf ? buf + size : NULL, this->Type[i]);
+	}
+	for (int i = 0; i != this->NumCommands; ++i) {
+		size += serialize(buf ? buf + size : NULL, this->Command[i]);
+	}
+	return size;
+}
+
+/**
+**  @return the number of bytes read, or 0 if the block is malformed.
+*/
+size_t CNetworkRedundantCommands::Deserialize(const unsigned char *buf, unsigned int len)
+{
+	const unsigned char *p = buf;
+
+	if (len < 2) {
+		return 0;
+	}
+	p += deserialize8(p, &this->Cycle);
+	p += deserialize8(p, &this->NumCommands);
+	len -= 2;
+	if (this->NumCommands == 0 || this->NumCommands > MaxNetworkCommands || len < this->NumCommands) {
+		return 0;
+	}
+	for (int i = 0; i != this->NumCommands; ++i) {
+		p += deserialize8(p, &this->Type[i]);
+		if (this->Type[i] == MessageNone) {
+			return 0;
+		}
+	}
+	len -= this->NumCommands;
+	for (int i = 0; i != this->NumCommands; ++i) {
+		const size_t r = deserializeBounded(p, len, this->Command[i]);
+		if (r == 0) {
+			return 0;
+		}
+		p += r;
+		len -= r;
+	}
+	return p - buf;
+}
+
 //
 // CNetworkPacket
 //
@@ -812,20 +983,60 @@ size_t CNetworkPacket::Serialize(unsigned char *buf, int numcommands) const
 	for (int i = 0; i != numcommands; ++i) {
 		p += serialize(p, this->Command[i]);
 	}
+	for (size_t i = 0; i != this->Redundant.size(); ++i) {
+		p += this->Redundant[i].Serialize(p);
+	}
 	return p - buf;
 }
 
+/**
+**  Read a packet.
+**
+**  @param p             Received bytes.
+**  @param len           Number of received bytes.
+**  @param commandCount  Set to the number of commands of the packet cycle, -1 if the packet is malformed.
+*/
 void CNetworkPacket::Deserialize(const unsigned char *p, unsigned int len, int *commandCount)
 {
+	this->Redundant.clear();
+	if (len < CNetworkPacketHeader::Size()) {
+		*commandCount = -1;
+		return;
+	}
 	this->Header.Deserialize(p);
 	p += CNetworkPacketHeader::Size();
 	len -= CNetworkPacketHeader::Size();
 
-	for (*commandCount = 0; len != 0; ++*commandCount) {
-		const size_t r = deserialize(p, this->Command[*commandCount]);
+	for (*commandCount = 0; *commandCount != MaxNetworkCommands && this->Header.Type[*commandCount] != MessageNone; ++*commandCount) {
+		const size_t r = deserializeBounded(p, len, this->Command[*commandCount]);
+		if (r == 0) {
+			*commandCount = -1;
+			return;
+		}
 		p += r;
 		len -= r;
 	}
+	while (len != 0) {
+		CNetworkRedundantCommands redundant;
+		const size_t r = redundant.Deserialize(p, len);
+		if (r == 0) {
+			*commandCount = -1;
+			return;
+		}
+		this->Redundant.push_back(redundant);
+		p += r;
+		len -= r;
+	}
+}
+
+/**
+**  Number of bytes a command takes in a packet.
+**
+**  @param command  Serialized command.
+*/
+size_t CNetworkPacket::CommandSize(const std::vector<unsigned char> &command)
+{
+	return serialize(NULL, command);
 }
 
 size_t CNetworkPacket::Size(int numcommands) const
@@ -836,6 +1047,9 @@ size_t CNetworkPacket::Size(int numcommands) const
 	for (int i = 0; i != numcommands; ++i) {
 		size += serialize(NULL, this->Command[i]);
 	}
+	for (size_t i = 0; i != this->Redundant.size(); ++i) {
+		size += this->Redundant[i].Size();
+	}
 	return size;
 }
 
@@ -1006,8 +1006,8 @@ void CClient::Parse_EngineMismatch(const unsigned char *buf)
 
 	msg.Deserialize(buf);
 	const std::string serverHostStr = serverHost.toString();
-	fprintf(stderr, "Incompatible Stratagus version %d <-> %d\nfrom %s\n",
-			StratagusVersion, msg.Stratagus, serverHostStr.c_str());
+	fprintf(stderr, "Incompatible network protocol " NetworkProtocolFormatString " <-> " NetworkProtocolFormatString "\nfrom %s\n",
+			NetworkProtocolFormatArgs(NetworkProtocolVersion), NetworkProtocolFormatArgs(msg.Stratagus), serverHostStr.c_str());
 	networkState.State = ccs_incompatibleengine;
 }
 
@@ -1520,10 +1520,13 @@ void CServer::Parse_SeeYou(const int h)
 */
 static int CheckVersions(const CInitMessage_Hello &msg, CUDPSocket &socket, const CHost &host)
 {
-	if (msg.Stratagus != StratagusVersion) {
+	// An engine of the same version without the message revision
+	// does not understand the in-game messages, check both parts.
+	if (NetworkProtocolEngineOf(msg.Stratagus) != NetworkProtocolEngineVersion
+		|| NetworkProtocolRevisionOf(msg.Stratagus) != NetworkProtocolRevision) {
 		const std::string hostStr = host.toString();
-		fprintf(stderr, "Incompatible Stratagus version %d <-> %d from %s\n",
-				StratagusVersion, msg.Stratagus, hostStr.c_str());
+		fprintf(stderr, "Incompatible network protocol " NetworkProtocolFormatString " <-> " NetworkProtocolFormatString " from %s\n",
+				NetworkProtocolFormatArgs(NetworkProtocolVersion), NetworkProtocolFormatArgs(msg.Stratagus), hostStr.c_str());
 
 		const CInitMessage_EngineMismatch message;
 		NetworkSendICMessage_Log(socket, host, message);
@@ -0,0 +1,187 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name netimpairment.cpp - Simulated network impairment. */
+//
+//      (c) Copyright 2024 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+//@{
+
+//----------------------------------------------------------------------------
+//  Includes
+//----------------------------------------------------------------------------
+
+#include "stratagus.h"
+
+#include "network/netimpairment.h"
+
+#include <sstream>
+
+//----------------------------------------------------------------------------
+//  Variables
+//----------------------------------------------------------------------------
+
+/* static */ CNetworkImpairment CNetworkImpairment::Instance;
+
+//----------------------------------------------------------------------------
+//  Functions
+//----------------------------------------------------------------------------
+
+/**
+**  Parse an impairment description.
+**
+**  The format is a comma separated list of key=value, for example
+**  "delay=80,jitter=20,dist=normal,loss=5,dup=1,reorder=2,seed=42".
+**  Times are in ms, rates in percent.
+**
+**  @param spec  Description to parse.
+**
+**  @return true if the description is valid.
+*/
+bool CNetworkImpairment::Parse(const std::string &spec)
+{
+	std::istringstream in(spec);
+	std::string item;
+
+	while (std::getline(in, item, ',')) {
+		const size_t sep = item.find('=');
+		if (sep == std::string::npos) {
+			fprintf(stderr, "Bad network impairment '%s'\n", item.c_str());
+			return false;
+		}
+		const std::string key = item.substr(0, sep);
+		const std::string value = item.substr(sep + 1);
+
+		if (key == "dist") {
+			if (value != "uniform" && value != "normal") {
+				fprintf(stderr, "Unknown delay distribution '%s'\n", value.c_str());
+				return false;
+			}
+			this->NormalJitter = value == "normal";
+			continue;
+		}
+		const unsigned int number = atoi(value.c_str());
+		if (key == "delay") {
+			this->Delay = number;
+		} else if (key == "jitter") {
+			this->Jitter = number;
+		} else if (key == "loss") {
+			this->Loss = std::min(number, 100u);
+		} else if (key == "dup") {
+			this->Duplicate = std::min(number, 100u);
+		} else if (key == "reorder") {
+			this->Reorder = std::min(number, 100u);
+		} else if (key == "seed") {
+			this->Seed = number;
+		} else {
+			fprintf(stderr, "Unknown network impairment '%s'\n", key.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+CImpairedPacketQueue::CImpairedPacketQueue(const CNetworkImpairment &impairment) :
+	Impairment(impairment), Random(impairment.Seed), Sequence(0)
+{
+}
+
+/**
+**  Compute the one way delay of a packet.
+*/
+unsigned long CImpairedPacketQueue::ComputeDelay()
+{
+	long delay = this->Impairment.Delay;
+
+	if (this->Impairment.Jitter) {
+		const double jitter = this->Impairment.Jitter;
+		if (this->Impairment.NormalJitter) {
+			std::normal_distribution<double> distribution(0., jitter);
+			delay += long(distribution(this->Random));
+		} else {
+			std::uniform_real_distribution<double> distribution(-jitter, jitter);
+			delay += long(distribution(this->Random));
+		}
+	}
+	return std::max(delay, 0l);
+}
+
+/**
+**  Queue a packet to send through the simulated network.
+**
+**  @param host  Destination.
+**  @param buf   Packet content.
+**  @param len   Packet size.
+**  @param now   Current time in ms.
+*/
+void CImpairedPacketQueue::Push(const CHost &host, const void *buf, unsigned int len, unsigned long now)
+{
+	std::uniform_int_distribution<unsigned int> percent(0, 99);
+
+	if (percent(this->Random) < this->Impairment.Loss) {
+		++this->Statistic.droppedCount;
+		return;
+	}
+	const int copies = percent(this->Random) < this->Impairment.Duplicate ? 2 : 1;
+	if (copies == 2) {
+		++this->Statistic.duplicatedCount;
+	}
+	for (int i = 0; i != copies; ++i) {
+		Packet packet;
+		packet.Due = now + ComputeDelay();
+		if (percent(this->Random) < this->Impairment.Reorder) {
+			// Hold back the packet, so that the following ones overtake it.
+			packet.Due += std::max(this->Impairment.Delay, 1u) + this->Impairment.Jitter;
+			++this->Statistic.reorderedCount;
+		}
+		packet.Sequence = this->Sequence++;
+		packet.Host = host;
+		packet.Data.assign(static_cast<const unsigned char *>(buf), static_cast<const unsigned char *>(buf) + len);
+		this->Packets.push(packet);
+	}
+}
+
+/**
+**  Take the next packet which has to be sent.
+**
+**  @param now   Current time in ms.
+**  @param host  Return destination of the packet.
+**  @param data  Return content of the packet.
+**
+**  @return true if a packet is due.
+*/
+bool CImpairedPacketQueue::Pop(unsigned long now, CHost *host, std::vector<unsigned char> *data)
+{
+	if (this->Packets.empty() || this->Packets.top().Due > now) {
+		return false;
+	}
+	*host = this->Packets.top().Host;
+	*data = this->Packets.top().Data;
+	this->Packets.pop();
+	++this->Statistic.sentCount;
+	return true;
+}
+
+//@}
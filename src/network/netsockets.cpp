@@ -36,8 +36,10 @@
 #include "stratagus.h"
 
 #include "network/netsockets.h"
+#include "network/netimpairment.h"
 #include "net_lowlevel.h"
 
+#include <chrono>
 #include <stdio.h>
 
 //
@@ -66,16 +68,24 @@ bool CHost::isValid() const
 // CUDPSocket_Impl
 //
 
+/**
+**  UDP socket.
+**
+**  When a network impairment is configured, outgoing packets go through
+**  a simulated network and are really sent when they are due,
+**  on the next socket access.
+*/
 class CUDPSocket_Impl
 {
 public:
-	CUDPSocket_Impl() : socket(Socket(-1)) {}
+	CUDPSocket_Impl() : socket(Socket(-1)), impairment(NULL) {}
 	~CUDPSocket_Impl() { if (IsValid()) { Close(); } }
-	bool Open(const CHost &host) { socket = NetOpenUDP(host.getIp(), host.getPort()); return socket != INVALID_SOCKET; }
-	void Close() { NetCloseUDP(socket); socket = Socket(-1); }
-	void Send(const CHost &host, const void *buf, unsigned int len) { NetSendUDP(socket, host.getIp(), host.getPort(), buf, len); }
+	bool Open(const CHost &host);
+	void Close();
+	void Send(const CHost &host, const void *buf, unsigned int len);
 	int Recv(void *buf, int len, CHost *hostFrom)
 	{
+		FlushImpairment();
 		unsigned long ip;
 		int port;
 		int res = NetRecvUDP(socket, buf, len, &ip, &port);
@@ -83,13 +93,84 @@ public:
 		return res;
 	}
 	void SetNonBlocking() { NetSetNonBlocking(socket); }
-	int HasDataToRead(int timeout) { return NetSocketReady(socket, timeout); }
+	int HasDataToRead(int timeout);
 	bool IsValid() const { return socket != Socket(-1); }
 	int GetSocketAddresses(unsigned long *ips, int maxAddr) { return NetSocketAddr(ips, maxAddr); }
+	const CImpairedPacketQueue *GetImpairment() const { return impairment; }
+private:
+	static unsigned long Now();
+	void FlushImpairment();
 private:
 	Socket socket;
+	CImpairedPacketQueue *impairment;  /// Simulated network, NULL if none
 };
 
+bool CUDPSocket_Impl::Open(const CHost &host)
+{
+	socket = NetOpenUDP(host.getIp(), host.getPort());
+	if (socket == INVALID_SOCKET) {
+		return false;
+	}
+	if (CNetworkImpairment::Instance.IsEnabled()) {
+		impairment = new CImpairedPacketQueue(CNetworkImpairment::Instance);
+	}
+	return true;
+}
+
+void CUDPSocket_Impl::Close()
+{
+	NetCloseUDP(socket);
+	socket = Socket(-1);
+	delete impairment;
+	impairment = NULL;
+}
+
+void CUDPSocket_Impl::Send(const CHost &host, const void *buf, unsigned int len)
+{
+	if (impairment == NULL) {
+		NetSendUDP(socket, host.getIp(), host.getPort(), buf, len);
+		return;
+	}
+	impairment->Push(host, buf, len, Now());
+	FlushImpairment();
+}
+
+int CUDPSocket_Impl::HasDataToRead(int timeout)
+{
+	if (impairment == NULL) {
+		return NetSocketReady(socket, timeout);
+	}
+	FlushImpairment();
+	// Don't sleep past the next delayed packet.
+	if (!impairment->IsEmpty() && timeout > 0) {
+		const unsigned long now = Now();
+		const unsigned long due = impairment->NextDue();
+		timeout = std::min<long>(timeout, due > now ? due - now : 0);
+	}
+	return NetSocketReady(socket, timeout);
+}
+
+unsigned long CUDPSocket_Impl::Now()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+**  Really send the delayed packets which are due.
+*/
+void CUDPSocket_Impl::FlushImpairment()
+{
+	if (impairment == NULL) {
+		return;
+	}
+	const unsigned long now = Now();
+	CHost host;
+	std::vector<unsigned char> data;
+	while (impairment->Pop(now, &host, &data)) {
+		NetSendUDP(socket, host.getIp(), host.getPort(), &data[0], data.size());
+	}
+}
+
 //
 // CUDPSocket
 //
@@ -180,6 +261,11 @@ int CUDPSocket::GetSocketAddresses(unsigned long *ips, int maxAddr) {
 	return m_impl->GetSocketAddresses(ips, maxAddr);
 }
 
+const CImpairedPacketQueue *CUDPSocket::GetImpairment() const
+{
+	return m_impl->GetImpairment();
+}
+
 //
 // CTCPSocket_Impl
 //
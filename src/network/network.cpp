@@ -146,6 +146,27 @@
 ** If there are missing packages, the game is paused and old commands
 ** are resend to all clients.
 **
+** When enabled with -H, every syncStateInterval game cycles, each computer
+** also hashes its units, players and map (see CSyncState) and sends the
+** hashes. When they differ, the computers exchange the hashes of the parts
+** of the diverging subsystem, and each one writes the objects of the first
+** diverging part to a desync_*.txt file, to be compared. The hash walks all
+** unit slots and map fields, so it is off by default.
+**
+** To survive isolated packet losses without a resend round trip, each
+** packet also carries the commands of the previous redundantUpdates
+** updates of the sender. The receiver only keeps such a copy when it
+** missed the original.
+**
+** The server measures the round trip time to each client with ping/pong
+** messages which bypass the command queues. From the worst smoothed
+** round trip time it derives the needed lag and, when it differs enough
+** from the current one, sends a MessageLag command. As any other command
+** it is executed by all computers in the same game cycle, so the lag
+** changes deterministically everywhere. Afterwards each computer sends
+** the missing updates (lag increase) or pauses sending until the game
+** catches up (lag decrease), so no update is ever skipped.
+**
 ** @section missing What features are missing
 **
 ** @li The recover from lost packets can be improved, as the player knows
@@ -156,8 +177,7 @@
 **
 ** @li Add a server/client protocol, which allows more players per game.
 **
-** @li Lag (latency) and bandwidth should be automatic detected during game setup
-** and later during game automatic adapted.
+** @li Bandwidth should be automatic detected during game setup.
 **
 ** @li Also it would be nice, if we support viewing clients. This means
 ** other people can view the game in progress.
@@ -234,10 +254,12 @@
 #include "net_lowlevel.h"
 #include "net_message.h"
 #include "netconnect.h"
+#include "network/netimpairment.h"
 #include "parameters.h"
 #include "player.h"
 #include "replay.h"
 #include "sound.h"
+#include "syncstate.h"
 #include "translate.h"
 #include "unit.h"
 #include "unit_manager.h"
@@ -285,6 +307,9 @@ CNetworkParameter::CNetworkParameter()
 	gameCyclesPerUpdate = 1;
 	NetworkLag = 10;
 	timeoutInS = 45;
+	redundantUpdates = 2;
+	adaptiveLag = true;
+	syncStateInterval = 0;
 }
 
 void CNetworkParameter::FixValues()
@@ -299,6 +324,17 @@ CUDPSocket NetworkFildes;                  /// Network file descriptor
 
 static unsigned long NetworkLastFrame[PlayerMax]; /// Last frame received packet
 static unsigned long NetworkLastCycle[PlayerMax]; /// Last cycle received packet
+static unsigned long NetworkNextSendCycle;        /// Next game cycle to send our commands for
+
+static bool NetworkRttValid[PlayerMax];       /// Round trip time of player was measured
+static unsigned long NetworkNextPingCycle;    /// Game cycle of the next ping (server)
+static unsigned int NetworkPendingLag;        /// Requested lag not yet executed, 0 if none
+static int NetworkLagDecreaseVotes;           /// Consecutive evaluations asking for a lower lag
+
+static std::deque<CSyncState> SyncStateHistory;          /// Our recent game state hashes
+static unsigned long NetworkNextSyncStateCycle;          /// Game cycle of the next state hash
+static bool SyncStateDiverged[SyncStateSubsystemCount];  /// Subsystem desync already reported
+static bool SyncStateDumped[SyncStateSubsystemCount];    /// Subsystem desync already located
 
 static unsigned int NetworkSyncSeeds[256];          /// Network sync seeds.
 static unsigned int NetworkSyncHashs[256];          /// Network sync hashs.
@@ -307,23 +343,32 @@ static std::deque<CNetworkCommandQueue> CommandsIn;    /// Network command input
 static std::deque<CNetworkCommandQueue> MsgCommandsIn; /// Network message input queue
 
 
-#ifdef DEBUG
 class CNetworkStat
 {
 public:
 	CNetworkStat() :
-		resentPacketCount(0)
+		resentPacketCount(0), recoveredUpdateCount(0), stallCount(0), stallTicks(0), stallStartTicks(0)
 	{}
 
 	void print() const
 	{
 		DebugPrint("resent: %d packets\n" _C_ resentPacketCount);
+		DebugPrint("recovered from redundancy: %d updates\n" _C_ recoveredUpdateCount);
+		DebugPrint("stalled: %d times (%lu ms)\n" _C_ stallCount _C_ stallTicks);
 	}
 
 public:
-	unsigned int resentPacketCount;
+	unsigned int resentPacketCount;     /// Number of resend requests
+	unsigned int recoveredUpdateCount;  /// Number of lost updates restored from a redundant copy
+	unsigned int stallCount;            /// Number of times the game waited for the network
+	unsigned long stallTicks;           /// Time the game waited for the network in ms
+	unsigned long stallStartTicks;      /// Start of the current wait, 0 if none
 };
 
+static CNetworkStat NetworkStat;
+
+#ifdef DEBUG
+
 static void printStatistic(const CUDPSocket::CStatistic &statistic)
 {
 	DebugPrint("Sent: %d packets %d bytes (max %d bytes).\n"
@@ -334,8 +379,6 @@ static void printStatistic(const CUDPSocket::CStatistic &statistic)
 			   _C_ statistic.biggestReceivedPacketSize);
 	DebugPrint("Received: %d error(s).\n" _C_ statistic.receivedErrorCount);
 }
-
-static CNetworkStat NetworkStat;
 #endif
 
 static int PlayerQuit[PlayerMax];          /// Player quit
@@ -374,6 +417,42 @@ static void NetworkBroadcast(const CNetworkPacket &packet, int numcommands, int
 	delete[] buf;
 }
 
+/**
+**  Append copies of our previous updates to a packet.
+**
+**  @param packet        Packet to complete.
+**  @param numcommands   Number of commands of the packet cycle.
+**  @param gameNetCycle  Game cycle of the packet.
+*/
+static void NetworkAddRedundantCommands(CNetworkPacket &packet, int numcommands, unsigned long gameNetCycle)
+{
+	const unsigned int networkUpdates = CNetworkParameter::Instance.gameCyclesPerUpdate;
+	size_t size = packet.Size(numcommands);
+
+	for (unsigned int k = 1; k <= CNetworkParameter::Instance.redundantUpdates; ++k) {
+		if (gameNetCycle <= k * networkUpdates) {
+			break;
+		}
+		const unsigned long cycle = gameNetCycle - k * networkUpdates;
+		const CNetworkCommandQueue(&ncqs)[MaxNetworkCommands] = NetworkIn[cycle & 0xFF][ThisPlayer->Index];
+		if (ncqs[0].Time != cycle || ncqs[0].Type == MessageNone) {
+			continue;
+		}
+		CNetworkRedundantCommands redundant;
+		redundant.Cycle = cycle & 0xFF;
+		for (int i = 0; i < MaxNetworkCommands && ncqs[i].Type != MessageNone; ++i) {
+			redundant.Type[i] = ncqs[i].Type;
+			redundant.Command[i] = ncqs[i].Data;
+			++redundant.NumCommands;
+		}
+		size += redundant.Size();
+		if (size > MaxNetworkPacketSize) {
+			break;
+		}
+		packet.Redundant.push_back(redundant);
+	}
+}
+
 /**
 **  Network send packet. Build it from queue and broadcast.
 **
@@ -396,6 +475,7 @@ static void NetworkSendPacket(const CNetworkCommandQueue(&ncq)[MaxNetworkCommand
 	for (; i < MaxNetworkCommands; ++i) {
 		packet.Header.Type[i] = MessageNone;
 	}
+	NetworkAddRedundantCommands(packet, numcommands, ncq[0].Time);
 	NetworkBroadcast(packet, numcommands);
 }
 
@@ -518,6 +598,16 @@ void NetworkOnStartGame()
 	memset(PlayerQuit, 0, sizeof(PlayerQuit));
 	memset(NetworkLastFrame, 0, sizeof(NetworkLastFrame));
 	memset(NetworkLastCycle, 0, sizeof(NetworkLastCycle));
+	memset(NetworkRttValid, 0, sizeof(NetworkRttValid));
+	NetworkStat = CNetworkStat();
+	NetworkNextSendCycle = 0;
+	NetworkNextPingCycle = 0;
+	NetworkPendingLag = 0;
+	NetworkLagDecreaseVotes = 0;
+	SyncStateHistory.clear();
+	NetworkNextSyncStateCycle = 0;
+	memset(SyncStateDiverged, 0, sizeof(SyncStateDiverged));
+	memset(SyncStateDumped, 0, sizeof(SyncStateDumped));
 }
 
 //----------------------------------------------------------------------------
@@ -706,13 +796,23 @@ static bool IsNetworkCommandReady(unsigned long gameNetCycle)
 	return true;
 }
 
-static void ParseResendCommand(const CNetworkPacket &packet)
+/**
+**  Destination cycle (time to execute) of a packet cycle.
+**
+**  @param cycle  Low byte of the game cycle.
+*/
+static unsigned long NetworkDestinationCycle(uint8_t cycle)
 {
-	// Destination cycle (time to execute).
-	unsigned long n = ((GameCycle + 128) & ~0xFF) | packet.Header.Cycle;
+	unsigned long n = ((GameCycle + 128) & ~0xFF) | cycle;
 	if (n > GameCycle + 128) {
 		n -= 0x100;
 	}
+	return n;
+}
+
+static void ParseResendCommand(const CNetworkPacket &packet)
+{
+	const unsigned long n = NetworkDestinationCycle(packet.Header.Cycle);
 	const unsigned long gameNetCycle = n;
 	// FIXME: not necessary to send this packet multiple times!!!!
 	// other side sends re-send until it gets an answer.
@@ -744,10 +844,13 @@ static void ParseResendCommand(const CNetworkPacket &packet)
 	}
 }
 
-static bool IsAValidCommand_Command(const CNetworkPacket &packet, int index, const int player)
+static bool IsAValidCommand_Command(const std::vector<unsigned char> &command, const int player)
 {
+	if (command.size() < CNetworkCommand::Size()) {
+		return false;
+	}
 	CNetworkCommand nc;
-	nc.Deserialize(&packet.Command[index][0]);
+	nc.Deserialize(&command[0]);
 	const unsigned int slot = nc.Unit;
 	const CUnit *unit = slot < UnitManager->GetUsedSlotCount() ? &UnitManager->GetSlotUnit(slot) : NULL;
 
@@ -759,22 +862,47 @@ static bool IsAValidCommand_Command(const CNetworkPacket &packet, int index, con
 	}
 }
 
-static bool IsAValidCommand_Dismiss(const CNetworkPacket &packet, int index, const int player)
+static bool IsAValidCommand_Dismiss(const std::vector<unsigned char> &command, const int player)
 {
+	if (command.size() < CNetworkCommand::Size()) {
+		return false;
+	}
 	CNetworkCommand nc;
-	nc.Deserialize(&packet.Command[index][0]);
+	nc.Deserialize(&command[0]);
 	const unsigned int slot = nc.Unit;
 	const CUnit *unit = slot < UnitManager->GetUsedSlotCount() ? &UnitManager->GetSlotUnit(slot) : NULL;
 
 	if (unit && unit->Type->ClicksToExplode) {
 		return true;
 	}
-	return IsAValidCommand_Command(packet, index, player);
+	return IsAValidCommand_Command(command, player);
+}
+
+static bool IsAValidCommand_Lag(const std::vector<unsigned char> &command, const int player)
+{
+	// Only the server decides the lag.
+	if (player != Hosts[0].PlyNr || command.size() < CNetworkCommandLag::Size()) {
+		return false;
+	}
+	CNetworkCommandLag nc;
+	nc.Deserialize(&command[0]);
+	// Destination cycles must stay in the half window of the 8 bit packet cycle.
+	return 2 * CNetworkParameter::Instance.gameCyclesPerUpdate <= nc.lag && nc.lag < 128;
+}
+
+static bool IsAValidCommand_SyncStateParts(const std::vector<unsigned char> &command)
+{
+	const size_t headerSize = CNetworkSyncStateParts().Size();
+	if (command.size() < headerSize) {
+		return false;
+	}
+	const size_t count = (command[headerSize - 2] << 8) | command[headerSize - 1];
+	return command.size() >= headerSize + 4 * count;
 }
 
-static bool IsAValidCommand(const CNetworkPacket &packet, int index, const int player)
+static bool IsAValidCommand(unsigned char type, const std::vector<unsigned char> &command, const int player)
 {
-	switch (packet.Header.Type[index] & 0x7F) {
+	switch (type & 0x7F) {
 		case MessageExtendedCommand: // FIXME: ensure the sender is part of the command
 		case MessageSync: // Sync does not matter
 		case MessageSelection: // FIXME: ensure it's from the right player
@@ -782,12 +910,130 @@ static bool IsAValidCommand(const CNetworkPacket &packet, int index, const int p
 		case MessageResend:    // FIXME: ensure it's from the right player
 		case MessageChat:      // FIXME: ensure it's from the right player
 			return true;
-		case MessageCommandDismiss: return IsAValidCommand_Dismiss(packet, index, player);
-		default: return IsAValidCommand_Command(packet, index, player);
+		case MessageLag: return IsAValidCommand_Lag(command, player);
+		case MessageSyncState: return command.size() >= CNetworkSyncState::Size();
+		case MessageSyncStateParts: return IsAValidCommand_SyncStateParts(command);
+		case MessagePing:
+		case MessagePong:
+			return false; // Never queued
+		case MessageCommandDismiss: return IsAValidCommand_Dismiss(command, player);
+		default: return IsAValidCommand_Command(command, player);
 	}
 	// FIXME: not all values in nc have been validated
 }
 
+/**
+**  Answer a ping of the server. (client)
+**
+**  @param packet  Received ping.
+*/
+static void NetworkParsePing(const CNetworkPacket &packet)
+{
+	if (NetConnectType != 2) {
+		return;
+	}
+	CNetworkPacket pong;
+	pong.Header.Cycle = packet.Header.Cycle;
+	pong.Header.OrigPlayer = ThisPlayer->Index;
+	pong.Header.Type[0] = MessagePong;
+	pong.Command[0] = packet.Command[0];
+	NetworkBroadcast(pong, 1);
+}
+
+/**
+**  Update the round trip time of a client from its answer. (server)
+**
+**  Smoothed like the TCP retransmission timer (RFC 6298).
+**
+**  @param packet  Received pong.
+**  @param player  Player who answered.
+*/
+static void NetworkParsePong(const CNetworkPacket &packet, int player)
+{
+	if (NetConnectType != 1 || packet.Command[0].size() < CNetworkPing::Size()) {
+		return;
+	}
+	CNetworkPing ping;
+	ping.Deserialize(&packet.Command[0][0]);
+	const unsigned long sample = uint32_t(GetTicks() - ping.ticks);
+
+	for (int i = 0; i < NetPlayers; ++i) {
+		CNetworkHost &host = Hosts[i];
+		if (!host.IsValid() || host.PlyNr != player) {
+			continue;
+		}
+		if (!NetworkRttValid[player]) {
+			host.Rtt = sample;
+			host.RttJitter = sample / 2;
+			NetworkRttValid[player] = true;
+		} else {
+			const unsigned long deviation = host.Rtt > sample ? host.Rtt - sample : sample - host.Rtt;
+			host.RttJitter = (3 * host.RttJitter + deviation) / 4;
+			host.Rtt = (7 * host.Rtt + sample) / 8;
+		}
+		break;
+	}
+}
+
+/**
+**  Store the received commands of a player for one game cycle.
+**
+**  @param cycle        Low byte of the destination game cycle.
+**  @param types        Command types.
+**  @param commands     Command contents.
+**  @param numcommands  Number of commands.
+**  @param player       Player who sent the commands.
+*/
+static void NetworkStoreCommands(uint8_t cycle, const uint8_t *types, const std::vector<unsigned char> *commands,
+								 int numcommands, int player)
+{
+	const unsigned long n = NetworkDestinationCycle(cycle);
+
+	for (int i = 0; i != numcommands; ++i) {
+		if (IsAValidCommand(types[i], commands[i], player)) {
+			NetworkIn[cycle][player][i].Time = n;
+			NetworkIn[cycle][player][i].Type = types[i];
+			NetworkIn[cycle][player][i].Data = commands[i];
+		} else {
+			SetMessage(_("%s sent bad command"), Players[player].Name.c_str());
+			DebugPrint("%s sent bad command: 0x%x\n" _C_ Players[player].Name.c_str()
+					   _C_ types[i] & 0x7F);
+		}
+	}
+	for (int i = numcommands; i != MaxNetworkCommands; ++i) {
+		NetworkIn[cycle][player][i].Time = 0;
+	}
+}
+
+/**
+**  Store a redundant copy of commands, if the original was lost.
+**
+**  @param redundant  Redundant commands.
+**  @param player     Player who sent the commands.
+*/
+static void NetworkParseRedundantCommands(const CNetworkRedundantCommands &redundant, int player)
+{
+	const unsigned long n = NetworkDestinationCycle(redundant.Cycle);
+
+	if (n < GameCycle || NetworkIn[redundant.Cycle][player][0].Time == n) {
+		// Already executed or already received.
+		return;
+	}
+	for (int i = 0; i != redundant.NumCommands; ++i) {
+		if (redundant.Type[i] == MessageQuit && redundant.Command[i].size() >= CNetworkCommandQuit::Size()) {
+			CNetworkCommandQuit nc;
+			nc.Deserialize(&redundant.Command[i][0]);
+			const int playerNum = nc.player;
+
+			if (playerNum >= 0 && playerNum < NumPlayers) {
+				PlayerQuit[playerNum] = 1;
+			}
+		}
+	}
+	NetworkStoreCommands(redundant.Cycle, redundant.Type, redundant.Command, redundant.NumCommands, player);
+	++NetworkStat.recoveredUpdateCount;
+}
+
 static void NetworkParseInGameEvent(const unsigned char *buf, int len, const CHost &host)
 {
 	CNetworkPacket packet;
@@ -806,15 +1052,24 @@ static void NetworkParseInGameEvent(const unsigned char *buf, int len, const CHo
 		}
 		player = Hosts[index].PlyNr;
 	}
+	if (commands < 0) {
+		DebugPrint("Bad packet read\n");
+		return;
+	}
+	// Round trip time probes are point to point and never queued.
+	if (commands > 0 && packet.Header.Type[0] == MessagePing) {
+		NetworkParsePing(packet);
+		return;
+	}
+	if (commands > 0 && packet.Header.Type[0] == MessagePong) {
+		NetworkParsePong(packet, player);
+		return;
+	}
 	if (NetConnectType == 1) {
 		if (player != 255) {
 			NetworkBroadcast(packet, commands, player);
 		}
 	}
-	if (commands < 0) {
-		DebugPrint("Bad packet read\n");
-		return;
-	}
 	NetworkLastCycle[player] = packet.Header.Cycle;
 	// Parse the packet commands.
 	for (int i = 0; i != commands; ++i) {
@@ -834,26 +1089,11 @@ static void NetworkParseInGameEvent(const unsigned char *buf, int len, const CHo
 		}
 		// Receive statistic
 		NetworkLastFrame[player] = FrameCounter;
-
-		bool validCommand = IsAValidCommand(packet, i, player);
-		// Place in network in
-		if (validCommand) {
-			// Destination cycle (time to execute).
-			unsigned long n = ((GameCycle + 128) & ~0xFF) | packet.Header.Cycle;
-			if (n > GameCycle + 128) {
-				n -= 0x100;
-			}
-			NetworkIn[packet.Header.Cycle][player][i].Time = n;
-			NetworkIn[packet.Header.Cycle][player][i].Type = packet.Header.Type[i];
-			NetworkIn[packet.Header.Cycle][player][i].Data = packet.Command[i];
-		} else {
-			SetMessage(_("%s sent bad command"), Players[player].Name.c_str());
-			DebugPrint("%s sent bad command: 0x%x\n" _C_ Players[player].Name.c_str()
-					   _C_ packet.Header.Type[i] & 0x7F);
-		}
 	}
-	for (int i = commands; i != MaxNetworkCommands; ++i) {
-		NetworkIn[packet.Header.Cycle][player][i].Time = 0;
+	// Place in network in
+	NetworkStoreCommands(packet.Header.Cycle, packet.Header.Type, packet.Command, commands, player);
+	for (size_t i = 0; i != packet.Redundant.size(); ++i) {
+		NetworkParseRedundantCommands(packet.Redundant[i], player);
 	}
 	// Waiting for this time slot
 	if (!NetworkInSync) {
@@ -876,7 +1116,7 @@ void NetworkEvent()
 		return;
 	}
 	// Read the packet.
-	unsigned char buf[1024];
+	unsigned char buf[MaxNetworkPacketSize];
 	CHost host;
 	int len = NetworkFildes.Recv(&buf, sizeof(buf), &host);
 	if (len < 0) {
@@ -913,7 +1153,11 @@ void NetworkQuitGame()
 	}
 	const int gameCyclesPerUpdate = CNetworkParameter::Instance.gameCyclesPerUpdate;
 	const int NetworkLag = CNetworkParameter::Instance.NetworkLag;
-	const int n = (GameCycle + gameCyclesPerUpdate) / gameCyclesPerUpdate * gameCyclesPerUpdate + NetworkLag;
+	int n = (GameCycle + gameCyclesPerUpdate) / gameCyclesPerUpdate * gameCyclesPerUpdate + NetworkLag;
+	if (NetworkNextSendCycle >= GameCycle + gameCyclesPerUpdate) {
+		// Lag changed recently, the next cycle we send is the reference.
+		n = NetworkNextSendCycle;
+	}
 	CNetworkCommandQueue(&ncqs)[MaxNetworkCommands] = NetworkIn[n & 0xFF][ThisPlayer->Index];
 	CNetworkCommandQuit nc;
 	nc.player = ThisPlayer->Index;
@@ -1008,6 +1252,118 @@ static void NetworkExecCommand_Quit(const CNetworkCommandQueue &ncq)
 	CommandQuit(nc.player);
 }
 
+static void NetworkExecCommand_Lag(const CNetworkCommandQueue &ncq)
+{
+	Assert((ncq.Type & 0x7F) == MessageLag);
+	CNetworkCommandLag nc;
+
+	nc.Deserialize(&ncq.Data[0]);
+	CNetworkParameter::Instance.NetworkLag = nc.lag;
+	if (NetworkPendingLag == nc.lag) {
+		NetworkPendingLag = 0;
+	}
+	DebugPrint("Network lag changed to %d at cycle %lu\n" _C_ nc.lag _C_ GameCycle);
+}
+
+static const CSyncState *FindSyncState(unsigned long cycle)
+{
+	for (size_t i = 0; i != SyncStateHistory.size(); ++i) {
+		if (SyncStateHistory[i].Cycle == cycle) {
+			return &SyncStateHistory[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+**  Send the part hashes of a subsystem, to locate a desync.
+**
+**  @param state      Our hashed state.
+**  @param subsystem  Diverging subsystem.
+*/
+static void NetworkSendSyncStateParts(const CSyncState &state, int subsystem)
+{
+	const std::vector<uint32_t> &parts = state.Parts[subsystem];
+	const size_t maxPartsPerMessage = 64;
+
+	for (size_t offset = 0; offset < parts.size(); offset += maxPartsPerMessage) {
+		CNetworkSyncStateParts nc;
+		nc.player = ThisPlayer->Index;
+		nc.cycle = state.Cycle;
+		nc.subsystem = subsystem;
+		nc.offset = offset;
+		nc.parts.assign(parts.begin() + offset, parts.begin() + std::min(parts.size(), offset + maxPartsPerMessage));
+
+		CNetworkCommandQueue ncq;
+		ncq.Time = GameCycle;
+		ncq.Type = MessageSyncStateParts;
+		ncq.Data.resize(nc.Size());
+		nc.Serialize(&ncq.Data[0]);
+		CommandsIn.push_back(ncq);
+	}
+}
+
+static void NetworkExecCommand_SyncState(const CNetworkCommandQueue &ncq)
+{
+	Assert((ncq.Type & 0x7F) == MessageSyncState);
+	CNetworkSyncState nc;
+
+	nc.Deserialize(&ncq.Data[0]);
+	if (nc.player == ThisPlayer->Index) {
+		return;
+	}
+	const CSyncState *state = FindSyncState(nc.cycle);
+	if (state == NULL) {
+		return;
+	}
+	for (int i = 0; i != SyncStateSubsystemCount; ++i) {
+		if (nc.hash[i] == state->Hash[i] || SyncStateDiverged[i]) {
+			continue;
+		}
+		SyncStateDiverged[i] = true;
+		SetMessage(_("Network out of sync: %s"), CSyncState::GetSubsystemName(i));
+		fprintf(stderr, "Desync of %s with player %d, between cycles %lu and %u\n",
+				CSyncState::GetSubsystemName(i), nc.player,
+				nc.cycle - std::min<unsigned long>(nc.cycle, CNetworkParameter::Instance.syncStateInterval), nc.cycle);
+		NetworkSendSyncStateParts(*state, i);
+	}
+}
+
+static void NetworkExecCommand_SyncStateParts(const CNetworkCommandQueue &ncq)
+{
+	Assert((ncq.Type & 0x7F) == MessageSyncStateParts);
+	CNetworkSyncStateParts nc;
+
+	nc.Deserialize(&ncq.Data[0]);
+	if (nc.player == ThisPlayer->Index || nc.subsystem >= SyncStateSubsystemCount || SyncStateDumped[nc.subsystem]) {
+		return;
+	}
+	const CSyncState *state = FindSyncState(nc.cycle);
+	if (state == NULL) {
+		return;
+	}
+	const int part = state->FindFirstDifferentPart(nc.subsystem, nc.offset, nc.parts);
+	if (part == -1) {
+		return;
+	}
+	SyncStateDumped[nc.subsystem] = true;
+
+	// All computers execute this in the same game cycle, so the dumps can be compared.
+	const std::string filename = "desync_" + std::string(CSyncState::GetSubsystemName(nc.subsystem))
+								 + "_" + std::to_string(ThisPlayer->Index) + "_" + std::to_string(nc.cycle) + ".txt";
+	FILE *file = fopen(filename.c_str(), "w");
+	if (file == NULL) {
+		fprintf(stderr, "Can't write %s\n", filename.c_str());
+		return;
+	}
+	fprintf(file, "%s part %d differs from player %d at cycle %u, dumped at cycle %lu\n",
+			CSyncState::GetSubsystemName(nc.subsystem), part, nc.player, nc.cycle, GameCycle);
+	CSyncState::DumpPart(file, nc.subsystem, part);
+	fclose(file);
+	fprintf(stderr, "Desync of %s located in part %d, see %s\n",
+			CSyncState::GetSubsystemName(nc.subsystem), part, filename.c_str());
+}
+
 static void NetworkExecCommand_ExtendedCommand(const CNetworkCommandQueue &ncq)
 {
 	Assert((ncq.Type & 0x7F) == MessageExtendedCommand);
@@ -1038,6 +1394,9 @@ static void NetworkExecCommand(const CNetworkCommandQueue &ncq)
 		case MessageSelection: NetworkExecCommand_Selection(ncq); break;
 		case MessageChat: NetworkExecCommand_Chat(ncq); break;
 		case MessageQuit: NetworkExecCommand_Quit(ncq); break;
+		case MessageLag: NetworkExecCommand_Lag(ncq); break;
+		case MessageSyncState: NetworkExecCommand_SyncState(ncq); break;
+		case MessageSyncStateParts: NetworkExecCommand_SyncStateParts(ncq); break;
 		case MessageExtendedCommand: NetworkExecCommand_ExtendedCommand(ncq); break;
 		case MessageNone:
 			// Nothing to Do, This Message Should Never be Executed
@@ -1066,10 +1425,17 @@ static void NetworkSendCommands(unsigned long gameNetCycle)
 		ncq[0].Time = gameNetCycle;
 		numcommands = 1;
 	} else {
+		// Leave the commands which do not fit in the packet for the next update.
+		size_t size = CNetworkPacketHeader::Size();
 		while (!CommandsIn.empty() && numcommands < MaxNetworkCommands) {
 			const CNetworkCommandQueue &incommand = CommandsIn.front();
+			size += CNetworkPacket::CommandSize(incommand.Data);
+			if (numcommands != 0 && size > MaxNetworkPacketSize) {
+				break;
+			}
 #ifdef DEBUG
-			if (incommand.Type != MessageExtendedCommand) {
+			const int type = incommand.Type & 0x7F;
+			if (type >= MessageCommandStop && type != MessageExtendedCommand) {
 				CNetworkCommand nc;
 				nc.Deserialize(&incommand.Data[0]);
 
@@ -1087,6 +1453,10 @@ static void NetworkSendCommands(unsigned long gameNetCycle)
 		}
 		while (!MsgCommandsIn.empty() && numcommands < MaxNetworkCommands) {
 			const CNetworkCommandQueue &incommand = MsgCommandsIn.front();
+			size += CNetworkPacket::CommandSize(incommand.Data);
+			if (numcommands != 0 && size > MaxNetworkPacketSize) {
+				break;
+			}
 			ncq[numcommands] = incommand;
 			ncq[numcommands].Time = gameNetCycle;
 			++numcommands;
@@ -1123,19 +1493,154 @@ static void NetworkExecCommands(unsigned long gameNetCycle)
 	}
 }
 
+/**
+**  Send a ping to all clients. (server)
+*/
+static void NetworkSendPings()
+{
+	CNetworkPing ping;
+	ping.ticks = GetTicks();
+
+	CNetworkPacket packet;
+	packet.Header.Cycle = GameCycle & 0xFF;
+	packet.Header.OrigPlayer = ThisPlayer->Index;
+	packet.Header.Type[0] = MessagePing;
+	packet.Command[0].resize(ping.Size());
+	ping.Serialize(&packet.Command[0][0]);
+	NetworkBroadcast(packet, 1);
+}
+
+/**
+**  Request a lag change, executed by all computers in the same game cycle.
+**
+**  @param lag  New lag in game cycles.
+*/
+static void NetworkSendLag(unsigned int lag)
+{
+	CNetworkCommandLag nc;
+	nc.lag = lag;
+
+	CNetworkCommandQueue ncq;
+	ncq.Time = GameCycle;
+	ncq.Type = MessageLag;
+	ncq.Data.resize(nc.Size());
+	nc.Serialize(&ncq.Data[0]);
+	CommandsIn.push_back(ncq);
+	NetworkPendingLag = lag;
+}
+
+/**
+**  Adapt the lag to the measured round trip times. (server)
+**
+**  The lag is raised as soon as it is too small, but only lowered
+**  after several consecutive evaluations, to avoid oscillations.
+*/
+static void NetworkAdaptLag()
+{
+	const unsigned int networkUpdates = CNetworkParameter::Instance.gameCyclesPerUpdate;
+	bool measured = false;
+	unsigned long worstRtt = 0;
+
+	for (int i = 0; i < NetPlayers; ++i) {
+		CNetworkHost &host = Hosts[i];
+		if (!host.IsValid() || host.PlyNr == ThisPlayer->Index || !NetworkRttValid[host.PlyNr]) {
+			continue;
+		}
+		measured = true;
+		worstRtt = std::max(worstRtt, host.Rtt + 4 * host.RttJitter);
+	}
+	if (!measured) {
+		return;
+	}
+	// Commands go client -> server -> client, about one round trip, plus an update of margin.
+	unsigned int lag = worstRtt * CyclesPerSecond / 1000 + networkUpdates;
+	lag = (lag + networkUpdates - 1) / networkUpdates * networkUpdates;
+	// Destination cycles must stay in the half window of the 8 bit packet cycle.
+	const unsigned int maxLag = std::max(100u / networkUpdates, 2u) * networkUpdates;
+	lag = std::min(std::max(lag, 2u * networkUpdates), maxLag);
+
+	const unsigned int currentLag = NetworkPendingLag ? NetworkPendingLag : CNetworkParameter::Instance.NetworkLag;
+	if (lag > currentLag) {
+		NetworkLagDecreaseVotes = 0;
+		NetworkSendLag(lag);
+	} else if (lag + 2 * networkUpdates <= currentLag) {
+		if (++NetworkLagDecreaseVotes >= 5) {
+			NetworkLagDecreaseVotes = 0;
+			NetworkSendLag(lag);
+		}
+	} else {
+		NetworkLagDecreaseVotes = 0;
+	}
+}
+
+/**
+**  Hash our game state and send it to the other computers.
+**
+**  @param gameNetCycle  Current game cycle.
+*/
+static void NetworkSendSyncState(unsigned long gameNetCycle)
+{
+	SyncStateHistory.push_back(CSyncState());
+	CSyncState &state = SyncStateHistory.back();
+	state.Compute(gameNetCycle);
+	// Keep the states until the hashes of the other computers arrived.
+	while (SyncStateHistory.size() > 16) {
+		SyncStateHistory.pop_front();
+	}
+
+	CNetworkSyncState nc;
+	nc.player = ThisPlayer->Index;
+	nc.cycle = gameNetCycle;
+	for (int i = 0; i != SyncStateSubsystemCount; ++i) {
+		nc.hash[i] = state.Hash[i];
+	}
+	CNetworkCommandQueue ncq;
+	ncq.Time = gameNetCycle;
+	ncq.Type = MessageSyncState;
+	ncq.Data.resize(nc.Size());
+	nc.Serialize(&ncq.Data[0]);
+	CommandsIn.push_back(ncq);
+}
+
 /**
 **  Handle network commands.
 */
 void NetworkCommands()
 {
-	if ((GameCycle % CNetworkParameter::Instance.gameCyclesPerUpdate) != 0) {
+	const unsigned int networkUpdates = CNetworkParameter::Instance.gameCyclesPerUpdate;
+	if ((GameCycle % networkUpdates) != 0) {
 		return;
 	}
 	const unsigned long gameNetCycle = GameCycle;
+	if (NetworkStat.stallStartTicks) {
+		// We are called again, so the wait is over.
+		NetworkStat.stallTicks += GetTicks() - NetworkStat.stallStartTicks;
+		NetworkStat.stallStartTicks = 0;
+	}
+	if (NetworkNextSendCycle < gameNetCycle + networkUpdates) {
+		// First update of the game.
+		NetworkNextSendCycle = gameNetCycle + CNetworkParameter::Instance.NetworkLag;
+	}
 	// Send messages to all clients (other players)
-	NetworkSendCommands(gameNetCycle + CNetworkParameter::Instance.NetworkLag);
+	// After a lag change, several updates (increase) or none (decrease) are sent.
+	while (NetworkNextSendCycle <= gameNetCycle + CNetworkParameter::Instance.NetworkLag) {
+		NetworkSendCommands(NetworkNextSendCycle);
+		NetworkNextSendCycle += networkUpdates;
+	}
+	const unsigned int syncStateInterval = CNetworkParameter::Instance.syncStateInterval;
+	if (syncStateInterval && IsNetworkGame() && gameNetCycle >= NetworkNextSyncStateCycle) {
+		NetworkSendSyncState(gameNetCycle);
+		NetworkNextSyncStateCycle = (gameNetCycle / syncStateInterval + 1) * syncStateInterval;
+	}
 	NetworkExecCommands(gameNetCycle);
-	NetworkInSync = IsNetworkCommandReady(gameNetCycle + CNetworkParameter::Instance.gameCyclesPerUpdate);
+	NetworkInSync = IsNetworkCommandReady(gameNetCycle + networkUpdates);
+
+	if (NetConnectType == 1 && IsNetworkGame() && CNetworkParameter::Instance.adaptiveLag
+		&& gameNetCycle >= NetworkNextPingCycle) {
+		NetworkAdaptLag();
+		NetworkSendPings();
+		NetworkNextPingCycle = gameNetCycle + CYCLES_PER_SECOND;
+	}
 }
 
 static void CheckPlayerThatTimeOut(int hostIndex)
@@ -1185,9 +1690,7 @@ static void CheckPlayerThatTimeOut(int hostIndex)
 */
 static void NetworkResendCommands()
 {
-#ifdef DEBUG
 	++NetworkStat.resentPacketCount;
-#endif
 
 	const int networkUpdates = CNetworkParameter::Instance.gameCyclesPerUpdate;
 	const int nextGameCycle = ((GameCycle / networkUpdates) + 1) * networkUpdates;
@@ -1209,6 +1712,10 @@ void NetworkRecover()
 		NetworkInSync = true;
 		return;
 	}
+	if (!NetworkStat.stallStartTicks) {
+		++NetworkStat.stallCount;
+		NetworkStat.stallStartTicks = GetTicks();
+	}
 	if (FrameCounter % CNetworkParameter::Instance.gameCyclesPerUpdate != 0) {
 		return;
 	}
@@ -1223,4 +1730,27 @@ void NetworkRecover()
 	NetworkInSync = IsNetworkCommandReady(nextGameNetCycle);
 }
 
+/**
+**  Print the network statistics of the game, to catch regressions
+**  of the network performance in automated runs.
+**
+**  @param ticks  Duration of the game in ms.
+*/
+void NetworkPrintStatistics(unsigned long ticks)
+{
+	if (!IsNetworkGame()) {
+		return;
+	}
+	fprintf(stderr, "NETWORK RESULT: %f cps (%lu cycles in %lums), %u stalls (%lums), %u resends, %u recovered updates, lag %u\n",
+			GameCycle * 1000.0 / std::max(ticks, 1ul), GameCycle, ticks,
+			NetworkStat.stallCount, NetworkStat.stallTicks, NetworkStat.resentPacketCount,
+			NetworkStat.recoveredUpdateCount, CNetworkParameter::Instance.NetworkLag);
+	const CImpairedPacketQueue *impairment = NetworkFildes.GetImpairment();
+	if (impairment) {
+		const CImpairedPacketQueue::CStatistic &statistic = impairment->getStatistic();
+		fprintf(stderr, "NETWORK IMPAIRMENT: %u sent, %u dropped, %u duplicated, %u reordered\n",
+				statistic.sentCount, statistic.droppedCount, statistic.duplicatedCount, statistic.reorderedCount);
+	}
+}
+
 //@}
@@ -61,32 +61,116 @@ extern int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, in
 --  Variables
 ----------------------------------------------------------------------------*/
 
+/// Workspaces not used by a traversal, kept to avoid reallocating them.
+static std::vector<TerrainTraversal::Workspace *> TerrainTraversalPool;
+
+TerrainTraversal::TerrainTraversal() :
+	m_queueHead(0), m_extented_width(0), m_height(0)
+{
+	if (TerrainTraversalPool.empty()) {
+		m_workspace = new Workspace;
+	} else {
+		m_workspace = TerrainTraversalPool.back();
+		TerrainTraversalPool.pop_back();
+	}
+}
+
+TerrainTraversal::~TerrainTraversal()
+{
+	TerrainTraversalPool.push_back(m_workspace);
+}
+
+/**
+**  Free the workspaces which are not in use.
+*/
+void TerrainTraversal::FreeWorkspaces()
+{
+	for (size_t i = 0; i != TerrainTraversalPool.size(); ++i) {
+		delete TerrainTraversalPool[i];
+	}
+	TerrainTraversalPool.clear();
+}
+
 void TerrainTraversal::SetSize(unsigned int width, unsigned int height)
 {
-	m_values.resize((width + 2) * (height + 2));
+	const size_t size = (width + 2) * (height + 2);
+
+	// Stamps are never newer than the current generation,
+	// so the old content doesn't have to be cleared.
+	if (m_workspace->values.size() != size) {
+		m_workspace->values.resize(size);
+		m_workspace->stamps.resize(size, 0);
+	}
 	m_extented_width = width + 2;
 	m_height = height;
+	m_windowMin = Vec2i(0, 0);
+	m_windowMax = Vec2i(width - 1, height - 1);
 }
 
+/**
+**  Start a new traversal.
+**
+**  Invalidate all the values written by the previous traversals
+**  and reset the window to the whole map.
+*/
 void TerrainTraversal::Init()
 {
-	const unsigned int height = m_height;
-	const unsigned int width = m_extented_width - 2;
-	const unsigned int width_ext = m_extented_width;
-
-	memset(&m_values[0], '\xFF', width_ext * sizeof(dataType));
-	for (unsigned i = 1; i < 1 + height; ++i) {
-		m_values[i * width_ext] = -1;
-		memset(&m_values[i * width_ext + 1], '\0', width * sizeof(dataType));
-		m_values[i * width_ext + width + 1] = -1;
+	Workspace &workspace = *m_workspace;
+
+	if (++workspace.generation == 0) {
+		std::fill(workspace.stamps.begin(), workspace.stamps.end(), 0);
+		workspace.generation = 1;
 	}
-	memset(&m_values[(height + 1) * width_ext], '\xFF', width_ext * sizeof(dataType));
+	workspace.queue.clear();
+	m_queueHead = 0;
+	m_windowMin = Vec2i(0, 0);
+	m_windowMax = Vec2i(m_extented_width - 3, m_height - 1);
+}
+
+/**
+**  Restrict the traversal to a rectangle of the map.
+**
+**  Tiles outside the window are handled as the map border.
+**  Call it after Init() and before pushing any position.
+**
+**  @param minPos  Top left tile of the window.
+**  @param maxPos  Bottom right tile of the window.
+*/
+void TerrainTraversal::SetWindow(const Vec2i &minPos, const Vec2i &maxPos)
+{
+	m_windowMin.x = std::max<short int>(0, minPos.x);
+	m_windowMin.y = std::max<short int>(0, minPos.y);
+	m_windowMax.x = std::min<short int>(m_extented_width - 3, maxPos.x);
+	m_windowMax.y = std::min<short int>(m_height - 1, maxPos.y);
+}
+
+/**
+**  Restrict the traversal to the tiles at most range steps from pos.
+*/
+void TerrainTraversal::SetWindowAround(const Vec2i &pos, int range)
+{
+	const Vec2i offset(std::max(range, 0), std::max(range, 0));
+
+	SetWindow(pos - offset, pos + offset);
+}
+
+/**
+**  Restrict the traversal to the tiles which can be reached in range
+**  steps from the start positions pushed by PushUnitPosAndNeighboor.
+*/
+void TerrainTraversal::SetWindowAround(const CUnit &unit, int range)
+{
+	const CUnit *startUnit = GetFirstContainer(unit);
+	const Vec2i offset(std::max(range, 0) + 1, std::max(range, 0) + 1);
+	const Vec2i extraTileSize(startUnit->Type->TileWidth - 1, startUnit->Type->TileHeight - 1);
+
+	SetWindow(startUnit->tilePos - offset, startUnit->tilePos + extraTileSize + offset);
 }
 
 void TerrainTraversal::PushPos(const Vec2i &pos)
 {
 	if (IsVisited(pos) == false) {
-		m_queue.push(PosNode(pos, pos));
+		m_workspace->queue.push_back(PosNode(pos, pos));
 		Set(pos, 1);
 	}
 }
@@ -96,13 +180,14 @@ void TerrainTraversal::PushNeighboor(const Vec2i &pos)
 	const Vec2i offsets[] = {Vec2i(0, -1), Vec2i(-1, 0), Vec2i(1, 0), Vec2i(0, 1),
 							 Vec2i(-1, -1), Vec2i(1, -1), Vec2i(-1, 1), Vec2i(1, 1)
 							};
+	const dataType value = Get(pos) + 1;
 
 	for (int i = 0; i != 8; ++i) {
 		const Vec2i newPos = pos + offsets[i];
 
 		if (IsVisited(newPos) == false) {
-			m_queue.push(PosNode(newPos, pos));
-			Set(newPos, Get(pos) + 1);
+			m_workspace->queue.push_back(PosNode(newPos, pos));
+			Set(newPos, value);
 		}
 	}
 }
@@ -139,12 +224,24 @@ bool TerrainTraversal::IsInvalid(const Vec2i &pos) const
 
 TerrainTraversal::dataType TerrainTraversal::Get(const Vec2i &pos) const
 {
-	return m_values[m_extented_width + 1 + pos.y * m_extented_width + pos.x];
+	const unsigned int index = Index(pos);
+
+	if (m_workspace->stamps[index] == m_workspace->generation) {
+		return m_workspace->values[index];
+	}
+	if (pos.x < m_windowMin.x || m_windowMax.x < pos.x
+		|| pos.y < m_windowMin.y || m_windowMax.y < pos.y) {
+		return -1;
+	}
+	return 0;
 }
 
 void TerrainTraversal::Set(const Vec2i &pos, TerrainTraversal::dataType value)
 {
-	m_values[m_extented_width + 1 + pos.y * m_extented_width + pos.x] = value;
+	const unsigned int index = Index(pos);
+
+	m_workspace->values[index] = value;
+	m_workspace->stamps[index] = m_workspace->generation;
 }
 
 /*----------------------------------------------------------------------------
@@ -165,6 +262,7 @@ void InitPathfinder()
 void FreePathfinder()
 {
 	FreeAStar();
+	TerrainTraversal::FreeWorkspaces();
 }
 
 /*----------------------------------------------------------------------------
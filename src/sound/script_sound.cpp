@@ -37,6 +37,7 @@
 
 #include "sound.h"
 
+#include "interface.h"
 #include "player.h"
 #include "script.h"
 #include "sound_server.h"
@@ -135,6 +136,10 @@ static int CclMakeSound(lua_State *l)
 		LuaError(l, "string or table expected");
 		return 0;
 	}
+	if (GameRunning) {
+		// A sound made by a running script is about to be played
+		PrefetchSound(id);
+	}
 	LuaUserData *data = (LuaUserData *)lua_newuserdata(l, sizeof(LuaUserData));
 	data->Type = LuaSoundType;
 	data->Data = id;
@@ -166,6 +171,9 @@ static int CclMakeSoundGroup(lua_State *l)
 	lua_pop(l, 1);
 	second = CclGetSound(l);
 	id = MakeSoundGroup(c_name, first, second);
+	if (GameRunning) {
+		PrefetchSound(id);
+	}
 	data = (LuaUserData *)lua_newuserdata(l, sizeof(LuaUserData));
 	data->Type = LuaSoundType;
 	data->Data = id;
@@ -389,12 +389,8 @@ void PlayGameSound(CSound *sound, unsigned char volume, bool always)
 	if (!sample || (!always && SampleIsPlaying(sample))) {
 		return;
 	}
-
-	int channel = PlaySample(sample);
-	if (channel == -1) {
-		return;
-	}
-	SetChannelVolume(channel, CalculateVolume(true, volume, sound->Range));
+	// Interface and notification sounds are not repeated, so play them once decoded
+	PlaySampleWhenDecoded(sample, CalculateVolume(true, volume, sound->Range));
 }
 
 static std::map<int, LuaActionListener *> ChannelMap;
@@ -432,6 +428,8 @@ int PlayFile(const std::string &name, LuaActionListener *listener)
 	Mix_Chunk *sample = LoadSample(name);
 
 	if (sample) {
+		// The caller waits for the channel, so don't leave it to the decode worker
+		DecodeSample(sample);
 		channel = PlaySample(sample, PlaySoundFileCallback);
 		if (channel != -1) {
 			SampleMap[channel] = sample;
@@ -458,9 +456,9 @@ void SetSoundRange(CSound *sound, unsigned char range)
 }
 
 /**
-**  Ask the sound server to register a sound (and currently to load it)
-**  and to return an unique identifier for it. The unique identifier is
-**  memory pointer of the server.
+**  Ask the sound server to register a sound and to return an unique
+**  identifier for it. The unique identifier is memory pointer of the server.
+**  The samples are only decoded when they are prefetched or played.
 **
 **  @param files   An array of wav files.
 **  @param number  Number of files belonging together.
@@ -520,6 +518,29 @@ CSound *RegisterTwoGroups(CSound *first, CSound *second)
 	return id;
 }
 
+/**
+**  Ask the sound server to decode the samples of a sound in the background,
+**  so that they can be played without delay.
+**
+**  @param sound  the sound to prefetch, may be NO_SOUND.
+*/
+void PrefetchSound(const CSound *sound)
+{
+	if (sound == NO_SOUND) {
+		return;
+	}
+	if (sound->Number == ONE_SOUND) {
+		PrefetchSample(sound->Sound.OneSound);
+	} else if (sound->Number == TWO_GROUPS) {
+		PrefetchSound(sound->Sound.TwoGroups.First);
+		PrefetchSound(sound->Sound.TwoGroups.Second);
+	} else {
+		for (int i = 0; i < sound->Number; ++i) {
+			PrefetchSample(sound->Sound.OneGroup[i]);
+		}
+	}
+}
+
 /**
 **  Lookup the sound id's for the game sounds.
 */
@@ -585,6 +606,25 @@ void InitSoundClient()
 		GameSounds.ChatMessage.MapSound();
 	}
 
+	// The interface answers the player at once, so have its sounds ready
+	PrefetchSound(GameSounds.Click.Sound);
+	PrefetchSound(GameSounds.Docking.Sound);
+	PrefetchSound(GameSounds.ChatMessage.Sound);
+	for (unsigned int i = 0; i < PlayerRaces.Count; ++i) {
+		PrefetchSound(GameSounds.PlacementError[i].Sound);
+		PrefetchSound(GameSounds.PlacementSuccess[i].Sound);
+		PrefetchSound(GameSounds.BuildingConstruction[i].Sound);
+		PrefetchSound(GameSounds.WorkComplete[i].Sound);
+		PrefetchSound(GameSounds.ResearchComplete[i].Sound);
+		PrefetchSound(GameSounds.NotEnoughFood[i].Sound);
+		PrefetchSound(GameSounds.Rescue[i].Sound);
+		for (unsigned int j = 0; j < MaxCosts; ++j) {
+			PrefetchSound(GameSounds.NotEnoughRes[i][j].Sound);
+		}
+	}
+	// Named sounds played by the interface
+	PrefetchSound(SoundForName("burning"));
+
 	int MapWidth = (UI.MapArea.EndX - UI.MapArea.X + PixelTileSize.x) / PixelTileSize.x;
 	int MapHeight = (UI.MapArea.EndY - UI.MapArea.Y + PixelTileSize.y) / PixelTileSize.y;
 	DistanceSilent = 3 * std::max<int>(MapWidth, MapHeight);
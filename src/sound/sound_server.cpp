@@ -35,6 +35,9 @@
 --  Includes
 ----------------------------------------------------------------------------*/
 
+#include <deque>
+#include <list>
+#include <map>
 #include <numeric>
 
 #include "stratagus.h"
@@ -397,16 +400,315 @@ static Mix_Chunk *ForceLoadSample(const char *name)
 	return Mix_LoadWAV_RW(f->as_SDL_RWops(), 1);
 }
 
-static Mix_Chunk *LoadSample(const char *name)
+/*----------------------------------------------------------------------------
+--  Sample cache
+----------------------------------------------------------------------------*/
+
+/**
+**  The samples handed out by LoadSample are Mix_Chunk handles which stay
+**  valid until FreeSample. Their audio data is decoded by a background
+**  thread and installed into the handle by the main thread; abuf is NULL
+**  while the data is not decoded.
+**
+**  The decoded data is kept in a LRU list and dropped from the least
+**  recently played samples which are not playing, when the decoded data
+**  grows over SampleCacheSize.
+**
+**  The worker posts a SDL_SOUND_FINISHED event when it has decoded
+**  samples, so that they are installed even when nothing is played.
+**  Samples which must be played as soon as they are decoded wait in
+**  PendingPlays, and are dropped if they are not ready in time.
+*/
+
+/// State of a sample handle, only used by the main thread
+struct CachedSample {
+	std::string File;        /// full file name of the sample
+	unsigned int Id = 0;     /// identifies the decode requests of this sample
+	int Refs = 0;            /// number of LoadSample calls for this file
+	bool Queued = false;     /// waiting for the decode worker
+	bool Failed = false;     /// the file can't be decoded
+	size_t Size = 0;         /// bytes of decoded data
+	std::list<Mix_Chunk *>::iterator Lru;  /// place in DecodedSamples, if decoded
+};
+
+/// A sample for the decode worker
+struct DecodeRequest {
+	Mix_Chunk *Sample;       /// handle to decode for
+	unsigned int Id;         /// CachedSample::Id of the handle
+	std::string File;        /// full file name of the sample
+	Mix_Chunk *Decoded;      /// decoded data, NULL if the file can't be decoded
+	std::string Error;       /// why the file can't be decoded
+};
+
+/// A sample to play once it is decoded
+struct PendingPlay {
+	Mix_Chunk *Sample;       /// sample to play
+	int Volume;              /// channel volume 0-255
+	Uint32 Ticks;            /// time of the request
+};
+
+static const size_t SampleCacheSize = 64 * 1024 * 1024; /// bytes of decoded samples to keep
+static const Uint32 PendingPlayTimeout = 500;           /// ms after which a pending sample is too late
+
+static std::map<Mix_Chunk *, CachedSample> Samples;     /// all sample handles
+static std::map<std::string, Mix_Chunk *> SampleFiles; /// sample handle for each file
+static std::list<Mix_Chunk *> DecodedSamples;          /// decoded samples, least recently played first
+static size_t DecodedBytes;                            /// bytes of decoded samples
+static unsigned int LastSampleId;                      /// last CachedSample::Id given
+
+static SDL_Thread *DecodeThread;                 /// the decode worker
+static SDL_mutex *DecodeMutex;                   /// guards the queues below
+static SDL_cond *DecodeCond;                     /// signals new requests to the worker
+static bool DecodeQuit;                          /// tells the worker to stop
+static std::deque<DecodeRequest> DecodeQueue;    /// samples to decode, most urgent first
+static std::vector<DecodeRequest> DecodedQueue;  /// samples decoded by the worker
+static bool DecodedEventQueued;                  /// an event will collect DecodedQueue
+
+static std::vector<PendingPlay> PendingPlays;    /// samples to play once decoded
+
+static void CollectDecodedSamples();
+
+/**
+**  Called from the event loop when the worker has decoded samples
+*/
+static void SamplesDecoded(int)
 {
-#ifdef DYNAMIC_LOAD
-	Mix_Chunk *r = (Mix_Chunk *)calloc(sizeof(Mix_Chunk), 1);
-	r->allocated = 0xcafebeef;
-	r->abuf = (Uint8 *)(strdup(name));
-	return r;
-#else
-	return ForceLoadSample(name);
-#endif
+	CollectDecodedSamples();
+}
+
+/**
+**  Decode the requested samples, until QuitDecodeWorker.
+*/
+static int DecodeWorker(void *)
+{
+	SDL_LockMutex(DecodeMutex);
+	while (!DecodeQuit) {
+		if (DecodeQueue.empty()) {
+			SDL_CondWait(DecodeCond, DecodeMutex);
+			continue;
+		}
+		DecodeRequest request = DecodeQueue.front();
+		DecodeQueue.pop_front();
+		SDL_UnlockMutex(DecodeMutex);
+
+		request.Decoded = ForceLoadSample(request.File.c_str());
+		if (request.Decoded == NULL) {
+			request.Error = Mix_GetError();
+		}
+
+		SDL_LockMutex(DecodeMutex);
+		DecodedQueue.push_back(request);
+		if (!DecodedEventQueued) {
+			SDL_Event event;
+			SDL_zero(event);
+			event.type = SDL_SOUND_FINISHED;
+			event.user.data1 = (void *) SamplesDecoded;
+			DecodedEventQueued = SDL_PeepEvents(&event, 1, SDL_ADDEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) > 0;
+		}
+	}
+	SDL_UnlockMutex(DecodeMutex);
+	return 0;
+}
+
+/**
+**  Start the decode worker
+*/
+static void InitDecodeWorker()
+{
+	DecodeQuit = false;
+	DecodeMutex = SDL_CreateMutex();
+	DecodeCond = SDL_CreateCond();
+	DecodeThread = SDL_CreateThread(DecodeWorker, "SampleDecoder", NULL);
+	if (DecodeThread == NULL) {
+		fprintf(stderr, "Can't start the sound decoder: %s\n", SDL_GetError());
+	}
+}
+
+/**
+**  Stop the decode worker and drop the samples it has not handed over
+*/
+static void QuitDecodeWorker()
+{
+	if (DecodeThread) {
+		SDL_LockMutex(DecodeMutex);
+		DecodeQuit = true;
+		SDL_CondSignal(DecodeCond);
+		SDL_UnlockMutex(DecodeMutex);
+		SDL_WaitThread(DecodeThread, NULL);
+		DecodeThread = NULL;
+	}
+	for (DecodeRequest &request : DecodedQueue) {
+		if (request.Decoded) {
+			Mix_FreeChunk(request.Decoded);
+		}
+	}
+	DecodedQueue.clear();
+	DecodeQueue.clear();
+	DecodedEventQueued = false;
+	PendingPlays.clear();
+	for (auto &sample : Samples) {
+		sample.second.Queued = false;
+	}
+	SDL_DestroyCond(DecodeCond);
+	DecodeCond = NULL;
+	SDL_DestroyMutex(DecodeMutex);
+	DecodeMutex = NULL;
+}
+
+/**
+**  Ask the decode worker to decode a sample
+**
+**  @param sample  Sample handle
+**  @param urgent  The sample is wanted now, decode it before the others
+*/
+static void QueueDecode(Mix_Chunk *sample, bool urgent)
+{
+	CachedSample &cached = Samples[sample];
+	if (sample->abuf || cached.Failed || DecodeThread == NULL) {
+		return;
+	}
+	SDL_LockMutex(DecodeMutex);
+	if (cached.Queued) {
+		if (urgent) {
+			// Move it to the front, unless the worker has already taken it
+			auto it = std::find_if(DecodeQueue.begin(), DecodeQueue.end(),
+								   [&](const DecodeRequest &request) { return request.Sample == sample; });
+			if (it != DecodeQueue.end() && it != DecodeQueue.begin()) {
+				DecodeRequest request = *it;
+				DecodeQueue.erase(it);
+				DecodeQueue.push_front(request);
+			}
+		}
+	} else {
+		DecodeRequest request = {sample, cached.Id, cached.File, NULL, ""};
+		if (urgent) {
+			DecodeQueue.push_front(request);
+		} else {
+			DecodeQueue.push_back(request);
+		}
+		cached.Queued = true;
+		SDL_CondSignal(DecodeCond);
+	}
+	SDL_UnlockMutex(DecodeMutex);
+}
+
+/**
+**  Drop the decoded data of a sample
+*/
+static void EvictSample(Mix_Chunk *sample, CachedSample &cached)
+{
+	DecodedSamples.erase(cached.Lru);
+	DecodedBytes -= cached.Size;
+	cached.Size = 0;
+	if (sample->allocated) {
+		SDL_free(sample->abuf);
+	}
+	sample->abuf = NULL;
+	sample->alen = 0;
+	sample->allocated = 0;
+}
+
+/**
+**  Drop the decoded data of the least recently played samples,
+**  until the cache fits in SampleCacheSize.
+**
+**  @param keep  Sample which is about to be played, it is never dropped.
+*/
+static void ShrinkSampleCache(const Mix_Chunk *keep)
+{
+	for (auto it = DecodedSamples.begin(); DecodedBytes > SampleCacheSize && it != DecodedSamples.end();) {
+		Mix_Chunk *sample = *it++;
+
+		if (sample != keep && !SampleIsPlaying(sample)) {
+			EvictSample(sample, Samples[sample]);
+		}
+	}
+}
+
+/**
+**  Move decoded data into a sample handle
+*/
+static void InstallSample(Mix_Chunk *sample, CachedSample &cached, Mix_Chunk *decoded)
+{
+	sample->abuf = decoded->abuf;
+	sample->alen = decoded->alen;
+	sample->allocated = decoded->allocated;
+	// Only free the struct, the handle owns the data now
+	decoded->allocated = 0;
+	Mix_FreeChunk(decoded);
+
+	cached.Size = sample->alen;
+	cached.Lru = DecodedSamples.insert(DecodedSamples.end(), sample);
+	DecodedBytes += cached.Size;
+}
+
+/**
+**  Play the pending samples which are decoded now, drop the late ones
+*/
+static void StartPendingPlays()
+{
+	if (PendingPlays.empty()) {
+		return;
+	}
+	std::vector<PendingPlay> pending;
+	pending.swap(PendingPlays);
+	const Uint32 ticks = SDL_GetTicks();
+
+	for (const PendingPlay &play : pending) {
+		if (ticks - play.Ticks > PendingPlayTimeout || Samples[play.Sample].Failed) {
+			continue;
+		}
+		if (play.Sample->abuf == NULL) {
+			PendingPlays.push_back(play);
+			continue;
+		}
+		const int channel = PlaySample(play.Sample);
+		if (channel != -1) {
+			SetChannelVolume(channel, play.Volume);
+		}
+	}
+}
+
+/**
+**  Install the samples decoded by the worker into their handles
+*/
+static void CollectDecodedSamples()
+{
+	if (DecodeMutex == NULL) {
+		return;
+	}
+	std::vector<DecodeRequest> decoded;
+	SDL_LockMutex(DecodeMutex);
+	decoded.swap(DecodedQueue);
+	DecodedEventQueued = false;
+	SDL_UnlockMutex(DecodeMutex);
+	if (decoded.empty()) {
+		return;
+	}
+
+	for (DecodeRequest &request : decoded) {
+		auto it = Samples.find(request.Sample);
+		if (it == Samples.end() || it->second.Id != request.Id) {
+			// The sample has been freed meanwhile
+			if (request.Decoded) {
+				Mix_FreeChunk(request.Decoded);
+			}
+			continue;
+		}
+		CachedSample &cached = it->second;
+		cached.Queued = false;
+		if (request.Decoded == NULL) {
+			fprintf(stderr, "Can't load the sound '%s': %s\n", request.File.c_str(), request.Error.c_str());
+			cached.Failed = true;
+		} else if (request.Sample->abuf) {
+			// Already decoded by DecodeSample
+			Mix_FreeChunk(request.Decoded);
+		} else {
+			InstallSample(request.Sample, cached, request.Decoded);
+		}
+	}
+	ShrinkSampleCache(NULL);
+	StartPendingPlays();
 }
 
 /**
@@ -430,20 +732,36 @@ Mix_Music *LoadMusic(const std::string &name)
 /**
 **  Load a sample
 **
-**  @param name  File name of sample (short version).
+**  The sample is not decoded here, but when it is prefetched or first
+**  played. Loading the same file again returns the same sample.
 **
-**  @return      General sample loaded from file into memory.
+**  @param name  File name of sample (short version).
 **
-**  @todo  Add streaming, caching support.
+**  @return      Sample handle, NULL if the file can't be found.
 */
 Mix_Chunk *LoadSample(const std::string &name)
 {
+	if (!SoundEnabled()) {
+		return NULL;
+	}
 	const std::string filename = LibraryFileName(name.c_str());
-	Mix_Chunk *sample = LoadSample(filename.c_str());
-
-	if (sample == NULL) {
-		fprintf(stderr, "Can't load the sound '%s': %s\n", name.c_str(), Mix_GetError());
+	auto it = SampleFiles.find(filename);
+	if (it != SampleFiles.end()) {
+		++Samples[it->second].Refs;
+		return it->second;
+	}
+	if (!CanAccessFile(name.c_str())) {
+		fprintf(stderr, "Can't load the sound '%s': file not found\n", name.c_str());
+		return NULL;
 	}
+
+	Mix_Chunk *sample = (Mix_Chunk *)SDL_calloc(1, sizeof(Mix_Chunk));
+	sample->volume = MIX_MAX_VOLUME;
+	CachedSample &cached = Samples[sample];
+	cached.File = filename;
+	cached.Id = ++LastSampleId;
+	cached.Refs = 1;
+	SampleFiles[filename] = sample;
 	return sample;
 }
 
@@ -454,14 +772,73 @@ Mix_Chunk *LoadSample(const std::string &name)
  */
 void FreeSample(Mix_Chunk *sample)
 {
-#ifdef DYNAMIC_LOAD
-	if (sample->allocated == 0xcafebeef) {
+	auto it = Samples.find(sample);
+	Assert(it != Samples.end());
+	CachedSample &cached = it->second;
+	if (--cached.Refs > 0) {
 		return;
 	}
-#endif
+	if (cached.Queued) {
+		SDL_LockMutex(DecodeMutex);
+		DecodeQueue.erase(std::remove_if(DecodeQueue.begin(), DecodeQueue.end(),
+										 [&](const DecodeRequest &request) { return request.Sample == sample; }),
+						  DecodeQueue.end());
+		SDL_UnlockMutex(DecodeMutex);
+	}
+	if (sample->abuf) {
+		DecodedSamples.erase(cached.Lru);
+		DecodedBytes -= cached.Size;
+	}
+	PendingPlays.erase(std::remove_if(PendingPlays.begin(), PendingPlays.end(),
+									  [&](const PendingPlay &play) { return play.Sample == sample; }),
+					   PendingPlays.end());
+	SampleFiles.erase(cached.File);
+	Samples.erase(it);
 	Mix_FreeChunk(sample);
 }
 
+/**
+**  Decode a sample in the background, so that it can be played without
+**  delay.
+**
+**  @param sample  Sample handle, may be NULL.
+*/
+void PrefetchSample(Mix_Chunk *sample)
+{
+	if (sample) {
+		QueueDecode(sample, false);
+	}
+}
+
+/**
+**  Decode a sample now, if the decode worker hasn't done it yet.
+**  This waits on the disk, so it is not for samples played in game.
+**
+**  @param sample  Sample handle
+**
+**  @return        true if the sample is decoded
+*/
+bool DecodeSample(Mix_Chunk *sample)
+{
+	CollectDecodedSamples();
+	if (sample->abuf) {
+		return true;
+	}
+	CachedSample &cached = Samples[sample];
+	if (cached.Failed) {
+		return false;
+	}
+	Mix_Chunk *decoded = ForceLoadSample(cached.File.c_str());
+	if (decoded == NULL) {
+		fprintf(stderr, "Can't load the sound '%s': %s\n", cached.File.c_str(), Mix_GetError());
+		cached.Failed = true;
+		return false;
+	}
+	InstallSample(sample, cached, decoded);
+	ShrinkSampleCache(sample);
+	return true;
+}
+
 /**
 **  Play a sound sample
 **
@@ -471,21 +848,22 @@ void FreeSample(Mix_Chunk *sample)
 */
 static int PlaySample(Mix_Chunk *sample, Origin *origin, void (*callback)(int channel))
 {
-#ifdef DYNAMIC_LOAD
-	if (sample->allocated == 0xcafebeef) {
-		char *name = (char*)(sample->abuf);
-		Mix_Chunk *loadedSample = ForceLoadSample(name);
-		if (loadedSample) {
-			memcpy(sample, loadedSample, sizeof(Mix_Chunk));
-			free(name);
-		} else {
-			return -1;
-		}
-	}
-#endif
 	int channel = -1;
-	DebugPrint("play sample %d\n" _C_ sample->volume);
 	if (SoundEnabled() && EffectsEnabled && sample) {
+		CollectDecodedSamples();
+		if (sample->abuf == NULL) {
+			if (DecodeThread) {
+				// Never wait for the disk in a game cycle, the sample plays next time
+				QueueDecode(sample, true);
+				return -1;
+			}
+			if (!DecodeSample(sample)) {
+				return -1;
+			}
+		}
+		CachedSample &cached = Samples[sample];
+		DecodedSamples.splice(DecodedSamples.end(), DecodedSamples, cached.Lru);
+		DebugPrint("play sample %d\n" _C_ sample->volume);
 		channel = Mix_PlayChannel(-1, sample, 0);
 		if (channel >= 0 && channel < MaxChannels) {
 			Channels[channel].FinishedCallback = callback;
@@ -510,6 +888,38 @@ int PlaySample(Mix_Chunk *sample, void (*callback)(int channel))
 	return PlaySample(sample, NULL, callback);
 }
 
+/**
+**  Play a sample now if it is decoded, else as soon as the decode worker
+**  has decoded it. The game never waits for the disk.
+**
+**  @param sample  Sample to play
+**  @param volume  Channel volume 0-255
+*/
+void PlaySampleWhenDecoded(Mix_Chunk *sample, int volume)
+{
+	if (!SoundEnabled() || !EffectsEnabled || sample == NULL) {
+		return;
+	}
+	CollectDecodedSamples();
+	if (sample->abuf == NULL && DecodeThread && !Samples[sample].Failed) {
+		QueueDecode(sample, true);
+		for (PendingPlay &play : PendingPlays) {
+			if (play.Sample == sample) {
+				play.Volume = volume;
+				play.Ticks = SDL_GetTicks();
+				return;
+			}
+		}
+		PendingPlay play = {sample, volume, SDL_GetTicks()};
+		PendingPlays.push_back(play);
+		return;
+	}
+	const int channel = PlaySample(sample);
+	if (channel != -1) {
+		SetChannelVolume(channel, volume);
+	}
+}
+
 /**
 **  Set the global sound volume.
 **
@@ -724,6 +1134,7 @@ int InitSound()
 	SoundInitialized = true;
 	Mix_AllocateChannels(MaxChannels);
 	Mix_ChannelFinished(ChannelFinished);
+	InitDecodeWorker();
 
 	// Now we're ready for the callback to run
 	Mix_ResumeMusic();
@@ -736,6 +1147,7 @@ int InitSound()
 */
 void QuitSound()
 {
+	QuitDecodeWorker();
 	Mix_CloseAudio();
 	Mix_Quit();
 	SoundInitialized = false;
@@ -39,10 +39,12 @@
 
 #include "animation/animation_randomsound.h"
 #include "animation/animation_sound.h"
+#include "interface.h"
 #include "map.h"
 #include "player.h"
 #include "sound.h"
 #include "sound_server.h"
+#include "spells.h"
 #include "unit.h"
 #include "unittype.h"
 #include "video.h"
@@ -59,11 +61,14 @@
 --  Functions
 ----------------------------------------------------------------------------*/
 
-bool SoundConfig::MapSound()
+bool SoundConfig::MapSound(bool prefetch)
 {
 	if (!this->Name.empty()) {
 		this->Sound = SoundForName(this->Name);
 	}
+	if (prefetch) {
+		PrefetchSound(this->Sound);
+	}
 	return this->Sound != NULL;
 }
 
@@ -81,63 +86,109 @@ void LoadUnitSounds()
 {
 }
 
-static void MapAnimSound(CAnimation &anim)
+static void MapAnimSound(CAnimation &anim, bool prefetch)
 {
 	if (anim.Type == AnimationSound) {
 		CAnimation_Sound &anim_sound = *static_cast<CAnimation_Sound *>(&anim);
 
-		anim_sound.MapSound();
+		anim_sound.MapSound(prefetch);
 	} else if (anim.Type == AnimationRandomSound) {
 		CAnimation_RandomSound &anim_rsound = *static_cast<CAnimation_RandomSound *>(&anim);
 
-		anim_rsound.MapSound();
+		anim_rsound.MapSound(prefetch);
 	}
 }
 
 /**
 **  Map animation sounds
 */
-static void MapAnimSounds2(CAnimation *anim)
+static void MapAnimSounds2(CAnimation *anim, bool prefetch)
 {
 	if (anim == NULL) {
 		return ;
 	}
-	MapAnimSound(*anim);
+	MapAnimSound(*anim, prefetch);
 	for (CAnimation *it = anim->Next; it != anim; it = it->Next) {
-		MapAnimSound(*it);
+		MapAnimSound(*it, prefetch);
 	}
 }
 
 /**
 **  Map animation sounds for a unit type
 */
-static void MapAnimSounds(CUnitType &type)
+static void MapAnimSounds(CUnitType &type, bool prefetch)
 {
 	if (!type.Animations) {
 		return;
 	}
-	MapAnimSounds2(type.Animations->Start);
-	MapAnimSounds2(type.Animations->Still);
-	MapAnimSounds2(type.Animations->Move);
-	MapAnimSounds2(type.Animations->Attack);
-	MapAnimSounds2(type.Animations->RangedAttack);
-	MapAnimSounds2(type.Animations->SpellCast);
+	MapAnimSounds2(type.Animations->Start, prefetch);
+	MapAnimSounds2(type.Animations->Still, prefetch);
+	MapAnimSounds2(type.Animations->Move, prefetch);
+	MapAnimSounds2(type.Animations->Attack, prefetch);
+	MapAnimSounds2(type.Animations->RangedAttack, prefetch);
+	MapAnimSounds2(type.Animations->SpellCast, prefetch);
 	for (int i = 0; i <= ANIMATIONS_DEATHTYPES; ++i) {
-		MapAnimSounds2(type.Animations->Death[i]);
+		MapAnimSounds2(type.Animations->Death[i], prefetch);
+	}
+	MapAnimSounds2(type.Animations->Repair, prefetch);
+	MapAnimSounds2(type.Animations->Train, prefetch);
+	MapAnimSounds2(type.Animations->Research, prefetch);
+	MapAnimSounds2(type.Animations->Upgrade, prefetch);
+	MapAnimSounds2(type.Animations->Build, prefetch);
+	for (int i = 0; i < MaxCosts; ++i) {
+		MapAnimSounds2(type.Animations->Harvest[i], prefetch);
+	}
+}
+
+/**
+**  Check if some player has units of a unit type
+*/
+static bool IsUnitTypeOnMap(const CUnitType &type)
+{
+	for (int p = 0; p < PlayerMax; ++p) {
+		if (Players[p].UnitTypesCount[type.Slot] > 0) {
+			return true;
+		}
 	}
-	MapAnimSounds2(type.Animations->Repair);
-	MapAnimSounds2(type.Animations->Train);
-	MapAnimSounds2(type.Animations->Research);
-	MapAnimSounds2(type.Animations->Upgrade);
-	MapAnimSounds2(type.Animations->Build);
+	return false;
+}
+
+/**
+**  Map the sounds of a unit type to the correct sound id.
+**
+**  @param type      Unit type.
+**  @param prefetch  Decode the sounds in the background.
+*/
+static void MapUnitTypeSounds(CUnitType &type, bool prefetch)
+{
+	MapAnimSounds(type, prefetch);
+
+	type.MapSound.Selected.MapSound(prefetch);
+	type.MapSound.Acknowledgement.MapSound(prefetch);
+	// type.Sound.Acknowledgement.SetSoundRange(INFINITE_SOUND_RANGE);
+	type.MapSound.Attack.MapSound(prefetch);
+	type.MapSound.Build.MapSound(prefetch);
+	type.MapSound.Ready.MapSound(prefetch);
+	type.MapSound.Ready.SetSoundRange(INFINITE_SOUND_RANGE);
+	type.MapSound.Repair.MapSound(prefetch);
 	for (int i = 0; i < MaxCosts; ++i) {
-		MapAnimSounds2(type.Animations->Harvest[i]);
+		type.MapSound.Harvest[i].MapSound(prefetch);
+	}
+	type.MapSound.Help.MapSound(prefetch);
+	type.MapSound.Help.SetSoundRange(INFINITE_SOUND_RANGE);
+	type.MapSound.WorkComplete.MapSound(prefetch);
+
+	for (int i = 0; i <= ANIMATIONS_DEATHTYPES; ++i) {
+		type.MapSound.Dead[i].MapSound(prefetch);
 	}
 }
 
 /**
 **  Map the sounds of all unit-types to the correct sound id.
 **  And overwrite the sound ranges.
+**  The sounds of the unit-types present on the map, of the spells and
+**  of the buttons are decoded in the background, so that they are ready
+**  when they are first played.
 **  @todo the sound ranges should be configurable by user with CCL.
 */
 void MapUnitSounds()
@@ -149,27 +200,28 @@ void MapUnitSounds()
 	for (std::vector<CUnitType *>::size_type i = 0; i < UnitTypes.size(); ++i) {
 		CUnitType &type = *UnitTypes[i];
 
-		MapAnimSounds(type);
-
-		type.MapSound.Selected.MapSound();
-		type.MapSound.Acknowledgement.MapSound();
-		// type.Sound.Acknowledgement.SetSoundRange(INFINITE_SOUND_RANGE);
-		type.MapSound.Attack.MapSound();
-		type.MapSound.Build.MapSound();
-		type.MapSound.Ready.MapSound();
-		type.MapSound.Ready.SetSoundRange(INFINITE_SOUND_RANGE);
-		type.MapSound.Repair.MapSound();
-		for (int i = 0; i < MaxCosts; ++i) {
-			type.MapSound.Harvest[i].MapSound();
-		}
-		type.MapSound.Help.MapSound();
-		type.MapSound.Help.SetSoundRange(INFINITE_SOUND_RANGE);
-		type.MapSound.WorkComplete.MapSound();
+		MapUnitTypeSounds(type, IsUnitTypeOnMap(type));
+	}
+	for (size_t i = 0; i != SpellTypeTable.size(); ++i) {
+		PrefetchSound(SpellTypeTable[i]->SoundWhenCast.Sound);
+	}
+	for (size_t i = 0; i != UnitButtonTable.size(); ++i) {
+		PrefetchSound(UnitButtonTable[i]->CommentSound.Sound);
+	}
+}
 
-		for (int i = 0; i <= ANIMATIONS_DEATHTYPES; ++i) {
-			type.MapSound.Dead[i].MapSound();
-		}
+/**
+**  Decode the sounds of a unit type in the background, when no unit of
+**  the type is in the game yet.
+**
+**  @param type  Unit type of the unit entering the game.
+*/
+void PrefetchUnitTypeSounds(const CUnitType &type)
+{
+	if (SoundEnabled() == false || IsUnitTypeOnMap(type)) {
+		return;
 	}
+	MapUnitTypeSounds(*UnitTypes[type.Slot], true);
 }
 
 //@}
@@ -43,6 +43,7 @@
 #include "map.h"
 #include "missile.h"
 #include "network.h"
+#include "network/netimpairment.h"
 #include "particle.h"
 #include "replay.h"
 #include "results.h"
@@ -55,7 +56,7 @@
 #include "parameters.h"
 
 #include <guichan.h>
-void DrawGuichanWidgets();
+bool DrawGuichanWidgets();
 
 
 enum CallPeriod { cEvery2nd   = 0b1, 
@@ -173,11 +174,35 @@ void DrawMapArea()
 	}
 }
 
+/**
+**  Check if the software cursor looks different than in the last frame.
+*/
+static bool MenuCursorChanged()
+{
+	static PixelPos lastPos(-1, -1);
+	static const CCursor *lastCursor = NULL;
+	static unsigned int lastFrame = 0;
+
+	if (Preference.HardwareCursor) {
+		return false;
+	}
+	const unsigned int frame = GameCursor ? GameCursor->SpriteFrame : 0;
+	const bool changed = lastPos != CursorScreenPos || lastCursor != GameCursor || lastFrame != frame;
+	lastPos = CursorScreenPos;
+	lastCursor = GameCursor;
+	lastFrame = frame;
+	return changed;
+}
+
 /**
 **  Display update.
 **
 **  This functions updates everything on screen. The map, the gui, the
 **  cursors.
+**
+**  Outside of the game and the editor only the menus are drawn. When
+**  no widget is dirty and the cursor did not change, the screen is not
+**  sent to the renderer again.
 */
 void UpdateDisplay()
 {
@@ -222,7 +247,7 @@ void UpdateDisplay()
 
 	DrawPieMenu(); // draw pie menu only if needed
 
-	DrawGuichanWidgets();
+	const bool widgetsDrawn = DrawGuichanWidgets();
 
 	if (CursorState != CursorStateRectangle) {
 		DrawCursor();
@@ -231,7 +256,10 @@ void UpdateDisplay()
 	//
 	// Update changes to display.
 	//
-	Invalidate();
+	const bool cursorChanged = MenuCursorChanged();
+	if (GameRunning || Editor.Running == EditorEditing || widgetsDrawn || cursorChanged) {
+		Invalidate();
+	}
 }
 
 static void InitGameCallbacks()
@@ -400,6 +428,10 @@ void GameMainLoop()
 
 	CParticleManager::init();
 
+	if (Parameters::Instance.benchmark) {
+		ResetLuaProfile();
+		SetLuaProfiling(true);
+	}
 	CclCommand("if (GameStarting ~= nil) then GameStarting() end");
 
 	long ticks = SDL_GetTicks();
@@ -420,13 +452,18 @@ void GameMainLoop()
 		return;
 	}
 
+	ticks = SDL_GetTicks() - ticks;
+	if (Parameters::Instance.benchmark || CNetworkImpairment::Instance.IsEnabled()) {
+		NetworkPrintStatistics(ticks);
+	}
 	NetworkQuitGame();
 	EndReplayLog();
 
 	if (Parameters::Instance.benchmark) {
-		ticks = SDL_GetTicks() - ticks;
 		double fps = FrameCounter * 1000.0 / ticks;
 		fprintf(stderr, "BENCHMARK RESULT: %f fps, %f cps (%ldms for %ldframes in %ldcycles)\n", fps, GameCycle * 1000.0 / ticks, ticks, FrameCounter, GameCycle);
+		PrintLuaProfile();
+		SetLuaProfiling(false);
 	}
 
 	GameCycle = 0;
@@ -43,6 +43,8 @@
 #include "action/action_upgradeto.h"
 #include "actions.h"
 #include "ai.h"
+#include "depend.h"
+#include "distancefield.h"
 #include "iolib.h"
 #include "map.h"
 #include "network.h"
@@ -732,6 +734,7 @@ void CPlayer::Init(PlayerTypes type)
 	}
 
 	memset(this->UnitTypesCount, 0, sizeof(this->UnitTypesCount));
+	DependPlayerReset(*this);
 	memset(this->UnitTypesAiActiveCount, 0, sizeof(this->UnitTypesAiActiveCount));
 
 	this->Supply = 0;
@@ -769,6 +772,7 @@ void CPlayer::SetName(const std::string &name)
 */
 void CPlayer::Clear()
 {
+	DependPlayerReset(*this);
 	Index = 0;
 	Name.clear();
 	Type = PlayerTypes::PlayerUnset;
@@ -1428,24 +1432,28 @@ void CPlayer::SetDiplomacyNeutralWith(const CPlayer &player)
 {
 	this->Enemy &= ~(1 << player.Index);
 	this->Allied &= ~(1 << player.Index);
+	DistanceFieldsAlliancesChanged();
 }
 
 void CPlayer::SetDiplomacyAlliedWith(const CPlayer &player)
 {
 	this->Enemy &= ~(1 << player.Index);
 	this->Allied |= 1 << player.Index;
+	DistanceFieldsAlliancesChanged();
 }
 
 void CPlayer::SetDiplomacyEnemyWith(const CPlayer &player)
 {
 	this->Enemy |= 1 << player.Index;
 	this->Allied &= ~(1 << player.Index);
+	DistanceFieldsAlliancesChanged();
 }
 
 void CPlayer::SetDiplomacyCrazyWith(const CPlayer &player)
 {
 	this->Enemy |= 1 << player.Index;
 	this->Allied |= 1 << player.Index;
+	DistanceFieldsAlliancesChanged();
 }
 
 void CPlayer::ShareVisionWith(CPlayer &player)
@@ -44,6 +44,9 @@ error "Missing the <filesystem> header."
 #endif
 
 #include <signal.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
 
 #include "stratagus.h"
 
@@ -160,6 +163,130 @@ static int luatraceback(lua_State *L)
 	return 1;
 }
 
+/**
+**  Cost of the lua functions called by the engine, by function.
+*/
+struct LuaProfileEntry {
+	std::string Source;          /// Chunk of the function
+	int Line = 0;                /// Line where the function is defined
+	unsigned long Calls = 0;     /// Number of calls
+	std::chrono::nanoseconds Time {0};       /// Cumulative time, nested calls included
+	unsigned long Cycle = 0;                 /// Game cycle of CycleTime
+	std::chrono::nanoseconds CycleTime {0};  /// Time spent during Cycle
+};
+
+static bool LuaProfiling = false;          /// Are the lua calls profiled
+static std::chrono::microseconds LuaProfileCycleBudget {0}; /// Warn when a function takes longer during a cycle, 0 to disable
+/// Key of a profile entry: address of the source string and line of the function
+typedef std::pair<const char *, int> LuaProfileKey;
+/// Profile entries, by address of the source string and line of the function
+static std::map<LuaProfileKey, LuaProfileEntry> LuaProfileEntries;
+
+static int LuaCallUnprofiled(lua_State *L, int narg, int nresults, int base, bool exitOnError);
+
+/**
+**  Find the profile entry of the function at index of the stack, create it if needed.
+**
+**  The key is returned rather than the entry, since the lua function
+**  may reset the profile before its call is counted.
+**
+**  @param L      Pointer to Lua state
+**  @param index  Stack index of the function
+**
+**  @return       Key of the profile entry of the function.
+*/
+static LuaProfileKey FindLuaProfileEntry(lua_State *L, int index)
+{
+	lua_Debug ar;
+
+	lua_pushvalue(L, index);
+	lua_getinfo(L, ">S", &ar);
+	const LuaProfileKey key(ar.source, ar.linedefined);
+	LuaProfileEntry &entry = LuaProfileEntries[key];
+
+	// The source string may be freed and its address reused by another chunk.
+	if (entry.Calls == 0 || entry.Source != ar.source) {
+		entry = LuaProfileEntry();
+		entry.Source = ar.source;
+		entry.Line = ar.linedefined;
+	}
+	return key;
+}
+
+/**
+**  Count a call of the function of the profile entry.
+**
+**  @param entry  Profile entry of the called function.
+**  @param time   Duration of the call.
+*/
+static void AddLuaProfileTime(LuaProfileEntry &entry, std::chrono::nanoseconds time)
+{
+	++entry.Calls;
+	entry.Time += time;
+	if (entry.Cycle != GameCycle) {
+		entry.Cycle = GameCycle;
+		entry.CycleTime = std::chrono::nanoseconds(0);
+	}
+	const bool underBudget = entry.CycleTime <= LuaProfileCycleBudget;
+
+	entry.CycleTime += time;
+	if (LuaProfileCycleBudget.count() && underBudget && entry.CycleTime > LuaProfileCycleBudget) {
+		fprintf(stderr, "Lua function %s:%d took %ldus in cycle %lu (budget %ldus)\n",
+				entry.Source.c_str(), entry.Line,
+				static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(entry.CycleTime).count()),
+				GameCycle, static_cast<long>(LuaProfileCycleBudget.count()));
+	}
+}
+
+/**
+**  Enable or disable the profiling of the lua calls.
+**
+**  @param enable  Profile the lua calls.
+**  @param budget  Warn when a function takes more microseconds during a cycle, 0 to disable.
+*/
+void SetLuaProfiling(bool enable, int budget)
+{
+	LuaProfiling = enable;
+	LuaProfileCycleBudget = std::chrono::microseconds(std::max(budget, 0));
+}
+
+/**
+**  Forget the collected costs of the lua calls.
+*/
+void ResetLuaProfile()
+{
+	LuaProfileEntries.clear();
+}
+
+/**
+**  Get the profile entries, the most expensive first.
+*/
+static std::vector<const LuaProfileEntry *> SortedLuaProfileEntries()
+{
+	std::vector<const LuaProfileEntry *> entries;
+
+	for (const auto &entry : LuaProfileEntries) {
+		if (entry.second.Calls) {
+			entries.push_back(&entry.second);
+		}
+	}
+	std::sort(entries.begin(), entries.end(), [](const LuaProfileEntry *lhs, const LuaProfileEntry *rhs) {
+		return lhs->Time > rhs->Time;
+	});
+	return entries;
+}
+
+/**
+**  Print the collected costs of the lua calls.
+*/
+void PrintLuaProfile()
+{
+	for (const LuaProfileEntry *entry : SortedLuaProfileEntries()) {
+		fprintf(stderr, "LUA PROFILE: %s:%d %lu calls, %.3fms\n", entry->Source.c_str(), entry->Line, entry->Calls,
+				std::chrono::duration<double, std::milli>(entry->Time).count());
+	}
+}
+
 /**
 **  Call a lua function
 **
@@ -187,6 +314,35 @@ int LuaCall(int narg, int clear, bool exitOnError)
 **  @return             0 in success, else exit.
 */
 int LuaCall(lua_State *L, int narg, int nresults, int base, bool exitOnError)
+{
+	if (LuaProfiling) {
+		const LuaProfileKey key = FindLuaProfileEntry(L, lua_gettop(L) - narg);
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		const int status = LuaCallUnprofiled(L, narg, nresults, base, exitOnError);
+		const std::chrono::nanoseconds time = std::chrono::steady_clock::now() - start;
+
+		// The call may have reset the profile: its entry is gone then.
+		std::map<LuaProfileKey, LuaProfileEntry>::iterator it = LuaProfileEntries.find(key);
+		if (it != LuaProfileEntries.end()) {
+			AddLuaProfileTime(it->second, time);
+		}
+		return status;
+	}
+	return LuaCallUnprofiled(L, narg, nresults, base, exitOnError);
+}
+
+/**
+**  Call a lua function, without profiling.
+**
+**  @param L            Pointer to Lua state
+**  @param narg         Number of arguments
+**  @param nresults     Number of return values
+**  @param base         Stack index of the function to call
+**  @param exitOnError  Exit the program when an error occurs
+**
+**  @return             0 in success, else exit.
+*/
+static int LuaCallUnprofiled(lua_State *L, int narg, int nresults, int base, bool exitOnError)
 {
 #if 0
 	lua_getglobal(L, "debug");
@@ -978,6 +1134,307 @@ CUnit *EvalUnit(const UnitDesc *unitdesc)
 	return NULL;
 }
 
+/**
+**  Instruction of a compiled number description.
+**
+**  The program works on a stack of ints: each instruction pops its
+**  operands and pushes its result.
+*/
+struct NumberOp {
+	enum OpCode {
+		Push,        /// Push Val.
+		Add,         /// a + b.
+		Sub,         /// a - b.
+		Mul,         /// a * b.
+		Div,         /// a / b, 0 if b is 0.
+		Min,         /// Min(a, b).
+		Max,         /// Max(a, b).
+		Gt,          /// a  > b.
+		GtEq,        /// a >= b.
+		Lt,          /// a  < b.
+		LtEq,        /// a <= b.
+		Eq,          /// a == b.
+		NEq,         /// a <> b.
+		Rand,        /// Rand(a).
+		Jump,        /// Go to instruction Val.
+		JumpIfZero,  /// Pop a, go to instruction Val if a is 0.
+		Lua,         /// Push the result of the lua function Val.
+		UnitField,   /// Push the field of the variable Val of the unit of Desc.
+		UnitDiff,    /// Push Max - Value of the variable Val of the unit of Desc.
+		UnitStat,    /// Push the unit property of Desc.
+		Interpret    /// Push Desc evaluated by the tree interpreter.
+	};
+	OpCode Code;
+	int Val = 0;                        /// Constant, jump target or variable index.
+	int Loc = 0;                        /// Location of Variables[] for the unit ops.
+	int CVariable::*Field = nullptr;    /// Field of the variable for UnitField.
+	const NumberDesc *Desc = nullptr;   /// Node of the unit ops and Interpret.
+};
+
+/**
+**  Compiled form of a number description.
+*/
+struct NumberProgram {
+	std::vector<NumberOp> Ops;  /// Instructions, empty if the tree is too deep.
+};
+
+/// Stack size of the number programs, deeper trees stay interpreted
+static const int NumberProgramMaxDepth = 32;
+
+static int InterpretNumber(const NumberDesc *number);
+static int RunNumberProgram(const NumberProgram &program);
+
+/**
+**  Compile a number description, folding the constant operations.
+**
+**  @param number  Number description to compile.
+**  @param ops     Instructions to complete.
+**  @param depth   Stack depth before the result of number is pushed.
+**
+**  @return        False if the stack is too deep.
+*/
+static bool CompileNumber(const NumberDesc &number, std::vector<NumberOp> &ops, int depth)
+{
+	if (depth >= NumberProgramMaxDepth) {
+		return false;
+	}
+	NumberOp op;
+	op.Desc = &number;
+
+	switch (number.e) {
+		case ENumber_Dir :
+			op.Code = NumberOp::Push;
+			op.Val = number.D.Val;
+			break;
+		case ENumber_Lua :
+			op.Code = NumberOp::Lua;
+			op.Val = number.D.Index;
+			break;
+		case ENumber_Add :
+		case ENumber_Sub :
+		case ENumber_Mul :
+		case ENumber_Div :
+		case ENumber_Min :
+		case ENumber_Max :
+		case ENumber_Gt :
+		case ENumber_GtEq :
+		case ENumber_Lt :
+		case ENumber_LtEq :
+		case ENumber_Eq :
+		case ENumber_NEq : {
+			static const NumberOp::OpCode codes[] = {
+				NumberOp::Add, NumberOp::Sub, NumberOp::Mul, NumberOp::Div, NumberOp::Min, NumberOp::Max
+			};
+			static const NumberOp::OpCode comparisonCodes[] = {
+				NumberOp::Gt, NumberOp::GtEq, NumberOp::Lt, NumberOp::LtEq, NumberOp::Eq, NumberOp::NEq
+			};
+			op.Code = number.e < ENumber_Rand ? codes[number.e - ENumber_Add] : comparisonCodes[number.e - ENumber_Gt];
+			const size_t left = ops.size();
+			if (!CompileNumber(*number.D.binOp.Left, ops, depth) || !CompileNumber(*number.D.binOp.Right, ops, depth + 1)) {
+				return false;
+			}
+			if (ops.size() == left + 2 && ops[left].Code == NumberOp::Push && ops[left + 1].Code == NumberOp::Push) {
+				// Both operands are constant.
+				NumberProgram folded;
+				folded.Ops.assign(ops.begin() + left, ops.end());
+				folded.Ops.push_back(op);
+				ops.resize(left);
+				op.Code = NumberOp::Push;
+				op.Val = RunNumberProgram(folded);
+			}
+			break;
+		}
+		case ENumber_Rand :
+			if (!CompileNumber(*number.D.N, ops, depth)) {
+				return false;
+			}
+			op.Code = NumberOp::Rand;
+			break;
+		case ENumber_UnitStat :
+			op.Val = number.D.UnitStat.Index;
+			op.Loc = number.D.UnitStat.Loc;
+			if (op.Loc < 0 || op.Loc > 2) {
+				op.Code = NumberOp::UnitStat;
+			} else if (number.D.UnitStat.Component == VariableValue) {
+				op.Code = NumberOp::UnitField;
+				op.Field = &CVariable::Value;
+			} else if (number.D.UnitStat.Component == VariableMax) {
+				op.Code = NumberOp::UnitField;
+				op.Field = &CVariable::Max;
+			} else if (number.D.UnitStat.Component == VariableDiff) {
+				op.Code = NumberOp::UnitDiff;
+			} else {
+				op.Code = NumberOp::UnitStat;
+			}
+			break;
+		case ENumber_NumIf : {
+			const size_t cond = ops.size();
+			if (!CompileNumber(*number.D.NumIf.Cond, ops, depth)) {
+				return false;
+			}
+			if (ops.size() == cond + 1 && ops[cond].Code == NumberOp::Push) {
+				// Constant condition: keep only the branch taken.
+				const bool taken = ops[cond].Val != 0;
+				ops.resize(cond);
+				if (taken) {
+					return CompileNumber(*number.D.NumIf.BTrue, ops, depth);
+				} else if (number.D.NumIf.BFalse) {
+					return CompileNumber(*number.D.NumIf.BFalse, ops, depth);
+				}
+				op.Code = NumberOp::Push;
+				op.Val = 0;
+				break;
+			}
+			const size_t jumpToFalse = ops.size();
+			op.Code = NumberOp::JumpIfZero;
+			ops.push_back(op);
+			if (!CompileNumber(*number.D.NumIf.BTrue, ops, depth)) {
+				return false;
+			}
+			const size_t jumpToEnd = ops.size();
+			op.Code = NumberOp::Jump;
+			ops.push_back(op);
+			ops[jumpToFalse].Val = ops.size();
+			if (number.D.NumIf.BFalse) {
+				if (!CompileNumber(*number.D.NumIf.BFalse, ops, depth)) {
+					return false;
+				}
+			} else {
+				op.Code = NumberOp::Push;
+				op.Val = 0;
+				ops.push_back(op);
+			}
+			ops[jumpToEnd].Val = ops.size();
+			return true;
+		}
+		default:
+			op.Code = NumberOp::Interpret;
+			break;
+	}
+	ops.push_back(op);
+	return true;
+}
+
+/**
+**  Get the variable of the unit at a location.
+*/
+static const CVariable &GetUnitVariable(const CUnit &unit, int index, int loc)
+{
+	switch (loc) {
+		case 1: // Type:
+			return unit.Type->MapDefaultStat.Variables[index];
+		case 2: // Stats:
+			return unit.Stats->Variables[index];
+		default: // Unit:
+			return unit.Variable[index];
+	}
+}
+
+/**
+**  Run a compiled number description.
+**
+**  @param program  Compiled number description.
+**
+**  @return         The result number.
+*/
+static int RunNumberProgram(const NumberProgram &program)
+{
+	int stack[NumberProgramMaxDepth];
+	int top = -1;
+	const CUnit *unit;
+
+	for (size_t pc = 0; pc != program.Ops.size(); ++pc) {
+		const NumberOp &op = program.Ops[pc];
+
+		switch (op.Code) {
+			case NumberOp::Push :
+				stack[++top] = op.Val;
+				break;
+			case NumberOp::Add :
+				--top;
+				stack[top] += stack[top + 1];
+				break;
+			case NumberOp::Sub :
+				--top;
+				stack[top] -= stack[top + 1];
+				break;
+			case NumberOp::Mul :
+				--top;
+				stack[top] *= stack[top + 1];
+				break;
+			case NumberOp::Div :
+				--top;
+				stack[top] = stack[top + 1] ? stack[top] / stack[top + 1] : 0; // FIXME : manage better this.
+				break;
+			case NumberOp::Min :
+				--top;
+				stack[top] = std::min(stack[top], stack[top + 1]);
+				break;
+			case NumberOp::Max :
+				--top;
+				stack[top] = std::max(stack[top], stack[top + 1]);
+				break;
+			case NumberOp::Gt :
+				--top;
+				stack[top] = stack[top] > stack[top + 1] ? 1 : 0;
+				break;
+			case NumberOp::GtEq :
+				--top;
+				stack[top] = stack[top] >= stack[top + 1] ? 1 : 0;
+				break;
+			case NumberOp::Lt :
+				--top;
+				stack[top] = stack[top] < stack[top + 1] ? 1 : 0;
+				break;
+			case NumberOp::LtEq :
+				--top;
+				stack[top] = stack[top] <= stack[top + 1] ? 1 : 0;
+				break;
+			case NumberOp::Eq :
+				--top;
+				stack[top] = stack[top] == stack[top + 1] ? 1 : 0;
+				break;
+			case NumberOp::NEq :
+				--top;
+				stack[top] = stack[top] != stack[top + 1] ? 1 : 0;
+				break;
+			case NumberOp::Rand :
+				stack[top] = SyncRand() % stack[top];
+				break;
+			case NumberOp::Jump :
+				pc = op.Val - 1;
+				break;
+			case NumberOp::JumpIfZero :
+				if (stack[top--] == 0) {
+					pc = op.Val - 1;
+				}
+				break;
+			case NumberOp::Lua :
+				stack[++top] = CallLuaNumberFunction(op.Val);
+				break;
+			case NumberOp::UnitField :
+				unit = EvalUnit(op.Desc->D.UnitStat.Unit);
+				stack[++top] = unit ? GetUnitVariable(*unit, op.Val, op.Loc).*op.Field : 0;
+				break;
+			case NumberOp::UnitDiff :
+				unit = EvalUnit(op.Desc->D.UnitStat.Unit);
+				if (unit) {
+					const CVariable &var = GetUnitVariable(*unit, op.Val, op.Loc);
+					stack[++top] = var.Max - var.Value;
+				} else {
+					stack[++top] = 0;
+				}
+				break;
+			case NumberOp::UnitStat :
+			case NumberOp::Interpret :
+				stack[++top] = InterpretNumber(op.Desc);
+				break;
+		}
+	}
+	Assert(top == 0);
+	return stack[0];
+}
+
 /**
 **  compute the number expression
 **
@@ -988,6 +1445,28 @@ CUnit *EvalUnit(const UnitDesc *unitdesc)
 **  @todo Manage better the error (div/0, unit==NULL, ...).
 */
 int EvalNumber(const NumberDesc *number)
+{
+	Assert(number);
+	if (number->Program == NULL) {
+		number->Program = new NumberProgram;
+		if (!CompileNumber(*number, number->Program->Ops, 0)) {
+			number->Program->Ops.clear();
+		}
+	}
+	if (number->Program->Ops.empty()) {
+		return InterpretNumber(number);
+	}
+	return RunNumberProgram(*number->Program);
+}
+
+/**
+**  Compute the number expression by walking its tree.
+**
+**  @param number  struct with definition of the calculation.
+**
+**  @return        the result number.
+*/
+static int InterpretNumber(const NumberDesc *number)
 {
 	CUnit *unit;
 	CUnitType **type;
@@ -1226,6 +1705,8 @@ void FreeNumberDesc(NumberDesc *number)
 	if (number == 0) {
 		return;
 	}
+	delete number->Program;
+	number->Program = NULL;
 	switch (number->e) {
 		case ENumber_Lua :     // a lua function.
 		// FIXME: when lua table should be freed ?
@@ -2695,6 +3176,65 @@ static int CclListFilesystem(lua_State *l)
 	return 1;
 }
 
+/**
+**  Enable or disable the profiling of the lua functions called by the engine.
+**
+**  @param l  Lua state.
+**
+** Example:
+**
+** <div class="example"><code><strong>SetLuaProfiling</strong>(true, 2000)</code></div>
+*/
+static int CclSetLuaProfiling(lua_State *l)
+{
+	const int args = lua_gettop(l);
+	if (args < 1 || args > 2) {
+		LuaError(l, "incorrect argument");
+	}
+	SetLuaProfiling(LuaToBoolean(l, 1), args == 2 ? LuaToNumber(l, 2) : 0);
+	return 0;
+}
+
+/**
+**  Get the cost of the lua functions called by the engine, the most expensive first.
+**
+**  @param l  Lua state.
+**
+**  @return   A table of {Source, Line, Calls, Time} tables, Time in milliseconds.
+*/
+static int CclGetLuaProfile(lua_State *l)
+{
+	LuaCheckArgs(l, 0);
+	const std::vector<const LuaProfileEntry *> entries = SortedLuaProfileEntries();
+
+	lua_createtable(l, entries.size(), 0);
+	for (size_t i = 0; i != entries.size(); ++i) {
+		lua_createtable(l, 0, 4);
+		lua_pushstring(l, entries[i]->Source.c_str());
+		lua_setfield(l, -2, "Source");
+		lua_pushnumber(l, entries[i]->Line);
+		lua_setfield(l, -2, "Line");
+		lua_pushnumber(l, entries[i]->Calls);
+		lua_setfield(l, -2, "Calls");
+		lua_pushnumber(l, std::chrono::duration<double, std::milli>(entries[i]->Time).count());
+		lua_setfield(l, -2, "Time");
+		lua_rawseti(l, -2, i + 1);
+	}
+	return 1;
+}
+
+/**
+**  Forget the collected costs of the lua functions.
+**
+**  @param l  Lua state.
+*/
+static int CclResetLuaProfile(lua_State *l)
+{
+	LuaCheckArgs(l, 0);
+	ResetLuaProfile();
+	return 0;
+}
+
 void ScriptRegister()
 {
 	AliasRegister();
@@ -2715,6 +3255,10 @@ void ScriptRegister()
 
 	lua_register(Lua, "DebugPrint", CclDebugPrint);
 
+	lua_register(Lua, "SetLuaProfiling", CclSetLuaProfiling);
+	lua_register(Lua, "GetLuaProfile", CclGetLuaProfile);
+	lua_register(Lua, "ResetLuaProfile", CclResetLuaProfile);
+
 	lua_register(Lua, "RestartStratagus", CclRestartStratagus);
 }
 
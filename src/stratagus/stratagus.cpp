@@ -195,6 +195,7 @@ extern void beos_init(int argc, char **argv);
 #include "map.h"
 #include "netconnect.h"
 #include "network.h"
+#include "network/netimpairment.h"
 #include "parameters.h"
 #include "player.h"
 #include "replay.h"
@@ -465,9 +466,12 @@ static void Usage()
 		"\t-g\t\tForce software rendering (implies no shaders)\n"
 		"\t-G \"options\"\tGame options (passed to game scripts)\n"
 		"\t-h\t\tHelp shows this page\n"
+		"\t-H cycles\tHash the game state every cycles to locate network desyncs (default 0, off)\n"
 		"\t-i\t\tEnables unit info dumping into log (for debugging)\n"
 		"\t-I addr\t\tNetwork address to use\n"
 		"\t-l\t\tDisable command log\n"
+		"\t-L spec\t\tSimulate network conditions on sent packets, for testing.\n"
+		"\t\t\tspec is delay=ms,jitter=ms,dist=uniform|normal,loss=%%,dup=%%,reorder=%%,seed=n\n"
 		"\t-N name\t\tName of the player\n"
 		"\t-p\t\tEnables debug messages printing in console\n"
 		"\t-P port\t\tNetwork port to use\n"
@@ -530,7 +534,7 @@ void ParseCommandLine(int argc, char **argv, Parameters &parameters)
 #endif
 	char *sep;
 	for (;;) {
-		switch (getopt(argc, argv, "abc:d:D:eE:FgG:hiI:lN:oOP:prs:S:u:v:W?-")) {
+		switch (getopt(argc, argv, "abc:d:D:eE:FgG:hH:iI:lL:N:oOP:prs:S:u:v:W?-")) {
 			case 'a':
 				EnableAssert = true;
 				continue;
@@ -571,6 +575,9 @@ void ParseCommandLine(int argc, char **argv, Parameters &parameters)
 			case 'G':
 				parameters.luaScriptArguments = optarg;
 				continue;
+			case 'H':
+				CNetworkParameter::Instance.syncStateInterval = atoi(optarg);
+				continue;
 			case 'i':
 				EnableUnitDebug = true;
 				continue;
@@ -580,6 +587,12 @@ void ParseCommandLine(int argc, char **argv, Parameters &parameters)
 			case 'l':
 				CommandLogDisabled = true;
 				continue;
+			case 'L':
+				if (!CNetworkImpairment::Instance.Parse(optarg)) {
+					Usage();
+					exit(-1);
+				}
+				continue;
 			case 'N':
 				parameters.LocalPlayerName = optarg;
 				continue;
@@ -916,12 +916,11 @@ bool IsButtonAllowed(const CUnit &unit, const ButtonAction &buttonaction)
 			}
 		// FALL THROUGH
 		case ButtonUpgradeTo:
-		case ButtonResearch:
 		case ButtonBuild:
-			res = CheckDependByIdent(*unit.Player, buttonaction.ValueStr);
-			if (res && !strncmp(buttonaction.ValueStr.c_str(), "upgrade-", 8)) {
-				res = UpgradeIdentAllowed(*unit.Player, buttonaction.ValueStr) == 'A';
-			}
+			res = CheckDependByType(*unit.Player, *UnitTypes[buttonaction.Value]);
+			break;
+		case ButtonResearch:
+			res = CheckDependByUpgrade(*unit.Player, *AllUpgrades[buttonaction.Value]);
 			break;
 		case ButtonSpellCast:
 			res = SpellIsAvailable(*unit.Player, buttonaction.Value);
@@ -101,7 +101,7 @@ bool ButtonCheckUpgrade(const CUnit &unit, const ButtonAction &button)
 */
 bool ButtonCheckIndividualUpgrade(const CUnit &unit, const ButtonAction &button)
 {
-	return unit.IndividualUpgrades[UpgradeIdByIdent(button.AllowStr)];
+	return unit.Cold->IndividualUpgrades[UpgradeIdByIdent(button.AllowStr)];
 }
 
 /**
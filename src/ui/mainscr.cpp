@@ -64,6 +64,7 @@
 #include "../ai/ai_local.h"
 #endif
 
+#include <map>
 #include <sstream>
 
 /*----------------------------------------------------------------------------
@@ -604,24 +605,249 @@ static void DrawUnitInfo(CUnit &unit)
 	}
 }
 
+/*----------------------------------------------------------------------------
+--  CACHED SCREEN AREAS
+----------------------------------------------------------------------------*/
+
+/**
+**  Values a drawn screen area depends on.
+**
+**  The values are compared one by one, so a matching key never shows a
+**  stale area, unlike a hash.
+*/
+class CDrawKey
+{
+public:
+	void Add(intptr_t value) { Values.push_back(value); }
+	void Add(const void *ptr) { Values.push_back(reinterpret_cast<intptr_t>(ptr)); }
+	void AddVariables(const CVariable *variables);
+
+	bool operator==(const CDrawKey &rhs) const { return Values == rhs.Values; }
+	bool operator!=(const CDrawKey &rhs) const { return Values != rhs.Values; }
+
+	std::vector<intptr_t> Values;
+};
+
+void CDrawKey::AddVariables(const CVariable *variables)
+{
+	for (unsigned int i = 0; i < UnitTypeVar.GetNumberVariable(); ++i) {
+		Add(variables[i].Value);
+		Add(variables[i].Max);
+		Add(variables[i].Increase);
+		Add(variables[i].Enable);
+	}
+}
+
+/**
+**  Copy of a screen area, shown again while its key does not change.
+*/
+class CScreenAreaCache
+{
+public:
+	CScreenAreaCache() : Surface(NULL) {}
+	~CScreenAreaCache() { Clear(); }
+
+	bool Restore(const CDrawKey &key) const;
+	void Save(const SDL_Rect &rect, const CDrawKey &key);
+	void Clear();
+
+private:
+	SDL_Surface *Surface;  /// Copy of the screen area
+	SDL_Rect Rect;         /// Area of the screen
+	CDrawKey Key;          /// Values the area was drawn from
+};
+
+/**
+**  Draw the cached area again if it was drawn from the same values.
+**
+**  @param key  Values the area would be drawn from.
+**
+**  @return     true if the area has been drawn.
+*/
+bool CScreenAreaCache::Restore(const CDrawKey &key) const
+{
+	if (!Surface || Surface->format->format != TheScreen->format->format || key != Key) {
+		return false;
+	}
+	SDL_Rect clip;
+	SDL_GetClipRect(TheScreen, &clip);
+	SDL_SetClipRect(TheScreen, NULL);
+	SDL_Rect dst = Rect;
+	SDL_BlitSurface(Surface, NULL, TheScreen, &dst);
+	SDL_SetClipRect(TheScreen, &clip);
+	return true;
+}
+
+/**
+**  Keep a copy of a screen area which has just been drawn.
+**
+**  @param rect  Area of the screen, clipped to the screen.
+**  @param key   Values the area has been drawn from.
+*/
+void CScreenAreaCache::Save(const SDL_Rect &rect, const CDrawKey &key)
+{
+	if (rect.w <= 0 || rect.h <= 0) {
+		Clear();
+		return;
+	}
+	const SDL_PixelFormat *f = TheScreen->format;
+	if (!Surface || Surface->w != rect.w || Surface->h != rect.h || Surface->format->format != f->format) {
+		Clear();
+		Surface = SDL_CreateRGBSurface(SDL_SWSURFACE, rect.w, rect.h, f->BitsPerPixel, f->Rmask, f->Gmask, f->Bmask, f->Amask);
+		if (!Surface) {
+			return;
+		}
+		SDL_SetSurfaceBlendMode(Surface, SDL_BLENDMODE_NONE);
+	}
+	SDL_Rect src = rect;
+	SDL_BlitSurface(TheScreen, &src, Surface, NULL);
+	Rect = rect;
+	Key = key;
+}
+
+void CScreenAreaCache::Clear()
+{
+	if (Surface) {
+		SDL_FreeSurface(Surface);
+		Surface = NULL;
+	}
+	Key.Values.clear();
+}
+
+static CScreenAreaCache InfoPanelCache;  /// Last drawn info panel
+static CScreenAreaCache ResourcesCache;  /// Last drawn resource line
+/// Tell if the info panel background frames are opaque
+static std::map<std::pair<const SDL_Surface *, unsigned>, bool> OpaqueFrames;
+
+/**
+**  Clip a rectangle to the screen.
+*/
+static SDL_Rect ClipToScreen(int x, int y, int w, int h)
+{
+	const SDL_Rect rect = {x, y, w, h};
+	const SDL_Rect screen = {0, 0, TheScreen->w, TheScreen->h};
+	SDL_Rect clipped;
+	if (!SDL_IntersectRect(&rect, &screen, &clipped)) {
+		clipped.w = clipped.h = 0;
+	}
+	return clipped;
+}
+
+/**
+**  Free the cached info panel and resource line.
+*/
+void CleanPanelCaches()
+{
+	InfoPanelCache.Clear();
+	ResourcesCache.Clear();
+	OpaqueFrames.clear();
+}
+
 /*----------------------------------------------------------------------------
 --  RESOURCES
 ----------------------------------------------------------------------------*/
 
+/**
+**  Tell if a screen area can change under the resource line.
+*/
+static bool OverlapsChangingUI(const SDL_Rect &rect)
+{
+	struct {
+		int x, y, w, h;
+	} areas[] = {
+		{UI.MapArea.X, UI.MapArea.Y, UI.MapArea.EndX - UI.MapArea.X + 1, UI.MapArea.EndY - UI.MapArea.Y + 1},
+		{UI.Minimap.X, UI.Minimap.Y, UI.Minimap.W, UI.Minimap.H},
+		{UI.InfoPanel.X, UI.InfoPanel.Y, UI.InfoPanel.G ? UI.InfoPanel.G->Width : 0, UI.InfoPanel.G ? UI.InfoPanel.G->Height : 0}
+	};
+	for (size_t i = 0; i != sizeof(areas) / sizeof(*areas); ++i) {
+		const SDL_Rect area = {areas[i].x, areas[i].y, areas[i].w, areas[i].h};
+		if (SDL_HasIntersection(&rect, &area)) {
+			return true;
+		}
+	}
+	std::vector<const CUIButton *> buttons;
+	buttons.push_back(&UI.MenuButton);
+	buttons.push_back(&UI.NetworkMenuButton);
+	buttons.push_back(&UI.NetworkDiplomacyButton);
+	for (size_t i = 0; i != UI.UserButtons.size(); ++i) {
+		buttons.push_back(&UI.UserButtons[i].Button);
+	}
+	for (size_t i = 0; i != buttons.size(); ++i) {
+		if (buttons[i]->X != -1 && buttons[i]->Style) {
+			const SDL_Rect area = {buttons[i]->X, buttons[i]->Y, buttons[i]->Style->Width, buttons[i]->Style->Height};
+			if (SDL_HasIntersection(&rect, &area)) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+**  Add the values the resource line is drawn from to a key.
+*/
+static void GetResourcesKey(CDrawKey &key)
+{
+	key.Add(ThisPlayer);
+	key.Add(&GetGameFont());
+	key.Add(&GetSmallFont());
+	for (int i = 0; i <= FreeWorkersCount; ++i) {
+		key.Add(UI.Resources[i].G);
+		key.Add(UI.Resources[i].IconFrame);
+		key.Add(UI.Resources[i].IconX);
+		key.Add(UI.Resources[i].IconY);
+		key.Add(UI.Resources[i].TextX);
+		key.Add(UI.Resources[i].TextY);
+	}
+	for (int i = 0; i < MaxCosts; ++i) {
+		key.Add(ThisPlayer->Resources[i]);
+		key.Add(ThisPlayer->MaxResources[i]);
+		key.Add(ThisPlayer->StoredResources[i]);
+	}
+	key.Add(ThisPlayer->Demand);
+	key.Add(ThisPlayer->Supply);
+	key.Add(ThisPlayer->Score);
+	if (UI.Resources[FreeWorkersCount].TextX != -1) {
+		key.Add(ThisPlayer->GetFreeWorkersCount());
+	}
+}
+
 /**
 **  Draw the player resource in top line.
 **
+**  The line only changes with the player resources, so it is drawn from
+**  ResourcesCache while they stay the same, unless something which
+**  changes more often is drawn under it.
+**
 **  @todo FIXME : make DrawResources more configurable (format, font).
 */
 void DrawResources()
 {
+	CDrawKey key;
+	GetResourcesKey(key);
+	if (ResourcesCache.Restore(key)) {
+		return;
+	}
+
 	CLabel label(GetGameFont());
+	// Area covered by the drawn icons and texts
+	SDL_Rect drawn = {0, 0, 0, 0};
+	auto addDrawn = [&drawn](int x, int y, int w, int h) {
+		// texts may have an outline of one pixel
+		const SDL_Rect rect = {x - 1, y - 1, w + 2, h + 2};
+		if (drawn.w == 0) {
+			drawn = rect;
+		} else {
+			SDL_UnionRect(&drawn, &rect, &drawn);
+		}
+	};
 
 	// Draw all icons of resource.
 	for (int i = 0; i < FreeWorkersCount; ++i) {
 		if (UI.Resources[i].G) {
 			UI.Resources[i].G->DrawFrameClip(UI.Resources[i].IconFrame,
 											 UI.Resources[i].IconX, UI.Resources[i].IconY);
+			addDrawn(UI.Resources[i].IconX, UI.Resources[i].IconY, UI.Resources[i].G->Width, UI.Resources[i].G->Height);
 		}
 	}
 	for (int i = 0; i < MaxCosts; ++i) {
@@ -634,11 +860,13 @@ void DrawResources()
 				snprintf(tmp, sizeof(tmp), "%d (%d)", resAmount, ThisPlayer->MaxResources[i] - ThisPlayer->StoredResources[i]);
 				label.SetFont(GetSmallFont());
 
-				label.Draw(UI.Resources[i].TextX, UI.Resources[i].TextY + 3, tmp);
+				const int w = label.Draw(UI.Resources[i].TextX, UI.Resources[i].TextY + 3, tmp);
+				addDrawn(UI.Resources[i].TextX, UI.Resources[i].TextY + 3, w, label.Height());
 			} else {
 				label.SetFont(resourceAmount > 99999 ? GetSmallFont() : GetGameFont());
 
-				label.Draw(UI.Resources[i].TextX, UI.Resources[i].TextY + (resourceAmount > 99999) * 3, resourceAmount);
+				const int w = label.Draw(UI.Resources[i].TextX, UI.Resources[i].TextY + (resourceAmount > 99999) * 3, resourceAmount);
+				addDrawn(UI.Resources[i].TextX, UI.Resources[i].TextY + (resourceAmount > 99999) * 3, w, label.Height());
 			}
 		}
 	}
@@ -646,35 +874,43 @@ void DrawResources()
 		char tmp[256];
 		snprintf(tmp, sizeof(tmp), "%d/%d", ThisPlayer->Demand, ThisPlayer->Supply);
 		label.SetFont(GetGameFont());
+		int w;
 		if (ThisPlayer->Supply < ThisPlayer->Demand) {
-			label.DrawReverse(UI.Resources[FoodCost].TextX, UI.Resources[FoodCost].TextY, tmp);
+			w = label.DrawReverse(UI.Resources[FoodCost].TextX, UI.Resources[FoodCost].TextY, tmp);
 		} else {
-			label.Draw(UI.Resources[FoodCost].TextX, UI.Resources[FoodCost].TextY, tmp);
+			w = label.Draw(UI.Resources[FoodCost].TextX, UI.Resources[FoodCost].TextY, tmp);
 		}
+		addDrawn(UI.Resources[FoodCost].TextX, UI.Resources[FoodCost].TextY, w, label.Height());
 	}
 	if (UI.Resources[ScoreCost].TextX != -1) {
 		const int score = ThisPlayer->Score;
 
 		label.SetFont(score > 99999 ? GetSmallFont() : GetGameFont());
-		label.Draw(UI.Resources[ScoreCost].TextX, UI.Resources[ScoreCost].TextY + (score > 99999) * 3, score);
+		const int w = label.Draw(UI.Resources[ScoreCost].TextX, UI.Resources[ScoreCost].TextY + (score > 99999) * 3, score);
+		addDrawn(UI.Resources[ScoreCost].TextX, UI.Resources[ScoreCost].TextY + (score > 99999) * 3, w, label.Height());
 	}
 	if (UI.Resources[FreeWorkersCount].TextX != -1) {
 		const int workers = ThisPlayer->GetFreeWorkersCount();
 		int textX = UI.Resources[FreeWorkersCount].TextX;
-		if (textX < 0) {
-			// XXX: this is hacky, but what use is that bit otherwise
-			if (workers == 0) {
-				return;
-			} else {
-				textX = -textX;
+		// XXX: this is hacky, but what use is that bit otherwise
+		if (textX >= 0 || workers != 0) {
+			textX = std::abs(textX);
+			if (UI.Resources[FreeWorkersCount].G) {
+				UI.Resources[FreeWorkersCount].G->DrawFrameClip(UI.Resources[FreeWorkersCount].IconFrame,
+												 UI.Resources[FreeWorkersCount].IconX, UI.Resources[FreeWorkersCount].IconY);
+				addDrawn(UI.Resources[FreeWorkersCount].IconX, UI.Resources[FreeWorkersCount].IconY,
+						 UI.Resources[FreeWorkersCount].G->Width, UI.Resources[FreeWorkersCount].G->Height);
 			}
+			label.SetFont(GetGameFont());
+			const int w = label.Draw(textX, UI.Resources[FreeWorkersCount].TextY, workers);
+			addDrawn(textX, UI.Resources[FreeWorkersCount].TextY, w, label.Height());
 		}
-		if (UI.Resources[FreeWorkersCount].G) {
-			UI.Resources[FreeWorkersCount].G->DrawFrameClip(UI.Resources[FreeWorkersCount].IconFrame,
-											 UI.Resources[FreeWorkersCount].IconX, UI.Resources[FreeWorkersCount].IconY);
-		}
-		label.SetFont(GetGameFont());
-		label.Draw(textX, UI.Resources[FreeWorkersCount].TextY, workers);
+	}
+
+	if (drawn.w == 0 || OverlapsChangingUI(drawn)) {
+		ResourcesCache.Clear();
+	} else {
+		ResourcesCache.Save(ClipToScreen(drawn.x, drawn.y, drawn.w, drawn.h), key);
 	}
 }
 
@@ -1182,11 +1418,17 @@ static void InfoPanel_draw_no_selection()
 	}
 }
 
-static void InfoPanel_draw_single_selection(CUnit *selUnit)
+/**
+**  Frame of the info panel background for a single unit.
+**
+**  Panel:
+**    neutral      - neutral or opponent
+**    normal       - not 1,3,4
+**    magic unit   - magic units
+**    construction - under construction
+*/
+static unsigned InfoPanelFrame(const CUnit &unit)
 {
-	CUnit &unit = (selUnit ? *selUnit : *Selected[0]);
-	int panelIndex;
-
 	// FIXME: not correct for enemy's units
 	if (unit.Player == ThisPlayer
 		|| ThisPlayer->IsTeamed(unit)
@@ -1196,16 +1438,19 @@ static void InfoPanel_draw_single_selection(CUnit *selUnit)
 			|| unit.Orders[0]->Action == UnitActionResearch
 			|| unit.Orders[0]->Action == UnitActionUpgradeTo
 			|| unit.Orders[0]->Action == UnitActionTrain) {
-			panelIndex = 3;
+			return 3;
 		} else if (unit.Variable[MANA_INDEX].Max) {
-			panelIndex = 2;
+			return 2;
 		} else {
-			panelIndex = 1;
+			return 1;
 		}
-	} else {
-		panelIndex = 0;
 	}
-	DrawInfoPanelBackground(panelIndex);
+	return 0;
+}
+
+static void InfoPanel_draw_single_selection(CUnit &unit)
+{
+	DrawInfoPanelBackground(InfoPanelFrame(unit));
 	DrawUnitInfo(unit);
 	if (ButtonAreaUnderCursor == ButtonAreaSelected && ButtonUnderCursor == 0) {
 		UI.StatusLine.Set(unit.Type->Name);
@@ -1243,26 +1488,257 @@ static void InfoPanel_draw_multiple_selection()
 	}
 }
 
+/**
+**  Tell if a frame of a graphic covers all the pixels under it.
+*/
+static bool IsOpaqueFrame(const CGraphic &g, unsigned frame)
+{
+	SDL_Surface *surface = g.Surface;
+	if (!surface) {
+		return false;
+	}
+	const std::pair<const SDL_Surface *, unsigned> id(surface, frame);
+	std::map<std::pair<const SDL_Surface *, unsigned>, bool>::const_iterator it = OpaqueFrames.find(id);
+	if (it != OpaqueFrames.end()) {
+		return it->second;
+	}
+
+	const SDL_PixelFormat *f = surface->format;
+	Uint32 colorkey;
+	const bool hasColorKey = !SDL_GetColorKey(surface, &colorkey);
+	Uint8 alpha;
+	SDL_GetSurfaceAlphaMod(surface, &alpha);
+	bool opaque = alpha == 255 && (f->BytesPerPixel == 1 || f->BytesPerPixel == 4);
+	if (opaque && (f->BytesPerPixel == 1 || f->Amask || hasColorKey)) {
+		SDL_LockSurface(surface);
+		for (int y = 0; opaque && y < g.Height; ++y) {
+			const Uint8 *row = static_cast<const Uint8 *>(surface->pixels)
+							   + (g.frame_map[frame].y + y) * surface->pitch + g.frame_map[frame].x * f->BytesPerPixel;
+			for (int x = 0; opaque && x < g.Width; ++x) {
+				if (f->BytesPerPixel == 1) {
+					opaque = !(hasColorKey && row[x] == colorkey) && f->palette->colors[row[x]].a == 255;
+				} else {
+					const Uint32 pixel = reinterpret_cast<const Uint32 *>(row)[x];
+					opaque = !(hasColorKey && pixel == colorkey) && (pixel & f->Amask) == f->Amask;
+				}
+			}
+		}
+		SDL_UnlockSurface(surface);
+	}
+	OpaqueFrames[id] = opaque;
+	return opaque;
+}
+
+static bool IsInsideInfoPanel(const SDL_Rect &panel, int x, int y, int w = 0, int h = 0)
+{
+	return panel.x <= x && panel.y <= y && x + w <= panel.x + panel.w && y + h <= panel.y + panel.h;
+}
+
+static bool IsInsideInfoPanel(const SDL_Rect &panel, const CUIButton *button, int below = 0)
+{
+	return !button || !button->Style
+		   || IsInsideInfoPanel(panel, button->X, button->Y, button->Style->Width, button->Style->Height + below);
+}
+
+/**
+**  Tell if the info panel buttons and contents are drawn inside its background.
+*/
+static bool IsInfoPanelLayoutInside(const SDL_Rect &panel)
+{
+	for (size_t i = 0; i != UI.InfoPanelContents.size(); ++i) {
+		for (size_t j = 0; j != UI.InfoPanelContents[i]->Contents.size(); ++j) {
+			const PixelPos &pos = UI.InfoPanelContents[i]->Contents[j]->Pos;
+			if (!IsInsideInfoPanel(panel, pos.x, pos.y)) {
+				return false;
+			}
+		}
+	}
+	// Life bars are drawn under the icons
+	const int lifeBar = UI.LifeBarYOffset + 12;
+	for (size_t i = 0; i != UI.SelectedButtons.size(); ++i) {
+		if (!IsInsideInfoPanel(panel, &UI.SelectedButtons[i], lifeBar)) {
+			return false;
+		}
+	}
+	for (size_t i = 0; i != UI.TransportingButtons.size(); ++i) {
+		if (!IsInsideInfoPanel(panel, &UI.TransportingButtons[i], lifeBar)) {
+			return false;
+		}
+	}
+	for (size_t i = 0; i != UI.TrainingButtons.size(); ++i) {
+		if (!IsInsideInfoPanel(panel, &UI.TrainingButtons[i])) {
+			return false;
+		}
+	}
+	if (Selected.size() > UI.SelectedButtons.size()
+		&& !IsInsideInfoPanel(panel, UI.MaxSelectedTextX, UI.MaxSelectedTextY)) {
+		return false;
+	}
+	return IsInsideInfoPanel(panel, UI.SingleSelectedButton)
+		   && IsInsideInfoPanel(panel, UI.SingleTrainingButton)
+		   && IsInsideInfoPanel(panel, UI.UpgradingButton)
+		   && IsInsideInfoPanel(panel, UI.ResearchingButton)
+		   && (UI.SingleTrainingText.empty() || IsInsideInfoPanel(panel, UI.SingleTrainingTextX, UI.SingleTrainingTextY))
+		   && (UI.TrainingText.empty() || IsInsideInfoPanel(panel, UI.TrainingTextX, UI.TrainingTextY));
+}
+
+/**
+**  Add the values a single unit is shown from in the info panel to a key.
+*/
+static void GetUnitInfoKey(CDrawKey &key, const CUnit &unit)
+{
+	key.Add(&unit);
+	key.Add(unit.Type);
+	key.Add(unit.Player);
+	key.Add(unit.RescuedFrom);
+	key.Add(unit.Stats);
+	key.Add(unit.Selected);
+	key.Add(IsOnlySelected(unit));
+	key.Add(static_cast<int>(unit.Player->Type));
+	key.Add(ThisPlayer->IsEnemy(unit));
+	key.Add(ThisPlayer->IsAllied(unit));
+	key.Add(ThisPlayer->IsTeamed(unit));
+	key.Add(ThisPlayer->IsAllied(*unit.Player));
+	key.AddVariables(unit.Variable);
+	key.AddVariables(unit.Stats->Variables);
+	key.AddVariables(unit.Type->MapDefaultStat.Variables);
+
+	key.Add(unit.Orders.size());
+	for (size_t i = 0; i != unit.Orders.size(); ++i) {
+		const COrder *order = unit.Orders[i];
+		key.Add(order);
+		key.Add(order->Action);
+		switch (order->Action) {
+			case UnitActionTrain:
+				key.Add(&static_cast<const COrder_Train *>(order)->GetUnitType());
+				break;
+			case UnitActionUpgradeTo:
+				key.Add(&static_cast<const COrder_UpgradeTo *>(order)->GetUnitType());
+				break;
+			case UnitActionResearch:
+				key.Add(&static_cast<const COrder_Research *>(order)->GetUpgrade());
+				break;
+			default:
+				break;
+		}
+	}
+
+	key.Add(unit.InsideCount);
+	key.Add(unit.BoardCount);
+	const CUnit *uins = unit.UnitInside;
+	for (int i = 0; i < unit.InsideCount; ++i, uins = uins->NextContained) {
+		key.Add(uins);
+		key.Add(uins->Boarded);
+		key.Add(uins->Type);
+		key.Add(uins->Player);
+		key.Add(uins->RescuedFrom);
+		key.Add(uins->Stats);
+		key.AddVariables(uins->Variable);
+	}
+
+	// Contents computed from other values are drawn again each game cycle
+	for (size_t i = 0; i != UI.InfoPanelContents.size(); ++i) {
+		if (!CanShowContent(UI.InfoPanelContents[i]->Condition, unit)) {
+			continue;
+		}
+		for (size_t j = 0; j != UI.InfoPanelContents[i]->Contents.size(); ++j) {
+			const CContentType &content = *UI.InfoPanelContents[i]->Contents[j];
+			if (content.IsVolatile() && CanShowContent(content.Condition, unit)) {
+				key.Add(GameCycle);
+				return;
+			}
+		}
+	}
+}
+
+/**
+**  Get the values the info panel is drawn from.
+**
+**  @param unit   Unit shown alone, or NULL to show the selected units.
+**  @param frame  Frame of the info panel background.
+**  @param key    Filled with the values.
+**
+**  @return       false if the panel can't be cached: the cursor is on
+**                one of its buttons, the portrait is animated, or the
+**                panel does not fully cover what it draws.
+*/
+static bool GetInfoPanelKey(const CUnit *unit, unsigned frame, CDrawKey &key)
+{
+	if (!UI.InfoPanel.G
+		|| (ButtonAreaUnderCursor >= ButtonAreaSelected && ButtonAreaUnderCursor <= ButtonAreaTransporting)) {
+		return false;
+	}
+#ifdef USE_MNG
+	if (UI.SingleSelectedButton && (unit ? unit->Type : Selected[0]->Type)->Portrait.Num) {
+		return false;
+	}
+#endif
+	const SDL_Rect panel = {UI.InfoPanel.X, UI.InfoPanel.Y, UI.InfoPanel.G->Width, UI.InfoPanel.G->Height};
+	if (!IsOpaqueFrame(*UI.InfoPanel.G, frame) || !IsInfoPanelLayoutInside(panel)) {
+		return false;
+	}
+
+	key.Add(UI.InfoPanel.G);
+	key.Add(UI.InfoPanel.X);
+	key.Add(UI.InfoPanel.Y);
+	key.Add(TheScreen->w);
+	key.Add(TheScreen->h);
+	key.Add(frame);
+	key.Add(ThisPlayer);
+	key.Add(ReplayRevealMap);
+	key.Add(CurrentButtonLevel);
+	key.Add(Preference.IconsShift);
+	if (unit) {
+		GetUnitInfoKey(key, *unit);
+	} else {
+		key.Add(Selected.size());
+		for (size_t i = 0; i != std::min(Selected.size(), UI.SelectedButtons.size()); ++i) {
+			const CUnit &selected = *Selected[i];
+			key.Add(&selected);
+			key.Add(selected.Type);
+			key.Add(selected.Player);
+			key.Add(selected.RescuedFrom);
+			key.AddVariables(selected.Variable);
+		}
+	}
+	return true;
+}
+
 /**
 **  Draw info panel.
 **
-**  Panel:
-**    neutral      - neutral or opponent
-**    normal       - not 1,3,4
-**    magic unit   - magic units
-**    construction - under construction
+**  The panel of a single unit or of a group is drawn from InfoPanelCache
+**  while the values it shows stay the same.
 */
 void CInfoPanel::Draw()
 {
+	CUnit *unit = NULL;
 	if (UnitUnderCursor && Selected.empty() && !UnitUnderCursor->Type->BoolFlag[ISNOTSELECTABLE_INDEX].value
 		&& (ReplayRevealMap || UnitUnderCursor->IsVisible(*ThisPlayer))) {
-			InfoPanel_draw_single_selection(UnitUnderCursor);
+		unit = UnitUnderCursor;
+	} else if (Selected.empty()) {
+		InfoPanel_draw_no_selection();
+		return;
+	} else if (Selected.size() == 1) {
+		unit = Selected[0];
+	}
+
+	if (unit) {
+		UpdateUnitVariables(*unit);
+	}
+	const unsigned frame = unit ? InfoPanelFrame(*unit) : 0;
+	CDrawKey key;
+	const bool cacheable = GetInfoPanelKey(unit, frame, key);
+	if (cacheable && InfoPanelCache.Restore(key)) {
+		return;
+	}
+	if (unit) {
+		InfoPanel_draw_single_selection(*unit);
 	} else {
-		switch (Selected.size()) {
-			 case 0: { InfoPanel_draw_no_selection(); break; }
-			 case 1: { InfoPanel_draw_single_selection(NULL); break; }
-			 default: { InfoPanel_draw_multiple_selection(); break; }
-		}
+		InfoPanel_draw_multiple_selection();
+	}
+	if (cacheable) {
+		InfoPanelCache.Save(ClipToScreen(X, Y, G->Width, G->Height), key);
 	}
 }
 
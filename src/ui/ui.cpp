@@ -370,6 +370,7 @@ void CleanUserInterface()
 	}
 
 	// Info Panel
+	CleanPanelCaches();
 	CGraphic::Free(UI.InfoPanel.G);
 	for (std::vector<CUnitInfoPanel *>::iterator panel = UI.InfoPanelContents.begin();
 		 panel != UI.InfoPanelContents.end(); ++panel) {
@@ -490,6 +491,10 @@ static void FinishViewportModeConfiguration(CViewport new_vps[], int num_vps)
 		vp.Set(new_vps[i].MapPos, new_vps[i].Offset);
 	}
 	UI.NumViewports = num_vps;
+	// The draw orders don't match the new viewports, and the unused ones must not keep units
+	for (int i = 0; i < MAX_NUM_VIEWPORTS; ++i) {
+		UI.Viewports[i].ClearDrawnUnits();
+	}
 
 	//
 	//  Update the viewport pointers
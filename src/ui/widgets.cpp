@@ -157,12 +157,23 @@ void handleInput(const SDL_Event *event)
 	}
 }
 
-void DrawGuichanWidgets()
+/**
+**  Draw the widgets.
+**
+**  @return  true if something was drawn, false if the menus did not
+**           change since they were last drawn.
+*/
+bool DrawGuichanWidgets()
 {
-	if (Gui) {
-		Gui->setUseDirtyDrawing(!GameRunning && !Editor.Running);
-		Gui->draw();
+	if (!Gui) {
+		return false;
 	}
+	const bool dirtyDrawing = !GameRunning && !Editor.Running;
+	Gui->setUseDirtyDrawing(dirtyDrawing);
+	gcn::Widget *top = Gui->getTop();
+	const bool drawn = !dirtyDrawing || (top && top->getDirty());
+	Gui->draw();
+	return drawn;
 }
 
 
@@ -2393,7 +2404,7 @@ int StatBoxWidget::getPercent() const
 **  MenuScreen constructor
 */
 MenuScreen::MenuScreen() :
-	Container(), runLoop(true), logiclistener(0), drawUnder(false)
+	Container(), runLoop(true), logiclistener(0), drawUnder(false), drawCache(NULL)
 {
 	setDimension(gcn::Rectangle(0, 0, Video.Width, Video.Height));
 	setOpaque(false);
@@ -2475,15 +2486,96 @@ void MenuScreen::addLogicCallback(LuaActionListener *listener)
 	logiclistener = listener;
 }
 
+MenuScreen::~MenuScreen()
+{
+	freeDrawCache();
+}
+
+void MenuScreen::freeDrawCache()
+{
+	if (drawCache) {
+		SDL_FreeSurface(drawCache);
+		drawCache = NULL;
+	}
+	drawCacheWidgets.clear();
+}
+
 void MenuScreen::draw(gcn::Graphics *graphics)
 {
 	if (this->drawUnder) {
+		if (oldtop && oldtop->getDirty()) {
+			// the cached screen shows the old menu under this one
+			drawCacheWidgets.clear();
+		}
 		gcn::Rectangle r = Gui->getGraphics()->getCurrentClipArea();
 		Gui->getGraphics()->popClipArea();
 		Gui->draw(oldtop);
 		Gui->getGraphics()->pushClipArea(r);
 	}
-	gcn::Container::draw(graphics);
+	if (Gui->getUseDirtyDrawing() && !isOpaque()) {
+		drawChildrenCached(graphics);
+	} else {
+		freeDrawCache();
+		gcn::Container::draw(graphics);
+	}
+}
+
+/**
+**  Draw the children, starting from a copy of the screen.
+**
+**  Menus are only drawn when a widget is dirty, and then the whole tree
+**  is drawn again. The leading children which are not dirty, often the
+**  background and the static labels, are drawn once into drawCache.
+**  The next draws copy it to the screen and only draw the children
+**  from the first dirty one.
+*/
+void MenuScreen::drawChildrenCached(gcn::Graphics *graphics)
+{
+	// Number of leading children which are not dirty
+	size_t clean = 0;
+	for (WidgetIterator it = mWidgets.begin(); it != mWidgets.end() && !(*it)->getDirty(); ++it) {
+		++clean;
+	}
+
+	// The cache is usable if it holds a prefix of the clean children
+	size_t cached = drawCacheWidgets.size();
+	if (!drawCache || drawCache->w != TheScreen->w || drawCache->h != TheScreen->h
+		|| drawCache->format->format != TheScreen->format->format || cached > clean) {
+		cached = 0;
+	} else {
+		WidgetIterator it = mWidgets.begin();
+		for (size_t i = 0; i != cached; ++i, ++it) {
+			if (*it != drawCacheWidgets[i]) {
+				cached = 0;
+				break;
+			}
+		}
+	}
+
+	WidgetIterator it = mWidgets.begin();
+	if (cached) {
+		SDL_BlitSurface(drawCache, NULL, TheScreen, NULL);
+		std::advance(it, cached);
+	}
+	size_t i = cached;
+	for (; i != clean; ++i, ++it) {
+		drawChild(graphics, *it);
+	}
+	if (clean > cached) {
+		if (!drawCache || drawCache->w != TheScreen->w || drawCache->h != TheScreen->h
+			|| drawCache->format->format != TheScreen->format->format) {
+			freeDrawCache();
+			drawCache = SDL_ConvertSurface(TheScreen, TheScreen->format, 0);
+		} else {
+			SDL_BlitSurface(TheScreen, NULL, drawCache, NULL);
+		}
+		drawCacheWidgets.assign(mWidgets.begin(), it);
+	} else if (!cached) {
+		drawCacheWidgets.clear();
+	}
+	for (; it != mWidgets.end(); ++it) {
+		drawChild(graphics, *it);
+	}
 }
 
 void MenuScreen::logic()
@@ -55,6 +55,47 @@
 /// All dependencies hash
 static DependRule *DependHash[101];
 
+/**
+**  Dependencies compiled to flat index-based tables.
+**
+**  A key identifies a required (or target) object: unit-types use their
+**  slot, upgrades are stored after all unit-types as UnitTypeMax + ID.
+*/
+struct CompiledRequirement {
+	int Watch;                 /// index into CompiledDepends::WatchKeys
+	unsigned char Count;       /// how many required
+};
+
+struct CompiledOrRule {
+	unsigned int Begin;        /// first and-requirement in Requirements
+	unsigned int End;          /// one past last and-requirement
+};
+
+struct CompiledTarget {
+	unsigned int Begin;        /// first or-rule in OrRules
+	unsigned int End;          /// one past last or-rule
+};
+
+static struct CompiledDepends {
+	bool Valid = false;                          /// tables match DependHash
+	std::vector<int> TargetIndex;                /// key -> CompiledTarget index or -1
+	std::vector<CompiledTarget> Targets;         /// all targets having rules
+	std::vector<CompiledOrRule> OrRules;         /// all or-rules
+	std::vector<CompiledRequirement> Requirements; /// all and-requirements
+	std::vector<int> WatchKeys;                  /// distinct required keys
+	std::vector<int> WatchIndex;                 /// key -> WatchKeys index or -1
+	std::vector<std::vector<int>> Dependents;    /// watch -> targets using it
+} Compiled;
+
+/// Per player cache of the satisfied dependency targets
+struct DependCache {
+	std::vector<int> WatchState;     /// last seen state of each watched key
+	std::vector<bool> Known;         /// target result is up to date
+	std::vector<bool> Satisfied;     /// target requirements are met
+};
+
+static DependCache DependCaches[PlayerMax];
+
 /*----------------------------------------------------------------------------
 --  Functions
 ----------------------------------------------------------------------------*/
@@ -71,6 +112,8 @@ static void AddDependency(const std::string &target, const std::string &required
 {
 	DependRule rule;
 
+	Compiled.Valid = false;
+
 	//  Setup structure.
 	if (!strncmp(target.c_str(), "unit-", 5)) {
 		// target string refers to unit-xxx
@@ -171,58 +214,238 @@ static void AddDependency(const std::string &target, const std::string &required
 }
 
 /**
-**  Check if this upgrade or unit is available.
+**  Get the compiled key of the object of a dependency rule.
 **
-**  @param player  For this player available.
-**  @param rule  .
+**  @param rule  Rule holding an unit-type or an upgrade.
 **
-**  @return        True if available, false otherwise.
+**  @return      Unit-type slot, or UnitTypeMax + upgrade ID.
 */
-static bool CheckDependByRule(const CPlayer &player, DependRule &rule)
+static int DependRuleKey(const DependRule &rule)
 {
-	//  Find rule
-	int i = (int)((intptr_t)rule.Kind.UnitType % (sizeof(DependHash) / sizeof(*DependHash)));
-	const DependRule *node = DependHash[i];
+	if (rule.Type == DependRuleUnitType) {
+		return rule.Kind.UnitType->Slot;
+	}
+	return UnitTypeMax + rule.Kind.Upgrade->ID;
+}
 
-	if (node) {  // find correct entry
-		while (node->Type != rule.Type || node->Kind.Upgrade != rule.Kind.Upgrade) {
-			if (!node->Next) {  // end of list
-				return true;
+/**
+**  Compile the dependency hash chains into flat index-based tables.
+**
+**  Also throws away the per player caches, they refer to old indexes.
+*/
+static void CompileDependencies()
+{
+	Compiled.TargetIndex.assign(UnitTypeMax + UpgradeMax, -1);
+	Compiled.Targets.clear();
+	Compiled.OrRules.clear();
+	Compiled.Requirements.clear();
+	Compiled.WatchKeys.clear();
+	Compiled.WatchIndex.assign(UnitTypeMax + UpgradeMax, -1);
+	Compiled.Dependents.clear();
+
+	std::vector<int> &watchIndex = Compiled.WatchIndex;
+
+	for (const DependRule *node : DependHash) {
+		for (; node; node = node->Next) {
+			const int target = Compiled.Targets.size();
+			CompiledTarget compiledTarget;
+
+			Compiled.TargetIndex[DependRuleKey(*node)] = target;
+			compiledTarget.Begin = Compiled.OrRules.size();
+			for (const DependRule *orRule = node->Rule; orRule; orRule = orRule->Next) {
+				CompiledOrRule compiledOrRule;
+
+				compiledOrRule.Begin = Compiled.Requirements.size();
+				for (const DependRule *andRule = orRule; andRule; andRule = andRule->Rule) {
+					const int key = DependRuleKey(*andRule);
+
+					if (watchIndex[key] == -1) {
+						watchIndex[key] = Compiled.WatchKeys.size();
+						Compiled.WatchKeys.push_back(key);
+						Compiled.Dependents.emplace_back();
+					}
+					std::vector<int> &dependents = Compiled.Dependents[watchIndex[key]];
+					if (dependents.empty() || dependents.back() != target) {
+						dependents.push_back(target);
+					}
+					CompiledRequirement requirement;
+					requirement.Watch = watchIndex[key];
+					// An upgrade is either researched or not.
+					requirement.Count = (andRule->Type == DependRuleUpgrade && andRule->Count) ? 1 : andRule->Count;
+					Compiled.Requirements.push_back(requirement);
+				}
+				compiledOrRule.End = Compiled.Requirements.size();
+				Compiled.OrRules.push_back(compiledOrRule);
 			}
-			node = node->Next;
+			compiledTarget.End = Compiled.OrRules.size();
+			Compiled.Targets.push_back(compiledTarget);
 		}
-	} else {
-		return true;
 	}
+	for (DependCache &cache : DependCaches) {
+		cache = DependCache();
+	}
+	Compiled.Valid = true;
+}
 
-	//  Prove the rules
-	node = node->Rule;
+/**
+**  Get the current state of a watched key for a player.
+**
+**  @param player  Player to look at.
+**  @param key     Unit-type slot, or UnitTypeMax + upgrade ID.
+**
+**  @return        Unit count for unit-types, 1 if an upgrade is researched.
+*/
+static int GetDependWatchState(const CPlayer &player, int key)
+{
+	if (key < UnitTypeMax) {
+		return player.UnitTypesCount[key];
+	}
+	return UpgradeIdAllowed(player, key - UnitTypeMax) == 'R';
+}
 
-	while (node) {
-		const DependRule *temp = node;
-		while (temp) {
-			switch (temp->Type) {
-				case DependRuleUnitType:
-					i = player.HaveUnitTypeByType(*temp->Kind.UnitType);
-					if (temp->Count ? i < temp->Count : i) {
-						goto try_or;
-					}
-					break;
-				case DependRuleUpgrade:
-					i = UpgradeIdAllowed(player, temp->Kind.Upgrade->ID) != 'R';
-					if (temp->Count ? i : !i) {
-						goto try_or;
-					}
-					break;
+/**
+**  Get the dependency cache of a player, filled on first use.
+**
+**  The cache is kept up to date by DependUnitTypeCountChanged() and
+**  DependUpgradeChanged(), so no watched key is read here once filled.
+**
+**  @param player  Player whose cache is wanted.
+**
+**  @return        The up to date cache.
+*/
+static DependCache &UpdateDependCache(const CPlayer &player)
+{
+	if (!Compiled.Valid) {
+		CompileDependencies();
+	}
+	DependCache &cache = DependCaches[player.Index];
+
+	if (cache.WatchState.size() != Compiled.WatchKeys.size()
+		|| cache.Known.size() != Compiled.Targets.size()) {
+		cache.WatchState.resize(Compiled.WatchKeys.size());
+		for (size_t i = 0; i != Compiled.WatchKeys.size(); ++i) {
+			cache.WatchState[i] = GetDependWatchState(player, Compiled.WatchKeys[i]);
+		}
+		cache.Known.assign(Compiled.Targets.size(), false);
+		cache.Satisfied.assign(Compiled.Targets.size(), false);
+	}
+	return cache;
+}
+
+/**
+**  Invalidate the targets depending on a watched key of a player.
+**
+**  @param player  Player whose unit count or upgrade has changed.
+**  @param key     Unit-type slot, or UnitTypeMax + upgrade ID.
+*/
+static void DependKeyChanged(const CPlayer &player, int key)
+{
+	DependCache &cache = DependCaches[player.Index];
+
+	// A cache not filled yet reads all the keys on first use.
+	if (!Compiled.Valid || cache.WatchState.size() != Compiled.WatchKeys.size()) {
+		return;
+	}
+	const int watch = Compiled.WatchIndex[key];
+
+	if (watch == -1) {
+		return;
+	}
+	const int state = GetDependWatchState(player, key);
+
+	if (state != cache.WatchState[watch]) {
+		cache.WatchState[watch] = state;
+		for (int target : Compiled.Dependents[watch]) {
+			cache.Known[target] = false;
+		}
+	}
+}
+
+/**
+**  Tell the dependency cache that the unit count of a unit-type has changed.
+**
+**  @param player  Player owning the units.
+**  @param type    Unit-type whose count has changed.
+*/
+void DependUnitTypeCountChanged(const CPlayer &player, const CUnitType &type)
+{
+	DependKeyChanged(player, type.Slot);
+}
+
+/**
+**  Tell the dependency cache that the allow state of an upgrade has changed.
+**
+**  @param player  Player whose upgrade has changed.
+**  @param id      Upgrade ID.
+*/
+void DependUpgradeChanged(const CPlayer &player, int id)
+{
+	DependKeyChanged(player, UnitTypeMax + id);
+}
+
+/**
+**  Throw away the dependency cache of a player.
+**
+**  Used when all the unit counts of the player are reset.
+**
+**  @param player  Player whose cache is dropped.
+*/
+void DependPlayerReset(const CPlayer &player)
+{
+	DependCaches[player.Index] = DependCache();
+}
+
+/**
+**  Evaluate the rules of a compiled target.
+**
+**  @param cache   Up to date cache of the player.
+**  @param target  Compiled target to check.
+**
+**  @return        True if one of the or-rules matches.
+*/
+static bool EvalCompiledTarget(const DependCache &cache, const CompiledTarget &target)
+{
+	for (unsigned int i = target.Begin; i != target.End; ++i) {
+		const CompiledOrRule &orRule = Compiled.OrRules[i];
+		bool match = true;
+
+		for (unsigned int j = orRule.Begin; j != orRule.End; ++j) {
+			const CompiledRequirement &requirement = Compiled.Requirements[j];
+			const int state = cache.WatchState[requirement.Watch];
+
+			if (requirement.Count ? state < requirement.Count : state != 0) {
+				match = false;
+				break;
 			}
-			temp = temp->Rule;
 		}
-		return true;  // all rules matches.
+		if (match) {
+			return true;
+		}
+	}
+	return false;
+}
 
-try_or:
-		node = node->Next;
+/**
+**  Check if this upgrade or unit is available.
+**
+**  @param player  For this player available.
+**  @param key     Unit-type slot, or UnitTypeMax + upgrade ID.
+**
+**  @return        True if available, false otherwise.
+*/
+static bool CheckDependByKey(const CPlayer &player, int key)
+{
+	DependCache &cache = UpdateDependCache(player);
+	const int target = Compiled.TargetIndex[key];
+
+	if (target == -1) {
+		return true;
 	}
-	return false;  // no rule matches
+	if (!cache.Known[target]) {
+		cache.Satisfied[target] = EvalCompiledTarget(cache, Compiled.Targets[target]);
+		cache.Known[target] = true;
+	}
+	return cache.Satisfied[target];
 }
 
 /**
@@ -325,37 +548,26 @@ std::string PrintDependencies(const CPlayer &player, const ButtonAction &button)
 */
 bool CheckDependByIdent(const CPlayer &player, const std::string &target)
 {
-	DependRule rule;
-
 	//
 	//  first have to check, if target is allowed itself
 	//
 	if (!strncmp(target.c_str(), "unit-", 5)) {
 		// target string refers to unit-XXX
-		rule.Kind.UnitType = UnitTypeByIdent(target);
-		if (UnitIdAllowed(player, rule.Kind.UnitType->Slot) == 0) {
-			return false;
-		}
-		rule.Type = DependRuleUnitType;
+		return CheckDependByType(player, *UnitTypeByIdent(target));
 	} else if (!strncmp(target.c_str(), "upgrade-", 8)) {
 		// target string refers to upgrade-XXX
-		rule.Kind.Upgrade = CUpgrade::Get(target);
-		if (UpgradeIdAllowed(player, rule.Kind.Upgrade->ID) != 'A') {
-			return false;
-		}
-		rule.Type = DependRuleUpgrade;
+		return CheckDependByUpgrade(player, *CUpgrade::Get(target));
 	} else {
 		DebugPrint("target '%s' should be unit-type or upgrade\n" _C_ target.c_str());
 		return false;
 	}
-	return CheckDependByRule(player, rule);
 }
 
 /**
-**  Check if this upgrade or unit is available.
+**  Check if this unit is available.
 **
 **  @param player  For this player available.
-**  @param target  Unit or Upgrade.
+**  @param type    Unit-type to check.
 **
 **  @return        True if available, false otherwise.
 */
@@ -364,11 +576,23 @@ bool CheckDependByType(const CPlayer &player, const CUnitType &type)
 	if (UnitIdAllowed(player, type.Slot) == 0) {
 		return false;
 	}
-	DependRule rule;
+	return CheckDependByKey(player, type.Slot);
+}
 
-	rule.Kind.UnitType = &type;
-	rule.Type = DependRuleUnitType;
-	return CheckDependByRule(player, rule);
+/**
+**  Check if this upgrade is available.
+**
+**  @param player   For this player available.
+**  @param upgrade  Upgrade to check.
+**
+**  @return         True if available, false otherwise.
+*/
+bool CheckDependByUpgrade(const CPlayer &player, const CUpgrade &upgrade)
+{
+	if (UpgradeIdAllowed(player, upgrade.ID) != 'A') {
+		return false;
+	}
+	return CheckDependByKey(player, UnitTypeMax + upgrade.ID);
 }
 
 /**
@@ -376,6 +600,7 @@ bool CheckDependByType(const CPlayer &player, const CUnitType &type)
 */
 void InitDependencies()
 {
+	CompileDependencies();
 }
 
 /**
@@ -410,6 +635,7 @@ void CleanDependencies()
 		}
 		DependHash[u] = NULL;
 	}
+	Compiled.Valid = false;
 }
 
 /*----------------------------------------------------------------------------
@@ -40,6 +40,7 @@
 #include "animation.h"
 #include "commands.h"
 #include "construct.h"
+#include "depend.h"
 #include "interface.h"
 #include "map.h"
 #include "netconnect.h"
@@ -361,7 +362,7 @@ static int CclUnit(lua_State *l)
 			// until we parsed at least Unit::Orders[].
 			Assert(type);
 			unit->Init(*type);
-			unit->Seen.Type = seentype;
+			unit->Cold->Seen.Type = seentype;
 			unit->Active = 0;
 			unit->Removed = 0;
 			Assert(UnitNumber(*unit) == slot);
@@ -396,7 +397,7 @@ static int CclUnit(lua_State *l)
 			unit->Offset = Map.getIndex(unit->tilePos);
 		} else if (!strcmp(value, "seen-tile")) {
 			lua_rawgeti(l, 2, j + 1);
-			CclGetPos(l, &unit->Seen.tilePos.x , &unit->Seen.tilePos.y, -1);
+			CclGetPos(l, &unit->Cold->Seen.tilePos.x , &unit->Cold->Seen.tilePos.y, -1);
 			lua_pop(l, 1);
 		} else if (!strcmp(value, "stats")) {
 			unit->Stats = &type->Stats[LuaToNumber(l, 2, j + 1)];
@@ -406,14 +407,14 @@ static int CclUnit(lua_State *l)
 			lua_pop(l, 1);
 		} else if (!strcmp(value, "seen-pixel")) {
 			lua_rawgeti(l, 2, j + 1);
-			CclGetPos(l, &unit->Seen.IX , &unit->Seen.IY, -1);
+			CclGetPos(l, &unit->Cold->Seen.IX , &unit->Cold->Seen.IY, -1);
 			lua_pop(l, 1);
 		} else if (!strcmp(value, "frame")) {
 			unit->Frame = LuaToNumber(l, 2, j + 1);
 		} else if (!strcmp(value, "seen")) {
-			unit->Seen.Frame = LuaToNumber(l, 2, j + 1);
+			unit->Cold->Seen.Frame = LuaToNumber(l, 2, j + 1);
 		} else if (!strcmp(value, "not-seen")) {
-			unit->Seen.Frame = UnitNotSeen;
+			unit->Cold->Seen.Frame = UnitNotSeen;
 			--j;
 		} else if (!strcmp(value, "direction")) {
 			unit->Direction = LuaToNumber(l, 2, j + 1);
@@ -450,32 +451,32 @@ static int CclUnit(lua_State *l)
 			unit->RescuedFrom = &Players[LuaToNumber(l, 2, j + 1)];
 		} else if (!strcmp(value, "seen-by-player")) {
 			const char *s = LuaToString(l, 2, j + 1);
-			unit->Seen.ByPlayer = 0;
+			unit->Cold->Seen.ByPlayer = 0;
 			for (int i = 0; i < PlayerMax && *s; ++i, ++s) {
 				if (*s == '-' || *s == '_' || *s == ' ') {
-					unit->Seen.ByPlayer &= ~(1 << i);
+					unit->Cold->Seen.ByPlayer &= ~(1 << i);
 				} else {
-					unit->Seen.ByPlayer |= (1 << i);
+					unit->Cold->Seen.ByPlayer |= (1 << i);
 				}
 			}
 		} else if (!strcmp(value, "seen-destroyed")) {
 			const char *s = LuaToString(l, 2, j + 1);
-			unit->Seen.Destroyed = 0;
+			unit->Cold->Seen.Destroyed = 0;
 			for (int i = 0; i < PlayerMax && *s; ++i, ++s) {
 				if (*s == '-' || *s == '_' || *s == ' ') {
-					unit->Seen.Destroyed &= ~(1 << i);
+					unit->Cold->Seen.Destroyed &= ~(1 << i);
 				} else {
-					unit->Seen.Destroyed |= (1 << i);
+					unit->Cold->Seen.Destroyed |= (1 << i);
 				}
 			}
 		} else if (!strcmp(value, "constructed")) {
 			unit->Constructed = 1;
 			--j;
 		} else if (!strcmp(value, "seen-constructed")) {
-			unit->Seen.Constructed = 1;
+			unit->Cold->Seen.Constructed = 1;
 			--j;
 		} else if (!strcmp(value, "seen-state")) {
-			unit->Seen.State = LuaToNumber(l, 2, j + 1);
+			unit->Cold->Seen.State = LuaToNumber(l, 2, j + 1);
 		} else if (!strcmp(value, "active")) {
 			unit->Active = 1;
 			--j;
@@ -576,6 +577,7 @@ static int CclUnit(lua_State *l)
 				DebugPrint("HACK: the building is not ready yet\n");
 				// HACK: the building is not ready yet
 				unit->Player->UnitTypesCount[type->Slot]--;
+				DependUnitTypeCountChanged(*unit->Player, *type);
 				if (unit->Active) {
 					unit->Player->UnitTypesAiActiveCount[type->Slot]--;
 				}
@@ -1292,7 +1294,7 @@ static int CclGetUnitVariable(lua_State *l)
 		LuaCheckArgs(l, 3);
 		std::string upgrade_ident = LuaToString(l, 3);
 		if (CUpgrade::Get(upgrade_ident)) {
-			lua_pushboolean(l, unit->IndividualUpgrades[CUpgrade::Get(upgrade_ident)->ID]);
+			lua_pushboolean(l, unit->Cold->IndividualUpgrades[CUpgrade::Get(upgrade_ident)->ID]);
 		} else {
 			LuaError(l, "Individual upgrade \"%s\" doesn't exist." _C_ upgrade_ident.c_str());
 		}
@@ -1414,9 +1416,9 @@ static int CclSetUnitVariable(lua_State *l)
 		std::string upgrade_ident = LuaToString(l, 3);
 		bool has_upgrade = LuaToBoolean(l, 4);
 		if (CUpgrade::Get(upgrade_ident)) {
-			if (has_upgrade && unit->IndividualUpgrades[CUpgrade::Get(upgrade_ident)->ID] == false) {
+			if (has_upgrade && unit->Cold->IndividualUpgrades[CUpgrade::Get(upgrade_ident)->ID] == false) {
 				IndividualUpgradeAcquire(*unit, CUpgrade::Get(upgrade_ident));
-			} else if (!has_upgrade && unit->IndividualUpgrades[CUpgrade::Get(upgrade_ident)->ID]) {
+			} else if (!has_upgrade && unit->Cold->IndividualUpgrades[CUpgrade::Get(upgrade_ident)->ID]) {
 				IndividualUpgradeLost(*unit, CUpgrade::Get(upgrade_ident));
 			}
 		} else {
@@ -44,6 +44,8 @@
 #include "animation.h"
 #include "commands.h"
 #include "construct.h"
+#include "depend.h"
+#include "distancefield.h"
 #include "game.h"
 #include "editor.h"
 #include "interface.h"
@@ -223,7 +225,7 @@
 **
 **  If Burning is non-zero, the unit is burning.
 **
-**  CUnit::VisCount[PlayerMax]
+**  CUnitColdData::VisCount[PlayerMax]
 **
 **              Used to keep track of visible units on the map, it counts the
 **              Number of seen tiles for each player. This is only modified
@@ -432,7 +434,6 @@ void CUnit::Init()
 
 	Frame = 0;
 	Colors = -1;
-	memset(IndividualUpgrades, 0, sizeof(IndividualUpgrades));
 	IX = 0;
 	IY = 0;
 	Direction = 0;
@@ -458,8 +459,9 @@ void CUnit::Init()
 	ZDisplaced = 0;
 	TeamSelected = 0;
 	RescuedFrom = NULL;
-	memset(VisCount, 0, sizeof(VisCount));
-	memset(&Seen, 0, sizeof(Seen));
+	if (Cold) {
+		Cold->Init();
+	}
 	delete Variable;
 	Variable = NULL;
 	TTL = 0;
@@ -493,6 +495,16 @@ CUnit::~CUnit() {
 	delete[] Variable;
 }
 
+/**
+**  Reset the rarely used unit data.
+*/
+void CUnitColdData::Init()
+{
+	IndividualUpgrades.reset();
+	memset(VisCount, 0, sizeof(VisCount));
+	memset(&Seen, 0, sizeof(Seen));
+}
+
 /**
 **  Release an unit.
 **
@@ -635,7 +647,7 @@ void CUnit::Init(const CUnitType &type)
 	//  Initialise unit structure (must be zero filled!)
 	Type = &type;
 
-	Seen.Frame = UnitNotSeen; // Unit isn't yet seen
+	Cold->Seen.Frame = UnitNotSeen; // Unit isn't yet seen
 
 	Frame = type.StillFrame;
 
@@ -648,7 +660,7 @@ void CUnit::Init(const CUnitType &type)
 		Variable = NULL;
 	}
 
-	memset(IndividualUpgrades, 0, sizeof(IndividualUpgrades));
+	Cold->IndividualUpgrades.reset();
 
 	// Set a heading for the unit if it Handles Directions
 	// Don't set a building heading, as only 1 construction direction
@@ -759,7 +771,12 @@ void CUnit::AssignToPlayer(CPlayer &player)
 				player.TotalUnits++;
 			}
 		}
+		if (GameRunning) {
+			// Have the voice of a new unit type ready before it speaks
+			PrefetchUnitTypeSounds(type);
+		}
 		player.UnitTypesCount[type.Slot]++;
+		DependUnitTypeCountChanged(player, type);
 		if (Active) {
 			player.UnitTypesAiActiveCount[type.Slot]++;
 		}
@@ -1011,6 +1028,26 @@ void UpdateUnitSightRange(CUnit &unit)
 	}
 }
 
+/**
+**  Update the distance fields if the unit changes more than the unit
+**  flags of its tiles, as buildings do.
+**
+**  @param unit  unit which was marked or unmarked.
+*/
+static void UnitFieldFlagsChanged(const CUnit &unit)
+{
+	if ((unit.Type->FieldFlags & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit)) == 0) {
+		return;
+	}
+	const Vec2i end = unit.tilePos + Vec2i(unit.Type->TileWidth, unit.Type->TileHeight);
+
+	for (Vec2i pos(0, unit.tilePos.y); pos.y != end.y; ++pos.y) {
+		for (pos.x = unit.tilePos.x; pos.x != end.x; ++pos.x) {
+			DistanceFieldsTileChanged(pos);
+		}
+	}
+}
+
 /**
 **  Mark the field with the FieldFlags.
 **
@@ -1035,6 +1072,7 @@ void MarkUnitFieldFlags(const CUnit &unit)
 		} while (--w);
 		index += Map.Info.MapWidth;
 	} while (--h);
+	UnitFieldFlagsChanged(unit);
 }
 
 class _UnmarkUnitFieldFlags
@@ -1083,6 +1121,7 @@ void UnmarkUnitFieldFlags(const CUnit &unit)
 		} while (--w);
 		index += Map.Info.MapWidth;
 	} while (--h);
+	UnitFieldFlagsChanged(unit);
 }
 
 /**
@@ -1194,6 +1233,7 @@ void CUnit::MoveToXY(const Vec2i &pos)
 	//  Recalculate the seen count.
 	UnitCountSeen(*this);
 	MapMarkUnitSight(*this);
+	DistanceFieldsDepotChanged(*Type);
 }
 
 /**
@@ -1222,6 +1262,7 @@ void CUnit::Place(const Vec2i &pos)
 	UnitCountSeen(*this);
 	// Vision
 	MapMarkUnitSight(*this);
+	DistanceFieldsDepotChanged(*Type);
 
 	// Correct directions for wall units
 	if (this->Type->BoolFlag[WALL_INDEX].value && this->CurrentAction() != UnitActionBuilt) {
@@ -1329,6 +1370,7 @@ void CUnit::Remove(CUnit *host)
 	Map.Remove(*this);
 	MapUnmarkUnitSight(*this);
 	UnmarkUnitFieldFlags(*this);
+	DistanceFieldsDepotChanged(*Type);
 	if (host) {
 		AddInContainer(*host);
 		UpdateUnitSightRange(*this);
@@ -1401,6 +1443,7 @@ void UnitLost(CUnit &unit)
 		}
 		if (unit.CurrentAction() != UnitActionBuilt) {
 			player.UnitTypesCount[type.Slot]--;
+			DependUnitTypeCountChanged(player, type);
 			if (unit.Active) {
 				player.UnitTypesAiActiveCount[type.Slot]--;
 			}
@@ -1547,12 +1590,12 @@ void NearestOfUnit(const CUnit &unit, const Vec2i &pos, Vec2i *dpos)
 static void UnitFillSeenValues(CUnit &unit)
 {
 	// Seen values are undefined for visible units.
-	unit.Seen.tilePos = unit.tilePos;
-	unit.Seen.IY = unit.IY;
-	unit.Seen.IX = unit.IX;
-	unit.Seen.Frame = unit.Frame;
-	unit.Seen.Type = unit.Type;
-	unit.Seen.Constructed = unit.Constructed;
+	unit.Cold->Seen.tilePos = unit.tilePos;
+	unit.Cold->Seen.IY = unit.IY;
+	unit.Cold->Seen.IX = unit.IX;
+	unit.Cold->Seen.Frame = unit.Frame;
+	unit.Cold->Seen.Type = unit.Type;
+	unit.Cold->Seen.Constructed = unit.Constructed;
 
 	unit.CurrentOrder()->FillSeenValues(unit);
 }
@@ -1658,7 +1701,7 @@ void UnitGoesUnderFog(CUnit &unit, const CPlayer &player)
 		// it's sort of the whole point of this tracking.
 		//
 		if (unit.Destroyed) {
-			unit.Seen.Destroyed |= (1 << player.Index);
+			unit.Cold->Seen.Destroyed |= (1 << player.Index);
 		}
 		if (&player == ThisPlayer) {
 			UnitFillSeenValues(unit);
@@ -1684,12 +1727,12 @@ void UnitGoesOutOfFog(CUnit &unit, const CPlayer &player)
 	if (!unit.Type->BoolFlag[VISIBLEUNDERFOG_INDEX].value) {
 		return;
 	}
-	if (unit.Seen.ByPlayer & (1 << (player.Index))) {
-		if ((player.Type == PlayerTypes::PlayerPerson) && (!(unit.Seen.Destroyed & (1 << player.Index)))) {
+	if (unit.Cold->Seen.ByPlayer & (1 << (player.Index))) {
+		if ((player.Type == PlayerTypes::PlayerPerson) && (!(unit.Cold->Seen.Destroyed & (1 << player.Index)))) {
 			unit.RefsDecrease();
 		}
 	} else {
-		unit.Seen.ByPlayer |= (1 << (player.Index));
+		unit.Cold->Seen.ByPlayer |= (1 << (player.Index));
 	}
 }
 
@@ -1742,7 +1785,7 @@ void UnitCountSeen(CUnit &unit)
 				} while (--x);
 				index += Map.Info.MapWidth;
 			} while (--y);
-			unit.VisCount[p] = newv;
+			unit.Cold->VisCount[p] = newv;
 		}
 	}
 
@@ -1778,11 +1821,11 @@ void UnitCountSeen(CUnit &unit)
 */
 bool CUnit::IsVisible(const CPlayer &player) const
 {
-	if (this->VisCount[player.Index]) {
+	if (this->Cold->VisCount[player.Index]) {
 		return true;
 	}
 	for (const uint8_t p : player.GetSharedVision()) {
-		if (this->VisCount[p]) {
+		if (this->Cold->VisCount[p]) {
 			return true;
 		}
 	}
@@ -1809,9 +1852,9 @@ bool CUnit::IsVisibleOnMinimap() const
 			&& (CPlayer::RevelationFor == RevealTypes::cAllUnits || this->Type->BoolFlag[BUILDING_INDEX].value))) {
 		return IsAliveOnMap();
 	} else {
-		return Type->BoolFlag[VISIBLEUNDERFOG_INDEX].value && Seen.State != 3
-			   && (Seen.ByPlayer & (1 << ThisPlayer->Index))
-			   && !(Seen.Destroyed & (1 << ThisPlayer->Index));
+		return Type->BoolFlag[VISIBLEUNDERFOG_INDEX].value && Cold->Seen.State != 3
+			   && (Cold->Seen.ByPlayer & (1 << ThisPlayer->Index))
+			   && !(Cold->Seen.Destroyed & (1 << ThisPlayer->Index));
 	}
 }
 
@@ -1856,8 +1899,8 @@ bool CUnit::IsVisibleInViewport(const CViewport &vp) const
 	} else {
 		// Unit has to be 'discovered'
 		// Destroyed units ARE visible under fog of war, if we haven't seen them like that.
-		if (!Destroyed || !(Seen.Destroyed & (1 << ThisPlayer->Index))) {
-			return (Type->BoolFlag[VISIBLEUNDERFOG_INDEX].value && (Seen.ByPlayer & (1 << ThisPlayer->Index)));
+		if (!Destroyed || !(Cold->Seen.Destroyed & (1 << ThisPlayer->Index))) {
+			return (Type->BoolFlag[VISIBLEUNDERFOG_INDEX].value && (Cold->Seen.ByPlayer & (1 << ThisPlayer->Index)));
 		} else {
 			return false;
 		}
@@ -1908,6 +1951,7 @@ void CUnit::ChangeOwner(CPlayer &newplayer)
 	Stats = &Type->Stats[newplayer.Index];
 	UpdateUnitSightRange(*this);
 	MapMarkUnitSight(*this);
+	DistanceFieldsDepotChanged(*Type);
 
 	//  Must change food/gold and other.
 	if (Type->GivesResource) {
@@ -1925,13 +1969,14 @@ void CUnit::ChangeOwner(CPlayer &newplayer)
 		newplayer.NumBuildings++;
 	}
 	newplayer.UnitTypesCount[Type->Slot]++;
+	DependUnitTypeCountChanged(newplayer, *Type);
 	if (Active) {
 		newplayer.UnitTypesAiActiveCount[Type->Slot]++;
 	}
 
 	//apply the upgrades of the new player, if the old one doesn't have that upgrade
 	for (int z = 0; z < NumUpgradeModifiers; ++z) {
-		if (oldplayer->Allow.Upgrades[UpgradeModifiers[z]->UpgradeId] != 'R' && newplayer.Allow.Upgrades[UpgradeModifiers[z]->UpgradeId] == 'R' && UpgradeModifiers[z]->ApplyTo[Type->Slot] == 'X') { //if the old player doesn't have the modifier's upgrade, and the upgrade is applicable to the unit
+		if (oldplayer->Allow.Upgrades[UpgradeModifiers[z]->UpgradeId] != 'R' && newplayer.Allow.Upgrades[UpgradeModifiers[z]->UpgradeId] == 'R' && UpgradeModifiers[z]->AppliesTo(Type->Slot)) { //if the old player doesn't have the modifier's upgrade, and the upgrade is applicable to the unit
 			ApplyIndividualUpgradeModifier(*this, UpgradeModifiers[z]); //apply the upgrade to this unit only
 		}
 	}
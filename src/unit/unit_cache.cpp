@@ -40,9 +40,11 @@
 #include <string.h>
 
 #include "stratagus.h"
+#include "game.h"
 #include "unit.h"
 #include "unittype.h"
 #include "map.h"
+#include "player.h"
 
 /**
 **  Insert new unit into cache.
@@ -66,6 +68,85 @@ void CMap::Insert(CUnit &unit)
 		} while (--j && unit.tilePos.x + (j - w) < Info.MapWidth);
 		index += Info.MapWidth;
 	} while (--i && unit.tilePos.y + (i - h) < Info.MapHeight);
+
+	// Note the entry for the idle units which wait for enemies.
+	// The entries of a loaded game are restored from the save.
+	if (SectorEntryCycles.empty() || SaveGameLoading) {
+		return;
+	}
+	const int sectorWidth = (Info.MapWidth + (1 << MapSectorShift) - 1) >> MapSectorShift;
+	const int minX = unit.tilePos.x >> MapSectorShift;
+	const int minY = unit.tilePos.y >> MapSectorShift;
+	const int maxX = (std::min(unit.tilePos.x + w, Info.MapWidth) - 1) >> MapSectorShift;
+	const int maxY = (std::min(unit.tilePos.y + h, Info.MapHeight) - 1) >> MapSectorShift;
+
+	for (int y = minY; y <= maxY; ++y) {
+		for (int x = minX; x <= maxX; ++x) {
+			SectorEntryCycles[(x + y * sectorWidth) * PlayerMax + unit.Player->Index] = GameCycle;
+		}
+	}
+}
+
+/**
+**  Check if a unit of some players entered an area.
+**
+**  The area is rounded to sectors of 8x8 tiles, so the answer can be
+**  true for units just outside of it.
+**
+**  @param minPos      Top left tile of the area.
+**  @param maxPos      Bottom right tile of the area.
+**  @param playerMask  Bit mask of the player indexes.
+**  @param cycle       Entries at or after this game cycle are counted.
+**
+**  @return            True if such a unit may have entered the area.
+*/
+bool CMap::HasUnitEnteredSince(const Vec2i &minPos, const Vec2i &maxPos, unsigned int playerMask, unsigned long cycle) const
+{
+	if (SectorEntryCycles.empty()) {
+		return true;
+	}
+	const int sectorWidth = (Info.MapWidth + (1 << MapSectorShift) - 1) >> MapSectorShift;
+	const int minX = std::max<int>(0, minPos.x) >> MapSectorShift;
+	const int minY = std::max<int>(0, minPos.y) >> MapSectorShift;
+	const int maxX = std::min<int>(Info.MapWidth - 1, maxPos.x) >> MapSectorShift;
+	const int maxY = std::min<int>(Info.MapHeight - 1, maxPos.y) >> MapSectorShift;
+
+	for (int y = minY; y <= maxY; ++y) {
+		for (int x = minX; x <= maxX; ++x) {
+			const unsigned long *entries = &SectorEntryCycles[(x + y * sectorWidth) * PlayerMax];
+
+			for (int p = 0; p != PlayerMax; ++p) {
+				if ((playerMask & (1 << p)) && entries[p] >= cycle) {
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+/**
+**  Forget the unit entries, sized for the map.
+*/
+void CMap::ResetSectorEntryCycles()
+{
+	const int sectorWidth = (Info.MapWidth + (1 << MapSectorShift) - 1) >> MapSectorShift;
+	const int sectorHeight = (Info.MapHeight + (1 << MapSectorShift) - 1) >> MapSectorShift;
+
+	SectorEntryCycles.assign(sectorWidth * sectorHeight * PlayerMax, 0);
+}
+
+/**
+**  Restore a unit entry of a saved game.
+**
+**  @param index  Index of the entry, sector * PlayerMax + player.
+**  @param cycle  Last game cycle a unit of the player entered the sector.
+*/
+void CMap::SetSectorEntryCycle(unsigned int index, unsigned long cycle)
+{
+	if (index < SectorEntryCycles.size()) {
+		SectorEntryCycles[index] = cycle;
+	}
 }
 
 /**
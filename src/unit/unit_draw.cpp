@@ -34,6 +34,7 @@
 --  Includes
 ----------------------------------------------------------------------------*/
 
+#include <algorithm>
 #include <vector>
 
 #include "stratagus.h"
@@ -707,9 +708,9 @@ void DrawShadow(const CUnitType &type, int frame, const PixelPos &screenPos, cha
 		// the shadow is a full unit shadow
 		if (type.Flip) {
 			if (frame < 0) {
-				type.ShadowSprite->DrawFrameClipX(-frame - 1, pos.x, pos.y);
+				type.ShadowSprite->DrawShadowFrameClipX(-frame - 1, pos.x, pos.y);
 			} else {
-				type.ShadowSprite->DrawFrameClip(frame, pos.x, pos.y);
+				type.ShadowSprite->DrawShadowFrameClip(frame, pos.x, pos.y);
 			}
 		} else {
 			int row = type.NumDirections / 2 + 1;
@@ -718,11 +719,11 @@ void DrawShadow(const CUnitType &type, int frame, const PixelPos &screenPos, cha
 			} else {
 				frame = (frame / row) * type.NumDirections + frame % row;
 			}
-			type.ShadowSprite->DrawFrameClip(frame, pos.x, pos.y);
+			type.ShadowSprite->DrawShadowFrameClip(frame, pos.x, pos.y);
 		}
 	} else {
 		// the shadow is a simple sprite without directions, like in WC2
-		type.ShadowSprite->DrawFrameClip(type.ShadowSpriteFrame - 1, pos.x, pos.y);
+		type.ShadowSprite->DrawShadowFrameClip(type.ShadowSpriteFrame - 1, pos.x, pos.y);
 	}
 }
 
@@ -779,9 +780,9 @@ static void DrawInformations(const CUnit &unit, const CUnitType &type, const Pix
 {
 #if 0 && DEBUG // This is for showing vis counts and refs.
 	char buf[10];
-	sprintf(buf, "%d%c%c%d", unit.VisCount[ThisPlayer->Index],
-			unit.Seen.ByPlayer & (1 << ThisPlayer->Index) ? 'Y' : 'N',
-			unit.Seen.Destroyed & (1 << ThisPlayer->Index) ? 'Y' : 'N',
+	sprintf(buf, "%d%c%c%d", unit.Cold->VisCount[ThisPlayer->Index],
+			unit.Cold->Seen.ByPlayer & (1 << ThisPlayer->Index) ? 'Y' : 'N',
+			unit.Cold->Seen.Destroyed & (1 << ThisPlayer->Index) ? 'Y' : 'N',
 			unit.Refs);
 	CLabel(GetSmallFont()).Draw(screenPos.x + 10, screenPos.y + 10, buf);
 #endif
@@ -850,9 +851,9 @@ static void DrawConstructionShadow(const CUnitType &type, const CConstructionFra
 			pos.y -= (type.Construction->Height - type.TileHeight * PixelTileSize.y) / 2;
 			pos.y += type.OffsetY;
 			if (frame < 0) {
-				type.Construction->ShadowSprite->DrawFrameClipX(-frame - 1, pos.x, pos.y);
+				type.Construction->ShadowSprite->DrawShadowFrameClipX(-frame - 1, pos.x, pos.y);
 			} else {
-				type.Construction->ShadowSprite->DrawFrameClip(frame, pos.x, pos.y);
+				type.Construction->ShadowSprite->DrawShadowFrameClip(frame, pos.x, pos.y);
 			}
 		}
 	} else {
@@ -862,9 +863,9 @@ static void DrawConstructionShadow(const CUnitType &type, const CConstructionFra
 			pos.y -= (type.ShadowHeight - type.TileHeight * PixelTileSize.y) / 2;
 			pos.y += type.ShadowOffsetY + type.OffsetY;
 			if (frame < 0) {
-				type.ShadowSprite->DrawFrameClipX(-frame - 1, pos.x, pos.y);
+				type.ShadowSprite->DrawShadowFrameClipX(-frame - 1, pos.x, pos.y);
 			} else {
-				type.ShadowSprite->DrawFrameClip(frame, pos.x, pos.y);
+				type.ShadowSprite->DrawShadowFrameClip(frame, pos.x, pos.y);
 			}
 		}
 	}
@@ -955,15 +956,15 @@ void CUnit::Draw(const CViewport &vp) const
 			cframe = NULL;
 		}
 	} else {
-		screenPos = vp.TilePosToScreen_TopLeft(this->Seen.tilePos);
-
-		screenPos.x += this->Seen.IX;
-		screenPos.y += this->Seen.IY;
-		frame = this->Seen.Frame;
-		type = this->Seen.Type;
-		constructed = this->Seen.Constructed;
-		state = this->Seen.State;
-		cframe = this->Seen.CFrame;
+		screenPos = vp.TilePosToScreen_TopLeft(this->Cold->Seen.tilePos);
+
+		screenPos.x += this->Cold->Seen.IX;
+		screenPos.y += this->Cold->Seen.IY;
+		frame = this->Cold->Seen.Frame;
+		type = this->Cold->Seen.Type;
+		constructed = this->Cold->Seen.Constructed;
+		state = this->Cold->Seen.State;
+		cframe = this->Cold->Seen.CFrame;
 	}
 
 #ifdef DYNAMIC_LOAD
@@ -1065,8 +1066,13 @@ static inline bool DrawLevelCompare(const CUnit *c1, const CUnit *c2)
 /**
 **  Find all units to draw in viewport.
 **
+**  The units of the previous frame keep their order, and most of them
+**  are still sorted: an insertion sort repairs it in near linear time.
+**  The new units are sorted apart and merged in.
+**
 **  @param vp     Viewport to be drawn.
-**  @param table  Table of units to return in sorted order
+**  @param table  In: units of the previous frame in sorted order,
+**                out: table of units to return in sorted order.
 **
 */
 int FindAndSortUnits(const CViewport &vp, std::vector<CUnit *> &table)
@@ -1076,18 +1082,49 @@ int FindAndSortUnits(const CViewport &vp, std::vector<CUnit *> &table)
 	const Vec2i vpSize(vp.MapWidth, vp.MapHeight);
 	const Vec2i minPos = vp.MapPos - offset;
 	const Vec2i maxPos = vp.MapPos + vpSize + offset;
+	std::vector<CUnit *> visible;
+
+	Select(minPos, maxPos, visible);
+
+	size_t n = visible.size();
+	for (size_t i = 0; i < visible.size(); ++i) {
+		if (!visible[i]->IsVisibleInViewport(vp)) {
+			visible[i--] = visible[--n];
+			visible.pop_back();
+		} else {
+			visible[i]->CacheLock = 1;
+		}
+	}
+	Assert(n == visible.size());
+
+	// Keep the units of the previous frame which are still visible.
+	size_t kept = 0;
+	for (size_t i = 0; i != table.size(); ++i) {
+		if (table[i]->CacheLock) {
+			table[i]->CacheLock = 0;
+			table[kept++] = table[i];
+		}
+	}
+	table.resize(kept);
+	for (size_t i = 1; i < kept; ++i) {
+		CUnit *unit = table[i];
+		size_t j = i;
 
-	Select(minPos, maxPos, table);
+		for (; j != 0 && DrawLevelCompare(unit, table[j - 1]); --j) {
+			table[j] = table[j - 1];
+		}
+		table[j] = unit;
+	}
 
-	size_t n = table.size();
-	for (size_t i = 0; i < table.size(); ++i) {
-		if (!table[i]->IsVisibleInViewport(vp)) {
-			table[i--] = table[--n];
-			table.pop_back();
+	// Add the new ones.
+	for (size_t i = 0; i != n; ++i) {
+		if (visible[i]->CacheLock) {
+			visible[i]->CacheLock = 0;
+			table.push_back(visible[i]);
 		}
 	}
-	Assert(n == table.size());
-	std::sort(table.begin(), table.begin() + n, DrawLevelCompare);
+	std::sort(table.begin() + kept, table.end(), DrawLevelCompare);
+	std::inplace_merge(table.begin(), table.begin() + kept, table.end(), DrawLevelCompare);
 	return n;
 }
 
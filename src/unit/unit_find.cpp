@@ -40,6 +40,7 @@
 #include "unit_find.h"
 
 #include "actions.h"
+#include "distancefield.h"
 #include "map.h"
 #include "missile.h"
 #include "pathfinder.h"
@@ -105,43 +106,6 @@ VisitResult UnitFinder::Visit(TerrainTraversal &terrainTraversal, const Vec2i &p
 	}
 }
 
-class TerrainFinder
-{
-public:
-	TerrainFinder(const CPlayer &player, int maxDist, int movemask, int resmask, Vec2i *resPos) :
-		player(player), maxDist(maxDist), movemask(movemask), resmask(resmask), resPos(resPos) {}
-	VisitResult Visit(TerrainTraversal &terrainTraversal, const Vec2i &pos, const Vec2i &from);
-private:
-	const CPlayer &player;
-	int maxDist;
-	int movemask;
-	int resmask;
-	Vec2i *resPos;
-};
-
-VisitResult TerrainFinder::Visit(TerrainTraversal &terrainTraversal, const Vec2i &pos, const Vec2i &from)
-{
-	if (!player.AiEnabled && !Map.Field(pos)->playerInfo.IsExplored(player)) {
-		return VisitResult_DeadEnd;
-	}
-	// Look if found what was required.
-	if (Map.Field(pos)->CheckMask(resmask)) {
-		if (resPos) {
-			*resPos = pos;
-		}
-		return VisitResult_Finished;
-	}
-	if (CanMoveToMask(pos, movemask)) { // reachable
-		if (terrainTraversal.Get(pos) <= maxDist) {
-			return VisitResult_Ok;
-		} else {
-			return VisitResult_DeadEnd;
-		}
-	} else { // unreachable
-		return VisitResult_DeadEnd;
-	}
-}
-
 /**
 **  Find the closest piece of terrain with the given flags.
 **
@@ -156,26 +120,19 @@ VisitResult TerrainFinder::Visit(TerrainTraversal &terrainTraversal, const Vec2i
 **  @note Movement mask can be 0xFFFFFFFF to have no effect
 **  Range is not circular, but square.
 **  Player is ignored if nil(search the entire map)
+**  The tile is the nearest one of the player distance field, see
+**  DistanceFieldFindTerrain.
 **
 **  @return            True if wood was found.
 */
 bool FindTerrainType(int movemask, int resmask, int range,
 					 const CPlayer &player, const Vec2i &startPos, Vec2i *terrainPos)
 {
-	TerrainTraversal terrainTraversal;
-
-	terrainTraversal.SetSize(Map.Info.MapWidth, Map.Info.MapHeight);
-	terrainTraversal.Init();
-
-	terrainTraversal.PushPos(startPos);
-
-	TerrainFinder terrainFinder(player, range, movemask & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit), resmask, terrainPos);
-
-	return terrainTraversal.Run(terrainFinder);
+	return DistanceFieldFindTerrain(player, movemask & ~(MapFieldLandUnit | MapFieldAirUnit | MapFieldSeaUnit), resmask, range,
+									startPos, terrainPos);
 }
 
 
-template <const bool NEARLOCATION>
 class BestDepotFinder
 {
 	void operator()(CUnit *const dest)
@@ -185,58 +142,22 @@ class BestDepotFinder
 			&& dest->IsAliveOnMap()
 			&& dest->CurrentAction() != UnitActionBuilt) {
 			// Unit in range?
-
-			if constexpr (NEARLOCATION) {
-				const int d = dest->MapDistanceTo(u_near.loc);
-
-				//
-				// Take this depot?
-				//
-				if (d <= this->range && d < this->best_dist) {
-					this->best_depot = dest;
-					this->best_dist = d;
-				}
-			} else {
-				const CUnit *worker = this->u_near.worker;
-				const CUnit *first_container = GetFirstContainer(*worker);
-
-				//simple distance
-				const int distance = first_container->MapDistanceTo(*dest);
-
-				// Use Circle, not square :)
-				if (distance > this->range) {
-					return;
-				}
-
-				if (distance >= this->best_dist) {
-					//if the depot's simple distance is greater or equal to the real travel distance of the currently-chosen depot, then it can never be closer than it, and we have no reason to actually calculate its real travel distance 
-					return;
-				}
-
-				// calc real travel distance
-				const int travel_distance = UnitReachable(*worker, *dest, 1, worker->Container != nullptr);
-				//
-				// Take this depot?
-				//
-				if (travel_distance && travel_distance < this->best_dist) {
-					this->best_depot = dest;
-					this->best_dist = travel_distance;
-				}
+			const int d = dest->MapDistanceTo(loc);
+
+			//
+			// Take this depot?
+			//
+			if (d <= this->range && d < this->best_dist) {
+				this->best_depot = dest;
+				this->best_dist = d;
 			}
 		}
 	}
 
 public:
-	explicit BestDepotFinder(const CUnit &w, const int res, const int ran)
-		: resource(res), range(ran)
-	{
-		u_near.worker = &w;
-	}
-
 	explicit BestDepotFinder(const Vec2i &pos, const int res, const int ran) :
-		resource(res), range(ran)
+		loc(pos), resource(res), range(ran)
 	{
-		u_near.loc = pos;
 	}
 
 	template <typename ITERATOR>
@@ -247,17 +168,8 @@ public:
 		}
 		return best_depot;
 	}
-
-	CUnit *Find(CUnitCache &cache)
-	{
-		cache.for_each(*this);
-		return best_depot;
-	}
 private:
-	struct {
-		const CUnit *worker;
-		Vec2i loc;
-	} u_near;
+	const Vec2i loc;
 	const int resource;
 	const int range;
 	int best_dist = INT_MAX;
@@ -267,7 +179,7 @@ public:
 
 CUnit *FindDepositNearLoc(CPlayer &p, const Vec2i &pos, int range, int resource)
 {
-	BestDepotFinder<true> finder(pos, resource, range);
+	BestDepotFinder finder(pos, resource, range);
 	std::vector<CUnit *> table;
 	for (std::vector<CUnit *>::iterator it = p.UnitBegin(); it != p.UnitEnd(); ++it) {
 		table.push_back(*it);
@@ -431,6 +343,7 @@ CUnit *UnitFindResource(const CUnit &unit, const CUnit &startUnit, int range, in
 
 	terrainTraversal.SetSize(Map.Info.MapWidth, Map.Info.MapHeight);
 	terrainTraversal.Init();
+	terrainTraversal.SetWindowAround(startUnit, range);
 
 	terrainTraversal.PushUnitPosAndNeighboor(startUnit);
 
@@ -449,27 +362,14 @@ CUnit *UnitFindResource(const CUnit &unit, const CUnit &startUnit, int range, in
 **  @param range       Maximum distance to the deposit.
 **  @param resource    Resource to find deposit from.
 **
-**  @note This will return a reachable allied depot.
+**  @note This will return a reachable allied depot, the nearest one
+**  in steps of the player deposit distance field.
 **
 **  @return            NULL or deposit unit
 */
 CUnit *FindDeposit(const CUnit &unit, int range, int resource)
 {
-	BestDepotFinder<false> finder(unit, resource, range);
-	std::vector<CUnit *> table;
-	for (std::vector<CUnit *>::iterator it = unit.Player->UnitBegin(); it != unit.Player->UnitEnd(); ++it) {
-		table.push_back(*it);
-	}
-	if (GameSettings.AllyDepositsAllowed) {
-		for (int i = 0; i < PlayerMax - 1; ++i) {
-			if (Players[i].IsAllied(*unit.Player) && unit.Player->IsAllied(Players[i])) {
-				for (std::vector<CUnit *>::iterator it = Players[i].UnitBegin(); it != Players[i].UnitEnd(); ++it) {
-					table.push_back(*it);
-				}
-			}
-		}
-	}
-	return finder.Find(table.begin(), table.end());
+	return DistanceFieldFindDeposit(unit, range, resource);
 }
 
 /**
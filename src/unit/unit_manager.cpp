@@ -35,6 +35,8 @@
 
 #include "stratagus.h"
 
+#include <new>
+
 #include "unit_manager.h"
 #include "unit.h"
 #include "iolib.h"
@@ -47,6 +49,9 @@
 
 CUnitManager *UnitManager;          /// Unit manager
 
+/// Number of units allocated together
+static const size_t UnitBlockSize = 256;
+
 /*----------------------------------------------------------------------------
 --  Functions
 ----------------------------------------------------------------------------*/
@@ -55,6 +60,11 @@ CUnitManager::CUnitManager() : lastCreated(NULL)
 {
 }
 
+CUnitManager::~CUnitManager()
+{
+	FreeSlotUnits();
+}
+
 /**
 **  Initial memory allocation for units.
 */
@@ -63,15 +73,51 @@ void CUnitManager::Init()
 	lastCreated = NULL;
 	//Assert(units.empty());
 	units.clear();
-	// Release memory of units in release list.
-	while (!releasedUnits.empty()) {
-		CUnit *unit = releasedUnits.front();
-		releasedUnits.pop_front();
-		delete unit;
-	}
+	releasedUnits.clear();
 
 	// Initialize the free unit slots
+	FreeSlotUnits();
+}
+
+/**
+**  Create the unit of a new slot.
+**
+**  Units are stored by blocks in slot order, so that the per cycle loops
+**  walk through contiguous memory. Their rarely used data goes to the
+**  parallel cold blocks.
+**
+**  @return  New unit
+*/
+CUnit *CUnitManager::NewSlotUnit()
+{
+	const size_t slot = unitSlots.size();
+
+	if (slot % UnitBlockSize == 0) {
+		unitBlocks.push_back(static_cast<CUnit *>(::operator new(UnitBlockSize * sizeof(CUnit))));
+		coldBlocks.push_back(new CUnitColdData[UnitBlockSize]);
+	}
+	CUnit *unit = new (unitBlocks.back() + slot % UnitBlockSize) CUnit(coldBlocks.back() + slot % UnitBlockSize);
+
+	unit->UnitManagerData.slot = slot;
+	unitSlots.push_back(unit);
+	return unit;
+}
+
+/**
+**  Destroy the units of all the slots and free their blocks.
+*/
+void CUnitManager::FreeSlotUnits()
+{
+	for (std::vector<CUnit *>::iterator it = unitSlots.begin(); it != unitSlots.end(); ++it) {
+		(*it)->~CUnit();
+	}
 	unitSlots.clear();
+	for (size_t i = 0; i != unitBlocks.size(); ++i) {
+		::operator delete(unitBlocks[i]);
+		delete[] coldBlocks[i];
+	}
+	unitBlocks.clear();
+	coldBlocks.clear();
 }
 
 /**
@@ -91,11 +137,7 @@ CUnit *CUnitManager::AllocUnit()
 		unit->UnitManagerData.unitSlot = -1;
 		return unit;
 	} else {
-		CUnit *unit = new CUnit;
-
-		unit->UnitManagerData.slot = unitSlots.size();
-		unitSlots.push_back(unit);
-		return unit;
+		return NewSlotUnit();
 	}
 }
 
@@ -195,9 +237,7 @@ void CUnitManager::Load(lua_State *l)
 		LuaError(l, "incorrect argument");
 	}
 	for (unsigned int i = 0; i < unitCount; i++) {
-		CUnit *unit = new CUnit;
-		unitSlots.push_back(unit);
-		unit->UnitManagerData.slot = i;
+		NewSlotUnit();
 	}
 	const unsigned int args = lua_rawlen(l, 2);
 	for (unsigned int i = 0; i < args; i++) {
@@ -127,14 +127,14 @@ void SaveUnit(const CUnit &unit, CFile &file)
 
 	// 'type and 'player must be first, needed to create the unit slot
 	file.printf("\"type\", \"%s\", ", unit.Type->Ident.c_str());
-	if (unit.Seen.Type) {
-		file.printf("\"seen-type\", \"%s\", ", unit.Seen.Type->Ident.c_str());
+	if (unit.Cold->Seen.Type) {
+		file.printf("\"seen-type\", \"%s\", ", unit.Cold->Seen.Type->Ident.c_str());
 	}
 
 	file.printf("\"player\", %d,\n  ", unit.Player->Index);
 
 	file.printf("\"tile\", {%d, %d}, ", unit.tilePos.x, unit.tilePos.y);
-	file.printf("\"seen-tile\", {%d, %d}, ", unit.Seen.tilePos.x, unit.Seen.tilePos.y);
+	file.printf("\"seen-tile\", {%d, %d}, ", unit.Cold->Seen.tilePos.x, unit.Cold->Seen.tilePos.y);
 
 	file.printf("\"refs\", %d, ", unit.Refs);
 #if 0
@@ -154,10 +154,10 @@ void SaveUnit(const CUnit &unit, CFile &file)
 	file.printf("\"stats\", %d,\n  ", unit.Player->Index);
 #endif
 	file.printf("\"pixel\", {%d, %d}, ", unit.IX, unit.IY);
-	file.printf("\"seen-pixel\", {%d, %d}, ", unit.Seen.IX, unit.Seen.IY);
+	file.printf("\"seen-pixel\", {%d, %d}, ", unit.Cold->Seen.IX, unit.Cold->Seen.IY);
 	file.printf("\"frame\", %d, ", unit.Frame);
-	if (unit.Seen.Frame != UnitNotSeen) {
-		file.printf("\"seen\", %d, ", unit.Seen.Frame);
+	if (unit.Cold->Seen.Frame != UnitNotSeen) {
+		file.printf("\"seen\", %d, ", unit.Cold->Seen.Frame);
 	} else {
 		file.printf("\"not-seen\", ");
 	}
@@ -201,21 +201,21 @@ void SaveUnit(const CUnit &unit, CFile &file)
 	}
 	file.printf(" \"seen-by-player\", \"");
 	for (int i = 0; i < PlayerMax; ++i) {
-		file.printf("%c", (unit.Seen.ByPlayer & (1 << i)) ? 'X' : '_');
+		file.printf("%c", (unit.Cold->Seen.ByPlayer & (1 << i)) ? 'X' : '_');
 	}
 	file.printf("\",\n ");
 	file.printf(" \"seen-destroyed\", \"");
 	for (int i = 0; i < PlayerMax; ++i) {
-		file.printf("%c", (unit.Seen.Destroyed & (1 << i)) ? 'X' : '_');
+		file.printf("%c", (unit.Cold->Seen.Destroyed & (1 << i)) ? 'X' : '_');
 	}
 	file.printf("\",\n ");
 	if (unit.Constructed) {
 		file.printf(" \"constructed\",");
 	}
-	if (unit.Seen.Constructed) {
+	if (unit.Cold->Seen.Constructed) {
 		file.printf(" \"seen-constructed\",");
 	}
-	file.printf(" \"seen-state\", %d, ", unit.Seen.State);
+	file.printf(" \"seen-state\", %d, ", unit.Cold->Seen.State);
 	if (unit.Active) {
 		file.printf(" \"active\",");
 	}
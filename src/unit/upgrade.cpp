@@ -240,6 +240,31 @@ void SaveUpgrades(CFile &file)
 --  Ccl part of upgrades
 ----------------------------------------------------------------------------*/
 
+/**
+**  Set the change of an upgrade modifier for one unit-type or upgrade.
+**
+**  Entries are kept sorted by index, a later definition replaces the
+**  previous one.
+**
+**  @param changes  Sparse list of (index, value) changes.
+**  @param index    Unit-type slot or upgrade id.
+**  @param value    New value for this index.
+*/
+template <typename T>
+static void SetModifierChange(std::vector<std::pair<int, T>> &changes, int index, T value)
+{
+	typename std::vector<std::pair<int, T>>::iterator it = changes.begin();
+
+	while (it != changes.end() && it->first < index) {
+		++it;
+	}
+	if (it != changes.end() && it->first == index) {
+		it->second = value;
+	} else {
+		changes.insert(it, std::make_pair(index, value));
+	}
+}
+
 /**
 **  Define a new upgrade modifier.
 **
@@ -251,8 +276,6 @@ static int CclDefineModifier(lua_State *l)
 
 	CUpgradeModifier *um = new CUpgradeModifier;
 
-	memset(um->ChangeUpgrades, '?', sizeof(um->ChangeUpgrades));
-	memset(um->ApplyTo, '?', sizeof(um->ApplyTo));
 	um->Modifier.Variables = new CVariable[UnitTypeVar.GetNumberVariable()];
 	um->ModifyPercent = new int[UnitTypeVar.GetNumberVariable()];
 	memset(um->ModifyPercent, 0, UnitTypeVar.GetNumberVariable() * sizeof(int));
@@ -309,20 +332,24 @@ static int CclDefineModifier(lua_State *l)
 			const char *value = LuaToString(l, j + 1, 2);
 
 			if (!strncmp(value, "unit-", 5)) {
-				um->ChangeUnits[UnitTypeIdByIdent(value)] = LuaToNumber(l, j + 1, 3);
+				SetModifierChange(um->ChangeUnits, UnitTypeIdByIdent(value), (int)LuaToNumber(l, j + 1, 3));
 			} else {
 				LuaError(l, "unit expected");
 			}
 		} else if (!strcmp(key, "allow")) {
 			const char *value = LuaToString(l, j + 1, 2);
 			if (!strncmp(value, "upgrade-", 8)) {
-				um->ChangeUpgrades[UpgradeIdByIdent(value)] = LuaToNumber(l, j + 1, 3);
+				SetModifierChange(um->ChangeUpgrades, UpgradeIdByIdent(value), (char)LuaToNumber(l, j + 1, 3));
 			} else {
 				LuaError(l, "upgrade expected");
 			}
 		} else if (!strcmp(key, "apply-to")) {
 			const char *value = LuaToString(l, j + 1, 2);
-			um->ApplyTo[UnitTypeIdByIdent(value)] = 'X';
+			const int slot = UnitTypeIdByIdent(value);
+			std::vector<int>::iterator it = std::lower_bound(um->ApplyTo.begin(), um->ApplyTo.end(), slot);
+			if (it == um->ApplyTo.end() || *it != slot) {
+				um->ApplyTo.insert(it, slot);
+			}
 		} else if (!strcmp(key, "convert-to")) {
 			const char *value = LuaToString(l, j + 1, 2);
 			um->ConvertTo = UnitTypeByIdent(value);
@@ -533,156 +560,147 @@ static void ApplyUpgradeModifier(CPlayer &player, const CUpgradeModifier *um)
 
 	int pn = player.Index;
 
-	for (int z = 0; z < UpgradeMax; ++z) {
+	for (const std::pair<int, char> &change : um->ChangeUpgrades) {
+		const int z = change.first;
 		// allow/forbid upgrades for player.  only if upgrade is not acquired
 
 		// FIXME: check if modify is allowed
 
 		if (player.Allow.Upgrades[z] != 'R') {
-			if (um->ChangeUpgrades[z] == 'A') {
+			if (change.second == 'A') {
 				player.Allow.Upgrades[z] = 'A';
 			}
-			if (um->ChangeUpgrades[z] == 'F') {
+			if (change.second == 'F') {
 				player.Allow.Upgrades[z] = 'F';
 			}
 			// we can even have upgrade acquired w/o costs
-			if (um->ChangeUpgrades[z] == 'R') {
+			if (change.second == 'R') {
 				player.Allow.Upgrades[z] = 'R';
 			}
 		}
+		DependUpgradeChanged(player, z);
 	}
 
-	for (size_t z = 0; z < UnitTypes.size(); ++z) {
-		CUnitStats &stat = UnitTypes[z]->Stats[pn];
-		// add/remove allowed units
-
-		// FIXME: check if modify is allowed
-
-		player.Allow.Units[z] += um->ChangeUnits[z];
-
-		Assert(um->ApplyTo[z] == '?' || um->ApplyTo[z] == 'X');
-
-		// this modifier should be applied to unittype id == z
-		if (um->ApplyTo[z] == 'X') {
-
-			// If Sight range is upgraded, we need to change EVERY unit
-			// to the new range, otherwise the counters get confused.
-			if (um->Modifier.Variables[SIGHTRANGE_INDEX].Value) {
-				std::vector<CUnit *> unitupgrade;
+	// add/remove allowed units
+	// FIXME: check if modify is allowed
+	for (const std::pair<int, int> &change : um->ChangeUnits) {
+		player.Allow.Units[change.first] += change.second;
+	}
 
-				FindUnitsByType(*UnitTypes[z], unitupgrade);
-				for (size_t j = 0; j != unitupgrade.size(); ++j) {
-					CUnit &unit = *unitupgrade[j];
-					if (unit.Player->Index == pn && !unit.Removed) {
-						MapUnmarkUnitSight(unit);
-						unit.CurrentSightRange = stat.Variables[SIGHTRANGE_INDEX].Max +
-												 um->Modifier.Variables[SIGHTRANGE_INDEX].Value;
-						MapMarkUnitSight(unit);
-					}
+	// this modifier should be applied to unittype id == z
+	for (int z : um->ApplyTo) {
+		CUnitStats &stat = UnitTypes[z]->Stats[pn];
+		std::vector<CUnit *> unitupgrade;
+
+		FindPlayerUnitsByType(player, *UnitTypes[z], unitupgrade);
+
+		// If Sight range is upgraded, we need to change EVERY unit
+		// to the new range, otherwise the counters get confused.
+		if (um->Modifier.Variables[SIGHTRANGE_INDEX].Value) {
+			for (size_t j = 0; j != unitupgrade.size(); ++j) {
+				CUnit &unit = *unitupgrade[j];
+				if (!unit.Removed) {
+					MapUnmarkUnitSight(unit);
+					unit.CurrentSightRange = stat.Variables[SIGHTRANGE_INDEX].Max +
+											 um->Modifier.Variables[SIGHTRANGE_INDEX].Value;
+					MapMarkUnitSight(unit);
 				}
 			}
-			
-			// if a unit type's supply is changed, we need to update the player's supply accordingly
-			if (um->Modifier.Variables[SUPPLY_INDEX].Value) {
-				std::vector<CUnit *> unitupgrade;
-
-				FindUnitsByType(*UnitTypes[z], unitupgrade);
-				for (size_t j = 0; j != unitupgrade.size(); ++j) {
-					CUnit &unit = *unitupgrade[j];
-					if (unit.Player->Index == pn && unit.IsAlive()) {
-						unit.Player->Supply += um->Modifier.Variables[SUPPLY_INDEX].Value;
-					}
+		}
+		
+		// if a unit type's supply is changed, we need to update the player's supply accordingly
+		if (um->Modifier.Variables[SUPPLY_INDEX].Value) {
+			for (size_t j = 0; j != unitupgrade.size(); ++j) {
+				CUnit &unit = *unitupgrade[j];
+				if (unit.IsAlive()) {
+					unit.Player->Supply += um->Modifier.Variables[SUPPLY_INDEX].Value;
 				}
 			}
-			
-			// if a unit type's demand is changed, we need to update the player's demand accordingly
-			if (um->Modifier.Variables[DEMAND_INDEX].Value) {
-				std::vector<CUnit *> unitupgrade;
-
-				FindUnitsByType(*UnitTypes[z], unitupgrade);
-				for (size_t j = 0; j != unitupgrade.size(); ++j) {
-					CUnit &unit = *unitupgrade[j];
-					if (unit.Player->Index == pn && unit.IsAlive()) {
-						unit.Player->Demand += um->Modifier.Variables[DEMAND_INDEX].Value;
-					}
+		}
+		
+		// if a unit type's demand is changed, we need to update the player's demand accordingly
+		if (um->Modifier.Variables[DEMAND_INDEX].Value) {
+			for (size_t j = 0; j != unitupgrade.size(); ++j) {
+				CUnit &unit = *unitupgrade[j];
+				if (unit.IsAlive()) {
+					unit.Player->Demand += um->Modifier.Variables[DEMAND_INDEX].Value;
 				}
 			}
-			
-			// upgrade costs :)
-			for (unsigned int j = 0; j < MaxCosts; ++j) {
-				stat.Costs[j] += um->Modifier.Costs[j];
-				stat.Storing[j] += um->Modifier.Storing[j];
-				if (um->Modifier.ImproveIncomes[j]) {
-					if (!stat.ImproveIncomes[j]) {
-						stat.ImproveIncomes[j] += DefaultIncomes[j] + um->Modifier.ImproveIncomes[j];
-					} else {
-						stat.ImproveIncomes[j] += um->Modifier.ImproveIncomes[j];
-					}
-					//update player's income
-					std::vector<CUnit *> unitupgrade;
-					FindUnitsByType(*UnitTypes[z], unitupgrade);
-					if (unitupgrade.size() > 0) {
+		}
+		
+		// upgrade costs :)
+		for (unsigned int j = 0; j < MaxCosts; ++j) {
+			stat.Costs[j] += um->Modifier.Costs[j];
+			stat.Storing[j] += um->Modifier.Storing[j];
+			if (um->Modifier.ImproveIncomes[j]) {
+				if (!stat.ImproveIncomes[j]) {
+					stat.ImproveIncomes[j] += DefaultIncomes[j] + um->Modifier.ImproveIncomes[j];
+				} else {
+					stat.ImproveIncomes[j] += um->Modifier.ImproveIncomes[j];
+				}
+				//update player's income, when a unit of the type exists, whoever owns it
+				for (int p = 0; p < PlayerMax; ++p) {
+					if (Players[p].UnitTypesCount[z] > 0) {
 						player.Incomes[j] = std::max(player.Incomes[j], stat.ImproveIncomes[j]);
+						break;
 					}
 				}
 			}
+		}
 
-			int varModified = 0;
-			for (unsigned int j = 0; j < UnitTypeVar.GetNumberVariable(); j++) {
-				varModified |= um->Modifier.Variables[j].Value
-							   | um->Modifier.Variables[j].Max
-							   | um->Modifier.Variables[j].Increase
-							   | um->Modifier.Variables[j].IncreaseFrequency
-							   | um->Modifier.Variables[j].Enable
-							   | um->ModifyPercent[j];
-				stat.Variables[j].Enable |= um->Modifier.Variables[j].Enable;
-				if (um->ModifyPercent[j]) {
-					stat.Variables[j].Value += stat.Variables[j].Value * um->ModifyPercent[j] / 100;
-					stat.Variables[j].Max += stat.Variables[j].Max * um->ModifyPercent[j] / 100;
-				} else {
-					stat.Variables[j].Value += um->Modifier.Variables[j].Value;
-					stat.Variables[j].Max += um->Modifier.Variables[j].Max;
-					stat.Variables[j].Increase += um->Modifier.Variables[j].Increase;
-					stat.Variables[j].IncreaseFrequency += um->Modifier.Variables[j].IncreaseFrequency;
-				}
-
-				stat.Variables[j].Max = std::max(stat.Variables[j].Max, 0);
-				clamp(&stat.Variables[j].Value, 0, stat.Variables[j].Max);
+		int varModified = 0;
+		for (unsigned int j = 0; j < UnitTypeVar.GetNumberVariable(); j++) {
+			varModified |= um->Modifier.Variables[j].Value
+						   | um->Modifier.Variables[j].Max
+						   | um->Modifier.Variables[j].Increase
+						   | um->Modifier.Variables[j].IncreaseFrequency
+						   | um->Modifier.Variables[j].Enable
+						   | um->ModifyPercent[j];
+			stat.Variables[j].Enable |= um->Modifier.Variables[j].Enable;
+			if (um->ModifyPercent[j]) {
+				stat.Variables[j].Value += stat.Variables[j].Value * um->ModifyPercent[j] / 100;
+				stat.Variables[j].Max += stat.Variables[j].Max * um->ModifyPercent[j] / 100;
+			} else {
+				stat.Variables[j].Value += um->Modifier.Variables[j].Value;
+				stat.Variables[j].Max += um->Modifier.Variables[j].Max;
+				stat.Variables[j].Increase += um->Modifier.Variables[j].Increase;
+				stat.Variables[j].IncreaseFrequency += um->Modifier.Variables[j].IncreaseFrequency;
 			}
 
-			// And now modify ingame units
-			if (varModified) {
-				std::vector<CUnit *> unitupgrade;
+			stat.Variables[j].Max = std::max(stat.Variables[j].Max, 0);
+			clamp(&stat.Variables[j].Value, 0, stat.Variables[j].Max);
+		}
 
-				FindUnitsByType(*UnitTypes[z], unitupgrade, true);
-				for (size_t j = 0; j != unitupgrade.size(); ++j) {
-					CUnit &unit = *unitupgrade[j];
+		// And now modify ingame units
+		if (varModified) {
+			// The units under construction get the new values too
+			for (std::vector<CUnit *>::iterator it = player.UnitBegin(); it != player.UnitEnd(); ++it) {
+				CUnit &unit = **it;
 
-					if (unit.Player->Index != player.Index) {
-						continue;
+				if (unit.Type != UnitTypes[z] || unit.IsUnusable(true)) {
+					continue;
+				}
+				for (unsigned int j = 0; j < UnitTypeVar.GetNumberVariable(); j++) {
+					unit.Variable[j].Enable |= um->Modifier.Variables[j].Enable;
+					if (um->ModifyPercent[j]) {
+						unit.Variable[j].Value += unit.Variable[j].Value * um->ModifyPercent[j] / 100;
+						unit.Variable[j].Max += unit.Variable[j].Max * um->ModifyPercent[j] / 100;
+					} else {
+						unit.Variable[j].Value += um->Modifier.Variables[j].Value;
+						unit.Variable[j].Increase += um->Modifier.Variables[j].Increase;
+						unit.Variable[j].IncreaseFrequency += um->Modifier.Variables[j].IncreaseFrequency;
 					}
-					for (unsigned int j = 0; j < UnitTypeVar.GetNumberVariable(); j++) {
-						unit.Variable[j].Enable |= um->Modifier.Variables[j].Enable;
-						if (um->ModifyPercent[j]) {
-							unit.Variable[j].Value += unit.Variable[j].Value * um->ModifyPercent[j] / 100;
-							unit.Variable[j].Max += unit.Variable[j].Max * um->ModifyPercent[j] / 100;
-						} else {
-							unit.Variable[j].Value += um->Modifier.Variables[j].Value;
-							unit.Variable[j].Increase += um->Modifier.Variables[j].Increase;
-							unit.Variable[j].IncreaseFrequency += um->Modifier.Variables[j].IncreaseFrequency;
-						}
 
-						unit.Variable[j].Max += um->Modifier.Variables[j].Max;
-						unit.Variable[j].Max = std::max(unit.Variable[j].Max, 0);
-						if (unit.Variable[j].Max > 0) {
-							clamp(&unit.Variable[j].Value, 0, unit.Variable[j].Max);
-						}
+					unit.Variable[j].Max += um->Modifier.Variables[j].Max;
+					unit.Variable[j].Max = std::max(unit.Variable[j].Max, 0);
+					if (unit.Variable[j].Max > 0) {
+						clamp(&unit.Variable[j].Value, 0, unit.Variable[j].Max);
 					}
 				}
 			}
-			if (um->ConvertTo) {
-				ConvertUnitTypeTo(player, *UnitTypes[z], *um->ConvertTo);
-			}
+		}
+		if (um->ConvertTo) {
+			ConvertUnitTypeTo(player, *UnitTypes[z], *um->ConvertTo);
 		}
 	}
 }
@@ -706,149 +724,139 @@ static void RemoveUpgradeModifier(CPlayer &player, const CUpgradeModifier *um)
 		player.SpeedResearch -= um->SpeedResearch;
 	}
 
-	for (int z = 0; z < UpgradeMax; ++z) {
+	for (const std::pair<int, char> &change : um->ChangeUpgrades) {
+		const int z = change.first;
 		// allow/forbid upgrades for player.  only if upgrade is not acquired
 
 		// FIXME: check if modify is allowed
 
 		if (player.Allow.Upgrades[z] != 'R') {
-			if (um->ChangeUpgrades[z] == 'A') {
+			if (change.second == 'A') {
 				player.Allow.Upgrades[z] = 'F';
 			}
-			if (um->ChangeUpgrades[z] == 'F') {
+			if (change.second == 'F') {
 				player.Allow.Upgrades[z] = 'A';
 			}
 			// we can even have upgrade acquired w/o costs
-			if (um->ChangeUpgrades[z] == 'R') {
+			if (change.second == 'R') {
 				player.Allow.Upgrades[z] = 'A';
 			}
 		}
+		DependUpgradeChanged(player, z);
 	}
 
-	for (size_t z = 0; z < UnitTypes.size(); ++z) {
-		CUnitStats &stat = UnitTypes[z]->Stats[pn];
-		// add/remove allowed units
-
-		// FIXME: check if modify is allowed
-
-		player.Allow.Units[z] -= um->ChangeUnits[z];
-
-		Assert(um->ApplyTo[z] == '?' || um->ApplyTo[z] == 'X');
-
-		// this modifier should be applied to unittype id == z
-		if (um->ApplyTo[z] == 'X') {
-
-			// If Sight range is upgraded, we need to change EVERY unit
-			// to the new range, otherwise the counters get confused.
-			if (um->Modifier.Variables[SIGHTRANGE_INDEX].Value) {
-				std::vector<CUnit *> unitupgrade;
+	// add/remove allowed units
+	// FIXME: check if modify is allowed
+	for (const std::pair<int, int> &change : um->ChangeUnits) {
+		player.Allow.Units[change.first] -= change.second;
+	}
 
-				FindUnitsByType(*UnitTypes[z], unitupgrade);
-				for (size_t j = 0; j != unitupgrade.size(); ++j) {
-					CUnit &unit = *unitupgrade[j];
-					if (unit.Player->Index == pn && !unit.Removed) {
-						MapUnmarkUnitSight(unit);
-						unit.CurrentSightRange = stat.Variables[SIGHTRANGE_INDEX].Max -
-							um->Modifier.Variables[SIGHTRANGE_INDEX].Value;
-						MapMarkUnitSight(unit);
-					}
+	// this modifier should be applied to unittype id == z
+	for (int z : um->ApplyTo) {
+		CUnitStats &stat = UnitTypes[z]->Stats[pn];
+		std::vector<CUnit *> unitupgrade;
+
+		FindPlayerUnitsByType(player, *UnitTypes[z], unitupgrade);
+
+		// If Sight range is upgraded, we need to change EVERY unit
+		// to the new range, otherwise the counters get confused.
+		if (um->Modifier.Variables[SIGHTRANGE_INDEX].Value) {
+			for (size_t j = 0; j != unitupgrade.size(); ++j) {
+				CUnit &unit = *unitupgrade[j];
+				if (!unit.Removed) {
+					MapUnmarkUnitSight(unit);
+					unit.CurrentSightRange = stat.Variables[SIGHTRANGE_INDEX].Max -
+						um->Modifier.Variables[SIGHTRANGE_INDEX].Value;
+					MapMarkUnitSight(unit);
 				}
 			}
-			
-			// if a unit type's supply is changed, we need to update the player's supply accordingly
-			if (um->Modifier.Variables[SUPPLY_INDEX].Value) {
-				std::vector<CUnit *> unitupgrade;
-
-				FindUnitsByType(*UnitTypes[z], unitupgrade);
-				for (size_t j = 0; j != unitupgrade.size(); ++j) {
-					CUnit &unit = *unitupgrade[j];
-					if (unit.Player->Index == pn && unit.IsAlive()) {
-						unit.Player->Supply -= um->Modifier.Variables[SUPPLY_INDEX].Value;
-					}
+		}
+		
+		// if a unit type's supply is changed, we need to update the player's supply accordingly
+		if (um->Modifier.Variables[SUPPLY_INDEX].Value) {
+			for (size_t j = 0; j != unitupgrade.size(); ++j) {
+				CUnit &unit = *unitupgrade[j];
+				if (unit.IsAlive()) {
+					unit.Player->Supply -= um->Modifier.Variables[SUPPLY_INDEX].Value;
 				}
 			}
-			
-			// if a unit type's demand is changed, we need to update the player's demand accordingly
-			if (um->Modifier.Variables[DEMAND_INDEX].Value) {
-				std::vector<CUnit *> unitupgrade;
-
-				FindUnitsByType(*UnitTypes[z], unitupgrade);
-				for (size_t j = 0; j != unitupgrade.size(); ++j) {
-					CUnit &unit = *unitupgrade[j];
-					if (unit.Player->Index == pn && unit.IsAlive()) {
-						unit.Player->Demand -= um->Modifier.Variables[DEMAND_INDEX].Value;
-					}
+		}
+		
+		// if a unit type's demand is changed, we need to update the player's demand accordingly
+		if (um->Modifier.Variables[DEMAND_INDEX].Value) {
+			for (size_t j = 0; j != unitupgrade.size(); ++j) {
+				CUnit &unit = *unitupgrade[j];
+				if (unit.IsAlive()) {
+					unit.Player->Demand -= um->Modifier.Variables[DEMAND_INDEX].Value;
 				}
 			}
-			
-			// upgrade costs :)
-			for (unsigned int j = 0; j < MaxCosts; ++j) {
-				stat.Costs[j] -= um->Modifier.Costs[j];
-				stat.Storing[j] -= um->Modifier.Storing[j];
-				stat.ImproveIncomes[j] -= um->Modifier.ImproveIncomes[j];
-				//if this was the highest improve income, search for another
-				if (player.Incomes[j] && (stat.ImproveIncomes[j] + um->Modifier.ImproveIncomes[j]) == player.Incomes[j]) {
-					int m = DefaultIncomes[j];
-
-					for (int k = 0; k < player.GetUnitCount(); ++k) {
-						m = std::max(m, player.GetUnit(k).Type->Stats[player.Index].ImproveIncomes[j]);
-					}
-					player.Incomes[j] = m;
+		}
+		
+		// upgrade costs :)
+		for (unsigned int j = 0; j < MaxCosts; ++j) {
+			stat.Costs[j] -= um->Modifier.Costs[j];
+			stat.Storing[j] -= um->Modifier.Storing[j];
+			stat.ImproveIncomes[j] -= um->Modifier.ImproveIncomes[j];
+			//if this was the highest improve income, search for another
+			if (player.Incomes[j] && (stat.ImproveIncomes[j] + um->Modifier.ImproveIncomes[j]) == player.Incomes[j]) {
+				int m = DefaultIncomes[j];
+
+				for (int k = 0; k < player.GetUnitCount(); ++k) {
+					m = std::max(m, player.GetUnit(k).Type->Stats[player.Index].ImproveIncomes[j]);
 				}
+				player.Incomes[j] = m;
 			}
+		}
 
-			int varModified = 0;
-			for (unsigned int j = 0; j < UnitTypeVar.GetNumberVariable(); j++) {
-				varModified |= um->Modifier.Variables[j].Value
-					| um->Modifier.Variables[j].Max
-					| um->Modifier.Variables[j].Increase
-					| um->Modifier.Variables[j].Enable
-					| um->ModifyPercent[j];
-				stat.Variables[j].Enable |= um->Modifier.Variables[j].Enable;
-				if (um->ModifyPercent[j]) {
-					stat.Variables[j].Value = stat.Variables[j].Value * 100 / (100 + um->ModifyPercent[j]);
-					stat.Variables[j].Max = stat.Variables[j].Max * 100 / (100 + um->ModifyPercent[j]);
-				} else {
-					stat.Variables[j].Value -= um->Modifier.Variables[j].Value;
-					stat.Variables[j].Max -= um->Modifier.Variables[j].Max;
-					stat.Variables[j].Increase -= um->Modifier.Variables[j].Increase;
-				}
-
-				stat.Variables[j].Max = std::max(stat.Variables[j].Max, 0);
-				clamp(&stat.Variables[j].Value, 0, stat.Variables[j].Max);
+		int varModified = 0;
+		for (unsigned int j = 0; j < UnitTypeVar.GetNumberVariable(); j++) {
+			varModified |= um->Modifier.Variables[j].Value
+				| um->Modifier.Variables[j].Max
+				| um->Modifier.Variables[j].Increase
+				| um->Modifier.Variables[j].Enable
+				| um->ModifyPercent[j];
+			stat.Variables[j].Enable |= um->Modifier.Variables[j].Enable;
+			if (um->ModifyPercent[j]) {
+				stat.Variables[j].Value = stat.Variables[j].Value * 100 / (100 + um->ModifyPercent[j]);
+				stat.Variables[j].Max = stat.Variables[j].Max * 100 / (100 + um->ModifyPercent[j]);
+			} else {
+				stat.Variables[j].Value -= um->Modifier.Variables[j].Value;
+				stat.Variables[j].Max -= um->Modifier.Variables[j].Max;
+				stat.Variables[j].Increase -= um->Modifier.Variables[j].Increase;
 			}
 
-			// And now modify ingame units
-			if (varModified) {
-				std::vector<CUnit *> unitupgrade;
+			stat.Variables[j].Max = std::max(stat.Variables[j].Max, 0);
+			clamp(&stat.Variables[j].Value, 0, stat.Variables[j].Max);
+		}
 
-				FindUnitsByType(*UnitTypes[z], unitupgrade, true);
-				for (size_t j = 0; j != unitupgrade.size(); ++j) {
-					CUnit &unit = *unitupgrade[j];
+		// And now modify ingame units
+		if (varModified) {
+			// The units under construction get the new values too
+			for (std::vector<CUnit *>::iterator it = player.UnitBegin(); it != player.UnitEnd(); ++it) {
+				CUnit &unit = **it;
 
-					if (unit.Player->Index != player.Index) {
-						continue;
+				if (unit.Type != UnitTypes[z] || unit.IsUnusable(true)) {
+					continue;
+				}
+				for (unsigned int j = 0; j < UnitTypeVar.GetNumberVariable(); j++) {
+					unit.Variable[j].Enable |= um->Modifier.Variables[j].Enable;
+					if (um->ModifyPercent[j]) {
+						unit.Variable[j].Value = unit.Variable[j].Value * 100 / (100 + um->ModifyPercent[j]);
+						unit.Variable[j].Max = unit.Variable[j].Max * 100 / (100 + um->ModifyPercent[j]);
+					} else {
+						unit.Variable[j].Value -= um->Modifier.Variables[j].Value;
+						unit.Variable[j].Increase -= um->Modifier.Variables[j].Increase;
 					}
-					for (unsigned int j = 0; j < UnitTypeVar.GetNumberVariable(); j++) {
-						unit.Variable[j].Enable |= um->Modifier.Variables[j].Enable;
-						if (um->ModifyPercent[j]) {
-							unit.Variable[j].Value = unit.Variable[j].Value * 100 / (100 + um->ModifyPercent[j]);
-							unit.Variable[j].Max = unit.Variable[j].Max * 100 / (100 + um->ModifyPercent[j]);
-						} else {
-							unit.Variable[j].Value -= um->Modifier.Variables[j].Value;
-							unit.Variable[j].Increase -= um->Modifier.Variables[j].Increase;
-						}
 
-						unit.Variable[j].Max -= um->Modifier.Variables[j].Max;
-						unit.Variable[j].Max = std::max(unit.Variable[j].Max, 0);
+					unit.Variable[j].Max -= um->Modifier.Variables[j].Max;
+					unit.Variable[j].Max = std::max(unit.Variable[j].Max, 0);
 
-						clamp(&unit.Variable[j].Value, 0, unit.Variable[j].Max);
-					}
+					clamp(&unit.Variable[j].Value, 0, unit.Variable[j].Max);
 				}
 			}
-			if (um->ConvertTo) {
-				ConvertUnitTypeTo(player, *um->ConvertTo, *UnitTypes[z]);
-			}
+		}
+		if (um->ConvertTo) {
+			ConvertUnitTypeTo(player, *um->ConvertTo, *UnitTypes[z]);
 		}
 	}
 }
@@ -1008,7 +1016,7 @@ void IndividualUpgradeAcquire(CUnit &unit, const CUpgrade *upgrade)
 {
 	int id = upgrade->ID;
 	unit.Player->UpgradeTimers.Upgrades[id] = upgrade->Costs[TimeCost];
-	unit.IndividualUpgrades[id] = true;
+	unit.Cold->IndividualUpgrades[id] = true;
 
 	for (int z = 0; z < NumUpgradeModifiers; ++z) {
 		if (UpgradeModifiers[z]->UpgradeId == id) {
@@ -1028,7 +1036,7 @@ void IndividualUpgradeLost(CUnit &unit, const CUpgrade *upgrade)
 {
 	int id = upgrade->ID;
 	unit.Player->UpgradeTimers.Upgrades[id] = 0;
-	unit.IndividualUpgrades[id] = false;
+	unit.Cold->IndividualUpgrades[id] = false;
 
 	for (int z = 0; z < NumUpgradeModifiers; ++z) {
 		if (UpgradeModifiers[z]->UpgradeId == id) {
@@ -1073,6 +1081,7 @@ void AllowUpgradeId(CPlayer &player, int id, char af)
 {
 	Assert(af == 'A' || af == 'F' || af == 'R');
 	player.Allow.Upgrades[id] = af;
+	DependUpgradeChanged(player, id);
 }
 
 /**
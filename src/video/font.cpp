@@ -40,6 +40,7 @@
 #include "intern_video.h"
 #include "video.h"
 
+#include <algorithm>
 #include <vector>
 #include <map>
 
@@ -62,12 +63,64 @@ static std::string DefaultNormalColorIndex;  /// Default normal color index
 static std::string DefaultReverseColorIndex; /// Default reverse color index
 
 /**
-**  Font color graphics
+**  Font color graphics: a copy of the font surface with the palette of
+**  the color already set, so drawing a glyph never changes a palette.
 **  Usage: FontColorGraphics[CFont *font][CFontColor *color]
 */
-typedef std::map<const CFontColor *, CGraphic *> FontColorGraphicMap;
+typedef std::map<const CFontColor *, SDL_Surface *> FontColorGraphicMap;
 static std::map<const CFont *, FontColorGraphicMap> FontColorGraphics;
 
+/// One glyph of a laid out text
+struct TextRunGlyph {
+	SDL_Surface *Surface; /// Font color graphic of the glyph
+	short GX;             /// X offset into the graphic
+	short GY;             /// Y offset into the graphic
+	short W;              /// Width of the glyph
+	short X;              /// X offset from the start of the text
+};
+
+/**
+**  A text laid out for drawing: the escapes are parsed, the characters
+**  decoded and the colors resolved. Once a text was drawn a few times,
+**  its glyphs are put together in Span, which is drawn with one blit.
+*/
+struct TextRun {
+	std::vector<TextRunGlyph> Glyphs;
+	int Width = 0;                            /// Width of the text in pixels
+	int Height = 0;                           /// Height of the font
+	bool Cacheable = true;                    /// Layout doesn't depend on the previous text
+	bool SetsLastColor = false;               /// Text changes LastTextColor
+	const CFontColor *LastColor = NULL;       /// LastTextColor after the text
+	unsigned int Draws = 0;                   /// Number of times the text was drawn
+	SDL_Surface *Span = NULL;                 /// All glyphs in one surface
+};
+
+/// Key of the text run cache
+struct TextRunKey {
+	const CFont *Font;
+	const CFontColor *Normal;
+	const CFontColor *Reverse;
+	std::string Text;
+
+	bool operator <(const TextRunKey &rhs) const
+	{
+		if (Font != rhs.Font) {
+			return Font < rhs.Font;
+		}
+		if (Normal != rhs.Normal) {
+			return Normal < rhs.Normal;
+		}
+		if (Reverse != rhs.Reverse) {
+			return Reverse < rhs.Reverse;
+		}
+		return Text < rhs.Text;
+	}
+};
+
+static const size_t MaxTextRuns = 512;           /// Size limit of the text run cache
+static const unsigned int TextRunSpanDraws = 2;  /// Draws before a text gets a span
+static std::map<TextRunKey, TextRun *> TextRuns; /// Text run cache
+
 // FIXME: remove these
 static CFont *SmallFont;  /// Small font used in stats
 static CFont *GameFont;   /// Normal font used in game
@@ -124,23 +177,36 @@ CFont &GetGameFont()
 ----------------------------------------------------------------------------*/
 
 /**
-**  Draw character with current color.
+**  Draw character or text span.
 **
-**  @param g   Pointer to object
-**  @param gx  X offset into object
-**  @param gy  Y offset into object
-**  @param w   width to display
-**  @param h   height to display
-**  @param x   X screen position
-**  @param y   Y screen position
+**  @param surface  Font color graphic or span
+**  @param gx       X offset into surface
+**  @param gy       Y offset into surface
+**  @param w        width to display
+**  @param h        height to display
+**  @param x        X screen position
+**  @param y        Y screen position
 */
-static void VideoDrawChar(const CGraphic &g,
-						  int gx, int gy, int w, int h, int x, int y, const CFontColor &fc)
+static void VideoDrawChar(SDL_Surface *surface,
+						  int gx, int gy, int w, int h, int x, int y)
 {
 	SDL_Rect srect = {Sint16(gx), Sint16(gy), Uint16(w), Uint16(h)};
 	SDL_Rect drect = {Sint16(x), Sint16(y), 0, 0};
-	SDL_SetPaletteColors(g.Surface->format->palette, fc.Colors, 0, MaxFontColors);
-	SDL_BlitSurface(g.Surface, &srect, TheScreen, &drect);
+	SDL_BlitSurface(surface, &srect, TheScreen, &drect);
+}
+
+/**
+**  Free the text run cache.
+*/
+static void ClearTextRuns()
+{
+	for (std::map<TextRunKey, TextRun *>::iterator it = TextRuns.begin(); it != TextRuns.end(); ++it) {
+		if (it->second->Span) {
+			SDL_FreeSurface(it->second->Span);
+		}
+		delete it->second;
+	}
+	TextRuns.clear();
 }
 
 /**
@@ -492,30 +558,36 @@ CFont::~CFont()
 }
 
 /**
-**  Draw character with current color clipped into 8 bit framebuffer.
+**  Draw character or text span clipped.
 **
-**  @param g   Pointer to object
-**  @param gx  X offset into object
-**  @param gy  Y offset into object
-**  @param w   width to display
-**  @param h   height to display
-**  @param x   X screen position
-**  @param y   Y screen position
+**  @param surface  Font color graphic or span
+**  @param gx       X offset into surface
+**  @param gy       Y offset into surface
+**  @param w        width to display
+**  @param h        height to display
+**  @param x        X screen position
+**  @param y        Y screen position
 */
-static void VideoDrawCharClip(const CGraphic &g, int gx, int gy, int w, int h,
-							  int x, int y, const CFontColor &fc)
+static void VideoDrawCharClip(SDL_Surface *surface, int gx, int gy, int w, int h,
+							  int x, int y)
 {
 	int ox;
 	int oy;
 	int ex;
 	CLIP_RECTANGLE_OFS(x, y, w, h, ox, oy, ex);
 	UNUSED(ex);
-	VideoDrawChar(g, gx + ox, gy + oy, w, h, x, y, fc);
+	VideoDrawChar(surface, gx + ox, gy + oy, w, h, x, y);
 }
 
-
-template<bool CLIP>
-unsigned int CFont::DrawChar(CGraphic &g, int utf8, int x, int y, const CFontColor &fc) const
+/**
+**  Get the position of a glyph in the font graphic.
+**
+**  @param utf8  Codepage index of the character
+**  @param gx    X offset of the glyph into the graphic
+**  @param gy    Y offset of the glyph into the graphic
+**  @param w     Width of the glyph
+*/
+void CFont::GetGlyph(int utf8, int *gx, int *gy, int *w) const
 {
 	int c = utf8 - 32;
 	Assert(c >= 0);
@@ -524,45 +596,48 @@ unsigned int CFont::DrawChar(CGraphic &g, int utf8, int x, int y, const CFontCol
 	if (c < 0 || ipr * this->G->GraphicHeight / this->G->Height <= c) {
 		c = 0;
 	}
-	const int w = this->CharWidth[c];
-	const int gx = (c % ipr) * this->G->Width;
-	const int gy = (c / ipr) * this->G->Height;
-
-	if (CLIP) {
-		VideoDrawCharClip(g, gx, gy, w, this->G->Height, x , y, fc);
-	} else {
-		VideoDrawChar(g, gx, gy, w, this->G->Height, x, y, fc);
-	}
-	return w + 1;
+	*w = this->CharWidth[c];
+	*gx = (c % ipr) * this->G->Width;
+	*gy = (c / ipr) * this->G->Height;
 }
 
-CGraphic *CFont::GetFontColorGraphic(const CFontColor &fontColor) const
+/**
+**  Get the font graphic for a color. It is made the first time the
+**  color is used with the font, and its palette is refreshed if a script
+**  changed the color since.
+**
+**  @param fontColor  Font color
+**
+**  @return           Font surface with the palette of the color
+*/
+SDL_Surface *CFont::GetFontColorGraphic(const CFontColor &fontColor) const
 {
-	return this->G;
+	SDL_Surface *&surface = FontColorGraphics[this][&fontColor];
+
+	if (surface == NULL) {
+		surface = SDL_ConvertSurface(this->G->Surface, this->G->Surface->format, 0);
+		SDL_SetPaletteColors(surface->format->palette, fontColor.Colors, 0, MaxFontColors);
+	} else if (memcmp(surface->format->palette->colors, fontColor.Colors, sizeof(SDL_Color) * MaxFontColors)) {
+		SDL_SetPaletteColors(surface->format->palette, fontColor.Colors, 0, MaxFontColors);
+		// the spans still have the old colors
+		ClearTextRuns();
+	}
+	return surface;
 }
 
 /**
-**  Draw text with font at x,y clipped/unclipped.
+**  Lay out a text. Like the drawing did before, this updates LastTextColor.
 **
-**  ~    is special prefix.
-**  ~~   is the ~ character self.
-**  ~!   print next character reverse.
-**  ~<   start reverse.
-**  ~>   switch back to last used color.
-**
-**  @param x     X screen position
-**  @param y     Y screen position
-**  @param font  Font number
-**  @param text  Text to be displayed.
-**  @param clip  Flag if TRUE clip, otherwise not.
-**
-**  @return      The length of the printed text.
+**  @param font     Font of the text
+**  @param text     Text to lay out
+**  @param len      Length of the text
+**  @param fc       Normal color
+**  @param reverse  Reverse color
+**  @param run      Filled with the laid out text
 */
-template <const bool CLIP>
-int CLabel::DoDrawText(int x, int y,
-					   const char *const text, const size_t len, const CFontColor *fc) const
+static void LayoutText(const CFont &font, const char *const text, const size_t len,
+					   const CFontColor *fc, const CFontColor *reverse, TextRun &run)
 {
-	int widths = 0;
 	int utf8;
 	bool tab;
 	const int tabSize = 4; // FIXME: will be removed when text system will be rewritten
@@ -570,9 +645,9 @@ int CLabel::DoDrawText(int x, int y,
 	size_t subpos = 0;
 	const CFontColor *backup = fc;
 	bool isColor = false;
-	font->DynamicLoad();
-	CGraphic *g = font->GetFontColorGraphic(*FontColor);
+	SDL_Surface *surface = font.GetFontColorGraphic(*fc);
 
+	run.Height = font.Height();
 	while ((utf8 = CodepageIndexFromUTF8(text, len, pos, subpos))) {
 		tab = false;
 		if (utf8 == '\t') {
@@ -581,7 +656,7 @@ int CLabel::DoDrawText(int x, int y,
 			switch (text[pos]) {
 				case '\0':  // wrong formatted string.
 					DebugPrint("oops, format your ~\n");
-					return widths;
+					return;
 				case '~':
 					++pos;
 					break;
@@ -591,24 +666,30 @@ int CLabel::DoDrawText(int x, int y,
 				case '!':
 					if (fc != reverse) {
 						fc = reverse;
-						g = font->GetFontColorGraphic(*fc);
+						surface = font.GetFontColorGraphic(*fc);
 					}
 					++pos;
 					continue;
 				case '<':
 					LastTextColor = fc;
+					run.SetsLastColor = true;
 					if (fc != reverse) {
 						isColor = true;
 						fc = reverse;
-						g = font->GetFontColorGraphic(*fc);
+						surface = font.GetFontColorGraphic(*fc);
 					}
 					++pos;
 					continue;
 				case '>':
+					if (!run.SetsLastColor) {
+						// depends on the text drawn before
+						run.Cacheable = false;
+					}
 					if (fc != LastTextColor) {
 						std::swap(fc, LastTextColor);
+						run.SetsLastColor = true;
 						isColor = false;
-						g = font->GetFontColorGraphic(*fc);
+						surface = font.GetFontColorGraphic(*fc);
 					}
 					++pos;
 					continue;
@@ -620,37 +701,183 @@ int CLabel::DoDrawText(int x, int y,
 					}
 					if (!*p) {
 						DebugPrint("oops, format your ~\n");
-						return widths;
+						return;
 					}
 					std::string color;
 
 					color.insert(0, text + pos, p - (text + pos));
 					pos = p - text + 1;
 					LastTextColor = fc;
+					run.SetsLastColor = true;
 					const CFontColor *fc_tmp = CFontColor::Get(color);
 					if (fc_tmp) {
 						isColor = true;
 						fc = fc_tmp;
-						g = font->GetFontColorGraphic(*fc);
+						surface = font.GetFontColorGraphic(*fc);
 					}
 					continue;
 				}
 			}
 		}
-		if (tab) {
-			for (int tabs = 0; tabs < tabSize; ++tabs) {
-				widths += font->DrawChar<CLIP>(*g, ' ', x + widths, y, *fc);
+		for (int i = 0; i < (tab ? tabSize : 1); ++i) {
+			TextRunGlyph glyph;
+			int gx;
+			int gy;
+			int w;
+
+			font.GetGlyph(tab ? ' ' : utf8, &gx, &gy, &w);
+			if (w > 0) {
+				glyph.Surface = surface;
+				glyph.GX = gx;
+				glyph.GY = gy;
+				glyph.W = w;
+				glyph.X = run.Width;
+				run.Glyphs.push_back(glyph);
 			}
-		} else {
-			widths += font->DrawChar<CLIP>(*g, utf8, x + widths, y, *fc);
+			run.Width += w + 1;
 		}
 
 		if (isColor == false && fc != backup) {
 			fc = backup;
-			g = font->GetFontColorGraphic(*fc);
+			surface = font.GetFontColorGraphic(*fc);
+		}
+	}
+}
+
+/**
+**  Put all glyphs of a text run in one surface. The transparent color is
+**  chosen so that no color of the font graphics maps to it.
+**
+**  @param run  Text run to make the span of
+*/
+static void MakeTextRunSpan(TextRun &run)
+{
+	SDL_Surface *span = SDL_CreateRGBSurface(0, run.Width, run.Height, 32, RMASK, GMASK, BMASK, 0);
+	if (span == NULL) {
+		return;
+	}
+	std::vector<SDL_Surface *> surfaces;
+	std::vector<Uint32> used;
+	for (size_t i = 0; i != run.Glyphs.size(); ++i) {
+		SDL_Surface *surface = run.Glyphs[i].Surface;
+		if (std::find(surfaces.begin(), surfaces.end(), surface) != surfaces.end()) {
+			continue;
+		}
+		surfaces.push_back(surface);
+		Uint32 ckey = 0;
+		const bool hasKey = SDL_GetColorKey(surface, &ckey) == 0;
+		const SDL_Palette &palette = *surface->format->palette;
+		for (int j = 0; j != palette.ncolors; ++j) {
+			if (!hasKey || Uint32(j) != ckey) {
+				used.push_back(SDL_MapRGB(span->format, palette.colors[j].r, palette.colors[j].g, palette.colors[j].b));
+			}
 		}
 	}
-	return widths;
+	std::sort(used.begin(), used.end());
+
+	Uint32 key = 0;
+	for (int i = 0; i != 0x10000; ++i) {
+		key = SDL_MapRGB(span->format, 0xFF, i & 0xFF, 0xFF - (i >> 8));
+		if (!std::binary_search(used.begin(), used.end(), key)) {
+			break;
+		}
+	}
+	SDL_FillRect(span, NULL, key);
+	for (size_t i = 0; i != run.Glyphs.size(); ++i) {
+		const TextRunGlyph &glyph = run.Glyphs[i];
+		SDL_Rect srect = {glyph.GX, glyph.GY, glyph.W, Uint16(run.Height)};
+		SDL_Rect drect = {glyph.X, 0, 0, 0};
+		SDL_BlitSurface(glyph.Surface, &srect, span, &drect);
+	}
+	SDL_SetColorKey(span, SDL_TRUE, key);
+	SDL_SetSurfaceRLE(span, 1);
+	run.Span = span;
+}
+
+/**
+**  Get the laid out text, from the cache when possible.
+**
+**  @return  The text run, only valid until the next call.
+*/
+static TextRun &GetTextRun(const CFont &font, const char *const text, const size_t len,
+						   const CFontColor *fc, const CFontColor *reverse)
+{
+	static TextRun uncached;
+	TextRunKey key;
+
+	key.Font = &font;
+	key.Normal = fc;
+	key.Reverse = reverse;
+	key.Text.assign(text, len);
+	std::map<TextRunKey, TextRun *>::iterator it = TextRuns.find(key);
+	if (it != TextRuns.end()) {
+		TextRun &run = *it->second;
+		if (run.SetsLastColor) {
+			LastTextColor = run.LastColor;
+		}
+		return run;
+	}
+
+	TextRun *run = new TextRun;
+	LayoutText(font, text, len, fc, reverse, *run);
+	run->LastColor = LastTextColor;
+	if (!run->Cacheable) {
+		uncached = *run;
+		delete run;
+		return uncached;
+	}
+	if (TextRuns.size() >= MaxTextRuns) {
+		ClearTextRuns();
+	}
+	TextRuns[key] = run;
+	return *run;
+}
+
+/**
+**  Draw text with font at x,y clipped/unclipped.
+**
+**  ~    is special prefix.
+**  ~~   is the ~ character self.
+**  ~!   print next character reverse.
+**  ~<   start reverse.
+**  ~>   switch back to last used color.
+**
+**  @param x     X screen position
+**  @param y     Y screen position
+**  @param font  Font number
+**  @param text  Text to be displayed.
+**  @param clip  Flag if TRUE clip, otherwise not.
+**
+**  @return      The length of the printed text.
+*/
+template <const bool CLIP>
+int CLabel::DoDrawText(int x, int y,
+					   const char *const text, const size_t len, const CFontColor *fc) const
+{
+	font->DynamicLoad();
+	TextRun &run = GetTextRun(*font, text, len, fc, reverse);
+
+	if (run.Span == NULL && run.Cacheable && !run.Glyphs.empty() && ++run.Draws >= TextRunSpanDraws) {
+		MakeTextRunSpan(run);
+	}
+	if (run.Span) {
+		if (CLIP) {
+			VideoDrawCharClip(run.Span, 0, 0, run.Width, run.Height, x, y);
+		} else {
+			VideoDrawChar(run.Span, 0, 0, run.Width, run.Height, x, y);
+		}
+		return run.Width;
+	}
+	for (size_t i = 0; i != run.Glyphs.size(); ++i) {
+		const TextRunGlyph &glyph = run.Glyphs[i];
+
+		if (CLIP) {
+			VideoDrawCharClip(glyph.Surface, glyph.GX, glyph.GY, glyph.W, run.Height, x + glyph.X, y);
+		} else {
+			VideoDrawChar(glyph.Surface, glyph.GX, glyph.GY, glyph.W, run.Height, x + glyph.X, y);
+		}
+	}
+	return run.Width;
 }
 
 
@@ -943,15 +1170,13 @@ void LoadFonts()
 
 void CFont::Reload() const
 {
-	if (this->G) {
-		FontColorGraphicMap &fontColorGraphicMap = FontColorGraphics[this];
-		for (FontColorGraphicMap::iterator it = fontColorGraphicMap.begin();
-			 it != fontColorGraphicMap.end(); ++it) {
-			CGraphic *g = it->second;
-			delete g;
-		}
-		fontColorGraphicMap.clear();
+	FontColorGraphicMap &fontColorGraphicMap = FontColorGraphics[this];
+	for (FontColorGraphicMap::iterator it = fontColorGraphicMap.begin();
+		 it != fontColorGraphicMap.end(); ++it) {
+		SDL_FreeSurface(it->second);
 	}
+	FontColorGraphics.erase(this);
+	ClearTextRuns();
 }
 
 
@@ -981,6 +1206,7 @@ void ReloadFonts()
 	if (font) {
 		if (font->G != g) {
 			CGraphic::Free(font->G);
+			font->Reload();
 		}
 	} else {
 		font = new CFont(ident);
@@ -1024,7 +1250,7 @@ CFontColor::~CFontColor()
 }
 
 /**
-**  Create a new font color
+**  Create a new font color, or get it to redefine it
 **
 **  @param ident  Font color identifier
 **
@@ -1037,6 +1263,9 @@ CFontColor::~CFontColor()
 	if (fc == NULL) {
 		fc = new CFontColor(ident);
 	}
+	// The script sets the colors next: texts which named or used this color
+	// are laid out again, and GetFontColorGraphic refreshes the palettes.
+	ClearTextRuns();
 	return fc;
 }
 
@@ -1058,6 +1287,7 @@ CFontColor::~CFontColor()
 
 void CFont::Clean()
 {
+	Reload();
 }
 
 /**
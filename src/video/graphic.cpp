@@ -244,9 +244,199 @@ void CGraphic::DrawSubClipCustomMod(int gx, int gy, int w, int h, int x, int y,
 	DrawSubCustomMod(gx + x - oldx, gy + y - oldy, w, h, x, y, modifier, param, surface);
 }
 
+/**
+**  Run length encoded frames of an 8 bit colour keyed graphic.
+**
+**  Each row of the opaque box of a frame is a list of runs: the number
+**  of transparent pixels to skip, the number of opaque pixels and their
+**  palette indexes. A row ends with an empty run (0, 0).
+*/
+struct CGraphic::rle_frames_t {
+	/// Palette of a surface mapped to the target format
+	struct palette_map_t {
+		SDL_Color colors[256];  /// Colours which have been mapped
+		Uint32 mapped[256];     /// Colours in the target format
+		Uint32 format;          /// Target format, 0 if nothing is mapped yet
+	};
+
+	Uint32 colorKey;                     /// Colour key of the encoded surface
+	std::vector<Uint8> runs;             /// Runs of all the rows
+	std::vector<unsigned int> rows;      /// Offset in runs of each row of the boxes
+	std::vector<unsigned int> firstRow;  /// Index in rows of the first row of each frame
+	palette_map_t palettes[2];           /// Colours of Surface and SurfaceFlip
+};
+
+/**
+**  Tell if a frame can be drawn from its runs instead of SDL_BlitSurface.
+**
+**  The runs only give the same result as a plain colour keyed blit to a
+**  32bpp surface without alpha.
+**
+**  @param src       Surface the frame would be blitted from
+**  @param dst       Target surface
+**  @param colorKey  Set to the colour key of src
+*/
+static bool CanDrawRleFrame(SDL_Surface *src, SDL_Surface *dst, Uint32 *colorKey)
+{
+	if (src->format->BytesPerPixel != 1 || dst->format->BytesPerPixel != 4
+		|| dst->format->Amask || SDL_MUSTLOCK(dst) || SDL_GetColorKey(src, colorKey)) {
+		return false;
+	}
+	Uint8 alpha;
+	Uint8 r, g, b;
+	SDL_BlendMode mode;
+	SDL_GetSurfaceAlphaMod(src, &alpha);
+	SDL_GetSurfaceColorMod(src, &r, &g, &b);
+	SDL_GetSurfaceBlendMode(src, &mode);
+	return alpha == 255 && r == 255 && g == 255 && b == 255 && mode == SDL_BLENDMODE_NONE;
+}
+
+/**
+**  Encode the opaque boxes of the frames of an 8 bit graphic.
+**
+**  @param g         Graphic, with its frame boxes
+**  @param colorKey  Colour key of its surface
+*/
+static CGraphic::rle_frames_t *MakeRleFrames(const CGraphic &g, Uint32 colorKey)
+{
+	CGraphic::rle_frames_t *rle = new CGraphic::rle_frames_t;
+	rle->colorKey = colorKey;
+	rle->palettes[0].format = rle->palettes[1].format = 0;
+	rle->firstRow.resize(g.NumFrames);
+	std::vector<Uint8> &runs = rle->runs;
+
+	SDL_LockSurface(g.Surface);
+	for (int f = 0; f < g.NumFrames; ++f) {
+		const CGraphic::frame_box_t &box = g.box_map[f];
+		rle->firstRow[f] = rle->rows.size();
+		for (int y = 0; y < box.h; ++y) {
+			rle->rows.push_back(runs.size());
+			const Uint8 *p = static_cast<const Uint8 *>(g.Surface->pixels)
+							 + (g.frame_map[f].y + box.y + y) * g.Surface->pitch + g.frame_map[f].x + box.x;
+			int x = 0;
+			while (x < box.w) {
+				int skip = 0;
+				for (; x < box.w && p[x] == colorKey; ++x) {
+					++skip;
+				}
+				int count = 0;
+				while (x + count < box.w && p[x + count] != colorKey) {
+					++count;
+				}
+				if (!count) {
+					break;
+				}
+				for (; skip > 255; skip -= 255) {
+					runs.push_back(255);
+					runs.push_back(0);
+				}
+				while (count) {
+					const int n = std::min(count, 255);
+					runs.push_back(skip);
+					runs.push_back(n);
+					runs.insert(runs.end(), p + x, p + x + n);
+					x += n;
+					count -= n;
+					skip = 0;
+				}
+			}
+			runs.push_back(0);
+			runs.push_back(0);
+		}
+	}
+	SDL_UnlockSurface(g.Surface);
+	return rle;
+}
+
+/**
+**  Map the palette of a surface to a target format.
+**
+**  Only the colours which have changed since the last call are mapped
+**  again, as the player colours are set before each draw.
+*/
+static const Uint32 *MapRlePalette(CGraphic::rle_frames_t::palette_map_t &map,
+								   const SDL_Palette &palette, const SDL_PixelFormat &format)
+{
+	const bool all = map.format != format.format;
+	const int ncolors = std::min(palette.ncolors, 256);
+	for (int i = 0; i < ncolors; ++i) {
+		const SDL_Color &color = palette.colors[i];
+		if (all || memcmp(&map.colors[i], &color, sizeof(SDL_Color))) {
+			map.colors[i] = color;
+			map.mapped[i] = SDL_MapRGB(&format, color.r, color.g, color.b);
+		}
+	}
+	map.format = format.format;
+	return map.mapped;
+}
+
+/**
+**  Draw a frame clipped from its runs, only visiting its opaque pixels.
+**
+**  @param g         Graphic
+**  @param frame     Number of the frame
+**  @param x         x coordinate of the frame on the target surface
+**  @param y         y coordinate of the frame on the target surface
+**  @param flip      Draw the frame flipped in X direction
+**  @param colorKey  Colour key of the graphic surface
+**  @param surface   Target surface
+*/
+static void DrawRleFrameClip(const CGraphic &g, unsigned frame, int x, int y, bool flip,
+							 Uint32 colorKey, SDL_Surface *surface)
+{
+	if (!g.rle_frames || g.rle_frames->colorKey != colorKey) {
+		delete g.rle_frames;
+		g.rle_frames = MakeRleFrames(g, colorKey);
+	}
+	CGraphic::rle_frames_t &rle = *g.rle_frames;
+	const CGraphic::frame_box_t &box = g.box_map[frame];
+	const SDL_Surface *src = flip ? g.SurfaceFlip : g.Surface;
+	const Uint32 *colors = MapRlePalette(rle.palettes[flip], *src->format->palette, *surface->format);
+
+	const int boxX = x + (flip ? g.Width - box.x - box.w : box.x);
+	const int boxY = y + box.y;
+	const SDL_Rect &clip = surface->clip_rect;
+	const int x1 = std::max(std::max(ClipX1, int(clip.x)), boxX);
+	const int x2 = std::min(std::min(ClipX2, clip.x + clip.w - 1), boxX + box.w - 1);
+	const int y1 = std::max(std::max(ClipY1, int(clip.y)), boxY);
+	const int y2 = std::min(std::min(ClipY2, clip.y + clip.h - 1), boxY + box.h - 1);
+	if (x1 > x2) {
+		return;
+	}
+
+	for (int py = y1; py <= y2; ++py) {
+		const Uint8 *run = &rle.runs[rle.rows[rle.firstRow[frame] + py - boxY]];
+		Uint32 *dst = reinterpret_cast<Uint32 *>(static_cast<Uint8 *>(surface->pixels) + py * surface->pitch);
+		// Column of the run in the box
+		int pos = 0;
+		while (run[0] || run[1]) {
+			pos += run[0];
+			const int count = run[1];
+			const Uint8 *pixels = run + 2;
+			run = pixels + count;
+			if (!flip) {
+				const int start = boxX + pos;
+				const int end = std::min(count, x2 - start + 1);
+				for (int i = std::max(0, x1 - start); i < end; ++i) {
+					dst[start + i] = colors[pixels[i]];
+				}
+			} else {
+				const int start = boxX + box.w - 1 - pos;
+				const int end = std::min(count, start - x1 + 1);
+				for (int i = std::max(0, start - x2); i < end; ++i) {
+					dst[start - i] = colors[pixels[i]];
+				}
+			}
+			pos += count;
+		}
+	}
+}
+
 /**
 **  Draw graphic object unclipped.
 **
+**  Only the opaque box of the frame is blitted.
+**
 **  @param frame   number of frame (object index)
 **  @param x       x coordinate on the target surface
 **  @param y       y coordinate on the target surface
@@ -255,13 +445,18 @@ void CGraphic::DrawSubClipCustomMod(int gx, int gy, int w, int h, int x, int y,
 void CGraphic::DrawFrame(unsigned frame, int x, int y,
 						 SDL_Surface *surface /*= TheScreen*/) const
 {
-	DrawSub(frame_map[frame].x, frame_map[frame].y,
-			Width, Height, x, y, surface);
+	const frame_box_t &box = box_map[frame];
+	if (box.w) {
+		DrawSub(frame_map[frame].x + box.x, frame_map[frame].y + box.y,
+				box.w, box.h, x + box.x, y + box.y, surface);
+	}
 }
 
 /**
 **  Draw graphic object clipped.
 **
+**  8 bit colour keyed frames are drawn from their runs when possible.
+**
 **  @param frame   number of frame (object index)
 **  @param x       x coordinate on the target surface
 **  @param y       y coordinate on the target surface
@@ -270,22 +465,37 @@ void CGraphic::DrawFrame(unsigned frame, int x, int y,
 void CGraphic::DrawFrameClip(unsigned frame, int x, int y, 
 							 SDL_Surface *surface /*= TheScreen*/) const
 {
-	DrawSubClip(frame_map[frame].x, frame_map[frame].y,
-				Width, Height, x, y, surface);
+	const frame_box_t &box = box_map[frame];
+	if (!box.w) {
+		return;
+	}
+	Uint32 colorKey;
+	if (CanDrawRleFrame(Surface, surface, &colorKey)) {
+		DrawRleFrameClip(*this, frame, x, y, false, colorKey, surface);
+		return;
+	}
+	DrawSubClip(frame_map[frame].x + box.x, frame_map[frame].y + box.y,
+				box.w, box.h, x + box.x, y + box.y, surface);
 }
 
 void CGraphic::DrawFrameTrans(unsigned frame, int x, int y, int alpha,
 							  SDL_Surface *surface /*= TheScreen*/) const
 {
-	DrawSubTrans(frame_map[frame].x, frame_map[frame].y,
-				 Width, Height, x, y, alpha, surface);
+	const frame_box_t &box = box_map[frame];
+	if (box.w) {
+		DrawSubTrans(frame_map[frame].x + box.x, frame_map[frame].y + box.y,
+					 box.w, box.h, x + box.x, y + box.y, alpha, surface);
+	}
 }
 
 void CGraphic::DrawFrameClipTrans(unsigned frame, int x, int y, int alpha, 
 								  SDL_Surface *surface /* = TheScreen*/) const
 {
-	DrawSubClipTrans(frame_map[frame].x, frame_map[frame].y,
-					 Width, Height, x, y, alpha, surface);
+	const frame_box_t &box = box_map[frame];
+	if (box.w) {
+		DrawSubClipTrans(frame_map[frame].x + box.x, frame_map[frame].y + box.y,
+						 box.w, box.h, x + box.x, y + box.y, alpha, surface);
+	}
 }
 
 void CGraphic::DrawFrameClipCustomMod(unsigned frame, int x, int y, 
@@ -293,8 +503,11 @@ void CGraphic::DrawFrameClipCustomMod(unsigned frame, int x, int y,
 									  const uint32_t param,
 									  SDL_Surface *surface /* = TheScreen*/) const
 {
-	DrawSubClipCustomMod(frame_map[frame].x, frame_map[frame].y,
-						 Width, Height, x, y, modifier, param, surface);
+	const frame_box_t &box = box_map[frame];
+	if (box.w) {
+		DrawSubClipCustomMod(frame_map[frame].x + box.x, frame_map[frame].y + box.y,
+							 box.w, box.h, x + box.x, y + box.y, modifier, param, surface);
+	}
 }
 
 /**
@@ -325,8 +538,13 @@ void CPlayerColorGraphic::DrawPlayerColorFrameClip(int colorIndex, unsigned fram
 void CGraphic::DrawFrameX(unsigned frame, int x, int y,
 						  SDL_Surface *surface /*= TheScreen*/) const
 {
-	SDL_Rect srect = {frameFlip_map[frame].x, frameFlip_map[frame].y, Uint16(Width), Uint16(Height)};
-	SDL_Rect drect = {Sint16(x), Sint16(y), 0, 0};
+	const frame_box_t &box = box_map[frame];
+	if (!box.w) {
+		return;
+	}
+	const int boxX = Width - box.x - box.w;
+	SDL_Rect srect = {frameFlip_map[frame].x + boxX, frameFlip_map[frame].y + box.y, box.w, box.h};
+	SDL_Rect drect = {Sint16(x + boxX), Sint16(y + box.y), 0, 0};
 
 	SDL_BlitSurface(SurfaceFlip, &srect, surface, &drect);
 }
@@ -342,7 +560,19 @@ void CGraphic::DrawFrameX(unsigned frame, int x, int y,
 void CGraphic::DrawFrameClipX(unsigned frame, int x, int y,
 							  SDL_Surface *surface /*= TheScreen*/) const
 {
-	SDL_Rect srect = {frameFlip_map[frame].x, frameFlip_map[frame].y, Uint16(Width), Uint16(Height)};
+	const frame_box_t &box = box_map[frame];
+	if (!box.w) {
+		return;
+	}
+	Uint32 colorKey;
+	if (CanDrawRleFrame(SurfaceFlip, surface, &colorKey)) {
+		DrawRleFrameClip(*this, frame, x, y, true, colorKey, surface);
+		return;
+	}
+	const int boxX = Width - box.x - box.w;
+	SDL_Rect srect = {frameFlip_map[frame].x + boxX, frameFlip_map[frame].y + box.y, box.w, box.h};
+	x += boxX;
+	y += box.y;
 
 	const int oldx = x;
 	const int oldy = y;
@@ -358,8 +588,13 @@ void CGraphic::DrawFrameClipX(unsigned frame, int x, int y,
 void CGraphic::DrawFrameTransX(unsigned frame, int x, int y, int alpha,
 							   SDL_Surface *surface /*= TheScreen*/) const
 {
-	SDL_Rect srect = {frameFlip_map[frame].x, frameFlip_map[frame].y, Uint16(Width), Uint16(Height)};
-	SDL_Rect drect = {Sint16(x), Sint16(y), 0, 0};
+	const frame_box_t &box = box_map[frame];
+	if (!box.w) {
+		return;
+	}
+	const int boxX = Width - box.x - box.w;
+	SDL_Rect srect = {frameFlip_map[frame].x + boxX, frameFlip_map[frame].y + box.y, box.w, box.h};
+	SDL_Rect drect = {Sint16(x + boxX), Sint16(y + box.y), 0, 0};
 	Uint8 oldalpha = 0xff;
 	SDL_GetSurfaceAlphaMod(SurfaceFlip, &oldalpha);
 
@@ -371,7 +606,14 @@ void CGraphic::DrawFrameTransX(unsigned frame, int x, int y, int alpha,
 void CGraphic::DrawFrameClipTransX(unsigned frame, int x, int y, int alpha,
 								   SDL_Surface *surface /*= TheScreen*/) const
 {
-	SDL_Rect srect = {frameFlip_map[frame].x, frameFlip_map[frame].y, Uint16(Width), Uint16(Height)};
+	const frame_box_t &box = box_map[frame];
+	if (!box.w) {
+		return;
+	}
+	const int boxX = Width - box.x - box.w;
+	SDL_Rect srect = {frameFlip_map[frame].x + boxX, frameFlip_map[frame].y + box.y, box.w, box.h};
+	x += boxX;
+	y += box.y;
 
 	int oldx = x;
 	int oldy = y;
@@ -405,6 +647,92 @@ void CPlayerColorGraphic::DrawPlayerColorFrameClipX(int colorIndex, unsigned fra
 	DrawFrameClipX(frame, x, y, surface);
 }
 
+/**
+**  Darken the target surface by the coverage of a shadow frame.
+**
+**  Only the covered box of the frame is visited. Each byte of the target
+**  pixel is scaled, so the kernel doesn't depend on the channel order.
+**
+**  @param mask     Coverage of the shadow frames
+**  @param pos      Position of the frame in the mask
+**  @param box      Covered part of the frame
+**  @param x        x coordinate of the frame on the target surface
+**  @param y        y coordinate of the frame on the target surface
+**  @param surface  target surface
+*/
+static void DrawShadowMaskClip(const SDL_Surface &mask, const CGraphic::frame_pos_t &pos,
+							   const CGraphic::frame_box_t &box, int x, int y, SDL_Surface *surface)
+{
+	Assert(surface->format->BytesPerPixel == 4);
+
+	int w = box.w;
+	int h = box.h;
+	if (w == 0 || h == 0) {
+		return;
+	}
+	x += box.x;
+	y += box.y;
+	const int oldx = x;
+	const int oldy = y;
+	CLIP_RECTANGLE(x, y, w, h);
+	const int gx = pos.x + box.x + x - oldx;
+	const int gy = pos.y + box.y + y - oldy;
+
+	const Uint8 *src = static_cast<const Uint8 *>(mask.pixels) + gy * mask.pitch + gx;
+	Uint8 *dst = static_cast<Uint8 *>(surface->pixels) + y * surface->pitch + x * 4;
+	for (int j = 0; j < h; ++j) {
+		Uint32 *dp = reinterpret_cast<Uint32 *>(dst);
+		for (int i = 0; i < w; ++i) {
+			const Uint32 a = src[i];
+			if (a) {
+				const Uint32 k = 256 - a;
+				const Uint32 p = dp[i];
+				dp[i] = (((p & 0x00FF00FF) * k >> 8) & 0x00FF00FF)
+						| ((((p >> 8) & 0x00FF00FF) * k) & 0xFF00FF00);
+			}
+		}
+		src += mask.pitch;
+		dst += surface->pitch;
+	}
+}
+
+/**
+**  Draw shadow frame clipped. A graphic which isn't made a shadow is
+**  drawn as is.
+**
+**  @param frame   number of frame (object index)
+**  @param x       x coordinate on the target surface
+**  @param y       y coordinate on the target surface
+**  @param surface target surface
+*/
+void CGraphic::DrawShadowFrameClip(unsigned frame, int x, int y,
+								   SDL_Surface *surface /*= TheScreen*/) const
+{
+	if (!shadow_map) {
+		DrawFrameClip(frame, x, y, surface);
+		return;
+	}
+	DrawShadowMaskClip(*Surface, frame_map[frame], shadow_map[frame], x, y, surface);
+}
+
+/**
+**  Draw shadow frame clipped and flipped in X direction.
+**
+**  @param frame   number of frame (object index)
+**  @param x       x coordinate on the target surface
+**  @param y       y coordinate on the target surface
+**  @param surface target surface
+*/
+void CGraphic::DrawShadowFrameClipX(unsigned frame, int x, int y,
+									SDL_Surface *surface /*= TheScreen*/) const
+{
+	if (!shadowFlip_map) {
+		DrawFrameClipX(frame, x, y, surface);
+		return;
+	}
+	DrawShadowMaskClip(*SurfaceFlip, frameFlip_map[frame], shadowFlip_map[frame], x, y, surface);
+}
+
 /*----------------------------------------------------------------------------
 --  Global functions
 ----------------------------------------------------------------------------*/
@@ -611,6 +939,69 @@ void CGraphic::GenFramesMap()
 		frame_map[frame].x = (frame % (Surface->w / Width)) * Width;
 		frame_map[frame].y = (frame / (Surface->w / Width)) * Height;
 	}
+	GenFrameBoxes();
+}
+
+/**
+**  Find the part of each frame which is not transparent.
+**
+**  Transparent pixels have the colour key, or no alpha in a blended
+**  surface. The frames are only drawn over their box, and the run length
+**  encoded frames are made again from the new boxes.
+*/
+void CGraphic::GenFrameBoxes()
+{
+	delete[] box_map;
+	box_map = new frame_box_t[NumFrames];
+	delete rle_frames;
+	rle_frames = NULL;
+
+	const SDL_PixelFormat &format = *Surface->format;
+	Uint32 colorKey;
+	const bool hasColorKey = !SDL_GetColorKey(Surface, &colorKey);
+	SDL_BlendMode mode;
+	SDL_GetSurfaceBlendMode(Surface, &mode);
+	const Uint32 amask = (mode == SDL_BLENDMODE_BLEND || mode == SDL_BLENDMODE_ADD) ? format.Amask : 0;
+	if ((format.BytesPerPixel != 1 && format.BytesPerPixel != 4)
+		|| (!hasColorKey && !amask)) {
+		for (int f = 0; f < NumFrames; ++f) {
+			box_map[f].x = box_map[f].y = 0;
+			box_map[f].w = Width;
+			box_map[f].h = Height;
+		}
+		return;
+	}
+
+	SDL_LockSurface(Surface);
+	for (int f = 0; f < NumFrames; ++f) {
+		int minX = Width;
+		int minY = Height;
+		int maxX = -1;
+		int maxY = -1;
+		for (int y = 0; y < Height; ++y) {
+			const Uint8 *row = static_cast<const Uint8 *>(Surface->pixels)
+							   + (frame_map[f].y + y) * Surface->pitch + frame_map[f].x * format.BytesPerPixel;
+			for (int x = 0; x < Width; ++x) {
+				const Uint32 pixel = format.BytesPerPixel == 1 ? row[x] : reinterpret_cast<const Uint32 *>(row)[x];
+				if ((hasColorKey && pixel == colorKey) || (amask && !(pixel & amask))) {
+					continue;
+				}
+				minX = std::min(minX, x);
+				maxX = std::max(maxX, x);
+				minY = std::min(minY, y);
+				maxY = std::max(maxY, y);
+			}
+		}
+		if (maxX < 0) {
+			box_map[f].x = box_map[f].y = box_map[f].w = box_map[f].h = 0;
+		} else {
+			box_map[f].x = minX;
+			box_map[f].y = minY;
+			box_map[f].w = maxX - minX + 1;
+			box_map[f].h = maxY - minY + 1;
+		}
+	}
+	SDL_UnlockSurface(Surface);
 }
 
 static void ApplyGrayScale(SDL_Surface *Surface, int Width, int Height)
@@ -763,6 +1154,15 @@ void CGraphic::Free(CGraphic *g)
 		delete[] g->frameFlip_map;
 		g->frameFlip_map = NULL;
 
+		delete[] g->shadow_map;
+		g->shadow_map = NULL;
+		delete[] g->shadowFlip_map;
+		g->shadowFlip_map = NULL;
+		delete[] g->box_map;
+		g->box_map = NULL;
+		delete g->rle_frames;
+		g->rle_frames = NULL;
+
 		if (!g->HashFile.empty()) {
 			GraphicHash.erase(g->HashFile);
 		}
@@ -985,6 +1385,14 @@ void CGraphic::SetOriginalSize()
 	}
 	delete[] frameFlip_map;
 	frameFlip_map = NULL;
+	delete[] shadow_map;
+	shadow_map = NULL;
+	delete[] shadowFlip_map;
+	shadowFlip_map = NULL;
+	delete[] box_map;
+	box_map = NULL;
+	delete rle_frames;
+	rle_frames = NULL;
 
 	this->Width = this->Height = 0;
 	this->Surface = NULL;
@@ -1136,6 +1544,7 @@ void CGraphic::OverlayGraphic(CGraphic *other, bool mask)
 
 	SDL_UnlockSurface(Surface);
 	SDL_UnlockSurface(other->Surface);
+	GenFrameBoxes();
 }
 
 static inline void dither(SDL_Surface *Surface) {
@@ -1207,10 +1616,72 @@ static void shearSurface(SDL_Surface *surface, int xOffset, int yOffset, int num
 	}
 }
 
+/**
+**  Turn the 32bpp shadow surface into an 8 bit coverage mask: each pixel
+**  holds its alpha, which is how much it darkens the target. Also find
+**  the covered box of each frame, so drawing never visits the
+**  transparent margins.
+**
+**  @param src        32bpp shadow surface, replaced by the mask
+**  @param numFrames  Number of frames
+**  @param frameMap   Position of each frame
+**  @param frameW     Frame width
+**  @param frameH     Frame height
+**
+**  @return           The covered box of each frame
+*/
+static CGraphic::frame_box_t *makeShadowMask(SDL_Surface **src, int numFrames,
+											 const CGraphic::frame_pos_t *frameMap, int frameW, int frameH)
+{
+	SDL_Surface *mask = SDL_CreateRGBSurface(0, (*src)->w, (*src)->h, 8, 0, 0, 0, 0);
+	if (!mask) {
+		DebugPrint("%s\n" _C_ SDL_GetError());
+		Assert(false);
+	}
+	CGraphic::frame_box_t *boxes = new CGraphic::frame_box_t[numFrames];
+
+	SDL_LockSurface(*src);
+	const SDL_PixelFormat &format = *(*src)->format;
+	for (int f = 0; f < numFrames; ++f) {
+		int minX = frameW;
+		int minY = frameH;
+		int maxX = -1;
+		int maxY = -1;
+		for (int y = 0; y < frameH; ++y) {
+			const int py = frameMap[f].y + y;
+			const Uint32 *sp = reinterpret_cast<const Uint32 *>(static_cast<const Uint8 *>((*src)->pixels) + py * (*src)->pitch) + frameMap[f].x;
+			Uint8 *dp = static_cast<Uint8 *>(mask->pixels) + py * mask->pitch + frameMap[f].x;
+			for (int x = 0; x < frameW; ++x) {
+				dp[x] = (sp[x] & format.Amask) >> format.Ashift;
+				if (dp[x]) {
+					minX = std::min(minX, x);
+					maxX = std::max(maxX, x);
+					minY = std::min(minY, y);
+					maxY = std::max(maxY, y);
+				}
+			}
+		}
+		if (maxX < 0) {
+			boxes[f].x = boxes[f].y = boxes[f].w = boxes[f].h = 0;
+		} else {
+			boxes[f].x = minX;
+			boxes[f].y = minY;
+			boxes[f].w = maxX - minX + 1;
+			boxes[f].h = maxY - minY + 1;
+		}
+	}
+	SDL_UnlockSurface(*src);
+
+	SDL_FreeSurface(*src);
+	*src = mask;
+	return boxes;
+}
+
 /**
 **  Make shadow sprite
 **
-**  @todo FIXME: 32bpp
+**  The shadow is kept as an 8 bit coverage mask, drawn by
+**  DrawShadowFrameClip and DrawShadowFrameClipX.
 */
 void CGraphic::MakeShadow(int xOffset, int yOffset)
 {
@@ -1241,6 +1712,15 @@ void CGraphic::MakeShadow(int xOffset, int yOffset)
 	if (SurfaceFlip) {
 		shearSurface(SurfaceFlip, xOffset, yOffset, NumFrames, frameFlip_map, Width, Height);
 	}
+
+	// 3. Keep only the coverage
+	delete[] shadow_map;
+	shadow_map = makeShadowMask(&Surface, NumFrames, frame_map, Width, Height);
+	if (SurfaceFlip) {
+		delete[] shadowFlip_map;
+		shadowFlip_map = makeShadowMask(&SurfaceFlip, NumFrames, frameFlip_map, Width, Height);
+	}
+	GenFrameBoxes();
 }
 
 void FreeGraphics()
@@ -634,6 +634,11 @@ static void SdlDoEvent(const EventCallback &callbacks, SDL_Event &event)
 			switch (event.window.event) {
 				case SDL_WINDOWEVENT_SIZE_CHANGED:
 				SizeChangeCounter++;
+				Invalidate();
+				break;
+
+				case SDL_WINDOWEVENT_EXPOSED:
+				Invalidate();
 				break;
 
 				case SDL_WINDOWEVENT_ENTER:
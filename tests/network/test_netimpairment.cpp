@@ -0,0 +1,133 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_netimpairment.cpp - The test file for netimpairment.cpp. */
+//
+//      (c) Copyright 2024 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+
+#include <UnitTest++.h>
+
+#include "stratagus.h"
+
+#include "network/netimpairment.h"
+
+#include <algorithm>
+
+static int PopAll(CImpairedPacketQueue &queue, unsigned long now, std::vector<unsigned char> *order = NULL)
+{
+	CHost host;
+	std::vector<unsigned char> data;
+	int count = 0;
+
+	while (queue.Pop(now, &host, &data)) {
+		if (order) {
+			order->push_back(data[0]);
+		}
+		++count;
+	}
+	return count;
+}
+
+TEST(CNetworkImpairment_Parse)
+{
+	CNetworkImpairment impairment;
+
+	CHECK(impairment.IsEnabled() == false);
+	CHECK(impairment.Parse("delay=80,jitter=20,dist=normal,loss=5,dup=1,reorder=2,seed=42"));
+	CHECK(impairment.IsEnabled());
+	CHECK_EQUAL(80u, impairment.Delay);
+	CHECK_EQUAL(20u, impairment.Jitter);
+	CHECK(impairment.NormalJitter);
+	CHECK_EQUAL(5u, impairment.Loss);
+	CHECK_EQUAL(1u, impairment.Duplicate);
+	CHECK_EQUAL(2u, impairment.Reorder);
+	CHECK_EQUAL(42u, impairment.Seed);
+
+	CHECK(impairment.Parse("lag=5") == false);
+	CHECK(impairment.Parse("delay") == false);
+	CHECK(impairment.Parse("dist=pareto") == false);
+}
+
+TEST(CImpairedPacketQueue_Delay)
+{
+	CNetworkImpairment impairment;
+	impairment.Delay = 50;
+	CImpairedPacketQueue queue(impairment);
+	const CHost host(0x7F000001, 6502);
+
+	for (unsigned char i = 0; i != 10; ++i) {
+		queue.Push(host, &i, 1, 1000 + i);
+	}
+	CHECK_EQUAL(0, PopAll(queue, 1049));
+	std::vector<unsigned char> order;
+	CHECK_EQUAL(5, PopAll(queue, 1054, &order));
+	CHECK_EQUAL(5, PopAll(queue, 2000, &order));
+	CHECK(queue.IsEmpty());
+	for (unsigned char i = 0; i != 10; ++i) {
+		CHECK_EQUAL(i, order[i]);
+	}
+}
+
+TEST(CImpairedPacketQueue_LossAndDuplicate)
+{
+	CNetworkImpairment impairment;
+	impairment.Loss = 100;
+	CImpairedPacketQueue lossQueue(impairment);
+	const CHost host(0x7F000001, 6502);
+	const unsigned char data = 42;
+
+	for (int i = 0; i != 100; ++i) {
+		lossQueue.Push(host, &data, 1, 0);
+	}
+	CHECK_EQUAL(0, PopAll(lossQueue, 1000));
+	CHECK_EQUAL(100u, lossQueue.getStatistic().droppedCount);
+
+	impairment.Loss = 0;
+	impairment.Duplicate = 100;
+	CImpairedPacketQueue dupQueue(impairment);
+	for (int i = 0; i != 100; ++i) {
+		dupQueue.Push(host, &data, 1, 0);
+	}
+	CHECK_EQUAL(200, PopAll(dupQueue, 1000));
+}
+
+TEST(CImpairedPacketQueue_Reorder)
+{
+	CNetworkImpairment impairment;
+	impairment.Delay = 10;
+	impairment.Reorder = 50;
+	impairment.Seed = 1;
+	CImpairedPacketQueue queue(impairment);
+	const CHost host(0x7F000001, 6502);
+
+	for (unsigned char i = 0; i != 100; ++i) {
+		queue.Push(host, &i, 1, 1000 + i);
+	}
+	std::vector<unsigned char> order;
+	CHECK_EQUAL(100, PopAll(queue, 5000, &order));
+	CHECK(queue.getStatistic().reorderedCount != 0);
+	CHECK(std::is_sorted(order.begin(), order.end()) == false);
+}
@@ -63,6 +63,32 @@ void FillCustomValue(CNetworkCommandQuit *obj)
 {
 	obj->player = 0x0123;
 }
+void FillCustomValue(CNetworkPing *obj)
+{
+	obj->ticks = 0x01234567;
+}
+void FillCustomValue(CNetworkCommandLag *obj)
+{
+	obj->lag = 0x0123;
+}
+void FillCustomValue(CNetworkSyncState *obj)
+{
+	obj->player = 0x0123;
+	obj->cycle = 0x456789AB;
+	for (int i = 0; i != SyncStateSubsystemCount; ++i) {
+		obj->hash[i] = 0x01234567 * (i + 1);
+	}
+}
+void FillCustomValue(CNetworkSyncStateParts *obj)
+{
+	obj->player = 0x0123;
+	obj->cycle = 0x456789AB;
+	obj->subsystem = SyncStateMap;
+	obj->offset = 64;
+	for (int i = 0; i != 10; ++i) {
+		obj->parts.push_back(0x01234567 * i);
+	}
+}
 void FillCustomValue(CNetworkSelection *obj)
 {
 	for (int i = 0; i != 10; ++i) {
@@ -89,6 +115,18 @@ bool Comp(const CNetworkChat &lhs, const CNetworkChat &rhs)
 	return lhs.Text == rhs.Text;
 }
 
+bool Comp(const CNetworkSyncState &lhs, const CNetworkSyncState &rhs)
+{
+	return lhs.player == rhs.player && lhs.cycle == rhs.cycle
+		   && memcmp(lhs.hash, rhs.hash, sizeof(lhs.hash)) == 0;
+}
+
+bool Comp(const CNetworkSyncStateParts &lhs, const CNetworkSyncStateParts &rhs)
+{
+	return lhs.player == rhs.player && lhs.cycle == rhs.cycle && lhs.subsystem == rhs.subsystem
+		   && lhs.offset == rhs.offset && lhs.parts == rhs.parts;
+}
+
 bool Comp(const CNetworkSelection &lhs, const CNetworkSelection &rhs)
 {
 	return lhs.Units == rhs.Units;
@@ -131,6 +169,22 @@ TEST(CNetworkCommandQuit)
 {
 	CHECK(CheckSerialization<CNetworkCommandQuit>());
 }
+TEST(CNetworkPing)
+{
+	CHECK(CheckSerialization<CNetworkPing>());
+}
+TEST(CNetworkCommandLag)
+{
+	CHECK(CheckSerialization<CNetworkCommandLag>());
+}
+TEST(CNetworkSyncState)
+{
+	CHECK(CheckSerialization<CNetworkSyncState>());
+}
+TEST(CNetworkSyncStateParts)
+{
+	CHECK(CheckSerialization<CNetworkSyncStateParts>());
+}
 TEST(CNetworkSelection)
 {
 	CHECK(CheckSerialization<CNetworkSelection>());
@@ -141,3 +195,49 @@ TEST(CNetworkPacketHeader)
 }
 //TEST(CNetworkPacket)
 
+TEST(CNetworkPacket_Redundant)
+{
+	CNetworkCommandSync sync;
+	FillCustomValue(&sync);
+	CNetworkCommandQuit quit;
+	FillCustomValue(&quit);
+
+	CNetworkPacket packet1;
+	packet1.Header.Cycle = 42;
+	packet1.Header.OrigPlayer = 3;
+	packet1.Header.Type[0] = MessageSync;
+	packet1.Command[0].resize(sync.Size());
+	sync.Serialize(&packet1.Command[0][0]);
+
+	CNetworkRedundantCommands redundant;
+	redundant.Cycle = 41;
+	redundant.NumCommands = 2;
+	redundant.Type[0] = MessageSync;
+	redundant.Command[0] = packet1.Command[0];
+	redundant.Type[1] = MessageQuit;
+	redundant.Command[1].resize(quit.Size());
+	quit.Serialize(&redundant.Command[1][0]);
+	packet1.Redundant.push_back(redundant);
+
+	const size_t size = packet1.Size(1);
+	unsigned char *buffer = new unsigned char [size];
+	CHECK_EQUAL(size, packet1.Serialize(buffer, 1));
+
+	CNetworkPacket packet2;
+	int commands;
+	packet2.Deserialize(buffer, size, &commands);
+	CHECK_EQUAL(1, commands);
+	CHECK(Comp(packet1.Header, packet2.Header));
+	CHECK(packet1.Command[0] == packet2.Command[0]);
+	CHECK_EQUAL(1u, packet2.Redundant.size());
+	CHECK_EQUAL(41, packet2.Redundant[0].Cycle);
+	CHECK_EQUAL(2, packet2.Redundant[0].NumCommands);
+	CHECK_EQUAL(MessageQuit, packet2.Redundant[0].Type[1]);
+	CHECK(redundant.Command[1] == packet2.Redundant[0].Command[1]);
+
+	// Truncated packets are rejected.
+	packet2.Deserialize(buffer, size - 1, &commands);
+	CHECK_EQUAL(-1, commands);
+	delete [] buffer;
+}
+
@@ -0,0 +1,118 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_distancefield.cpp - The test file for distancefield.cpp. */
+//
+//      (c) Copyright 2024 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <UnitTest++.h>
+
+#include "stratagus.h"
+#include "distancefield.h"
+
+static void SetRow(CDistanceField &field, int y, const char *row)
+{
+	for (int x = 0; row[x]; ++x) {
+		field.SetState(Vec2i(x, y), row[x] == '#' ? CDistanceField::Blocked
+					   : row[x] == 'S' ? CDistanceField::Source : CDistanceField::Passable);
+	}
+}
+
+TEST(DISTANCEFIELD_BUILD)
+{
+	CDistanceField field;
+
+	field.Init(6, 3);
+	SetRow(field, 0, "S.#...");
+	SetRow(field, 1, "..#...");
+	SetRow(field, 2, "......");
+	field.Build();
+
+	CHECK_EQUAL(0, field.Get(Vec2i(0, 0)));
+	CHECK_EQUAL(1, field.Get(Vec2i(1, 1)));
+	CHECK_EQUAL(CDistanceField::Infinity, field.Get(Vec2i(2, 0)));
+	CHECK_EQUAL(3, field.Get(Vec2i(3, 1)));
+	CHECK_EQUAL(5, field.Get(Vec2i(5, 0)));
+
+	Vec2i source;
+	CHECK(field.FindNearestSource(Vec2i(5, 0), &source));
+	CHECK_EQUAL(0, source.x);
+	CHECK_EQUAL(0, source.y);
+	CHECK(!field.FindNearestSource(Vec2i(2, 0), &source));
+}
+
+TEST(DISTANCEFIELD_UPDATE)
+{
+	CDistanceField field;
+
+	field.Init(6, 3);
+	SetRow(field, 0, "S.#...");
+	SetRow(field, 1, "..#...");
+	SetRow(field, 2, "......");
+	field.Build();
+
+	// Close the way below the wall.
+	field.UpdateTile(Vec2i(2, 2), CDistanceField::Blocked);
+	CHECK_EQUAL(CDistanceField::Infinity, field.Get(Vec2i(3, 1)));
+
+	// New source on the other side.
+	field.UpdateTile(Vec2i(5, 2), CDistanceField::Source);
+	CHECK_EQUAL(2, field.Get(Vec2i(3, 1)));
+
+	// Open the wall, remove the first source.
+	field.UpdateTile(Vec2i(2, 0), CDistanceField::Passable);
+	field.UpdateTile(Vec2i(0, 0), CDistanceField::Passable);
+	CHECK_EQUAL(3, field.Get(Vec2i(2, 0)));
+	CHECK_EQUAL(5, field.Get(Vec2i(0, 0)));
+}
+
+TEST(DISTANCEFIELD_UPDATE_LIKE_BUILD)
+{
+	const int width = 17;
+	const int height = 13;
+	CDistanceField field;
+	CDistanceField reference;
+	unsigned int random = 42;
+
+	field.Init(width, height);
+	reference.Init(width, height);
+	field.Build();
+	for (int i = 0; i != 2000; ++i) {
+		random = random * 1103515245 + 12345;
+		const Vec2i pos((random >> 8) % width, (random >> 16) % height);
+		const unsigned int r = (random >> 24) % 8;
+		const CDistanceField::TileState state = r < 2 ? CDistanceField::Blocked
+												: r < 3 ? CDistanceField::Source : CDistanceField::Passable;
+
+		field.UpdateTile(pos, state);
+		reference.SetState(pos, state);
+	}
+	reference.Build();
+	for (Vec2i pos(0, 0); pos.y != height; ++pos.y) {
+		for (pos.x = 0; pos.x != width; ++pos.x) {
+			CHECK_EQUAL(reference.Get(pos), field.Get(pos));
+		}
+	}
+}
@@ -0,0 +1,107 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name test_fow_utils.cpp - The test file for fow_utils.cpp. */
+//
+//      (c) Copyright 2026 by the Stratagus Team
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include <UnitTest++.h>
+
+#include "stratagus.h"
+#include "fow_utils.h"
+
+/// Repeatable pseudo random bytes, with long runs like a real fog texture has
+static void FillTexture(std::vector<uint8_t> &texture, uint32_t seed)
+{
+	uint8_t value = 0;
+	for (size_t i = 0; i < texture.size(); ++i) {
+		seed = seed * 1103515245 + 12345;
+		if ((seed >> 16) % 8 == 0) {
+			value = seed >> 24;
+		}
+		texture[i] = value;
+	}
+}
+
+static void CheckBlurMatchesScalar(uint16_t width, uint16_t height, float radius, int numOfIterations)
+{
+	CBlurer scalar;
+	CBlurer vectorized;
+	scalar.Init(width, height, radius, numOfIterations);
+	scalar.SetVectorized(false);
+	vectorized.Init(width, height, radius, numOfIterations);
+
+	std::vector<uint8_t> expected(width * height);
+	FillTexture(expected, width + height);
+	std::vector<uint8_t> result(expected);
+
+	scalar.Blur(expected.data());
+	vectorized.Blur(result.data());
+	CHECK_ARRAY_EQUAL(expected.data(), result.data(), int(expected.size()));
+}
+
+TEST(FOW_BLUR_VECTORIZED)
+{
+	CheckBlurMatchesScalar(64, 64, 2.0, 3);
+	CheckBlurMatchesScalar(52, 36, 1.5, 3);
+	CheckBlurMatchesScalar(260, 132, 3.0, 2);
+	CheckBlurMatchesScalar(20, 28, 0.5, 3);
+}
+
+static void CheckUpscaleMatchesScalar(uint16_t mapWidth, uint16_t mapHeight)
+{
+	const size_t visTableWidth = mapWidth + 2;
+	std::vector<uint8_t> visTable(visTableWidth * (mapHeight + 2));
+	FillTexture(visTable, mapWidth * mapHeight);
+	for (uint8_t &vis : visTable) {
+		vis %= 3; // unseen, explored or visible
+	}
+
+	uint32_t tableVisible[16][4];
+	uint32_t tableExplored[16][4];
+	for (int i = 0; i < 16; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			tableVisible[i][j] = 0x01020304 * (i + 1) + j;
+			tableExplored[i][j] = 0x10203040 * (j + 1) + i;
+		}
+	}
+
+	const uint16_t textureWidth = mapWidth + 1;
+	const uint16_t textureHeight = mapHeight + 1;
+	std::vector<uint32_t> expected(textureWidth * textureHeight * 4);
+	std::vector<uint32_t> result(expected.size());
+	UpscaleVisTable4x4(visTable.data(), visTableWidth, expected.data(), textureWidth, textureHeight,
+					   tableVisible, tableExplored, false);
+	UpscaleVisTable4x4(visTable.data(), visTableWidth, result.data(), textureWidth, textureHeight,
+					   tableVisible, tableExplored, true);
+	CHECK_ARRAY_EQUAL(expected.data(), result.data(), int(expected.size()));
+}
+
+TEST(FOW_UPSCALE_VECTORIZED)
+{
+	CheckUpscaleMatchesScalar(15, 15);
+	CheckUpscaleMatchesScalar(64, 32);
+	CheckUpscaleMatchesScalar(37, 21);
+}
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""
+Run several stratagus instances on localhost through a simulated network
+and report the network statistics of each, to catch network performance
+regressions in automated runs.
+
+The engine has no command line option to host or join a game, so the game
+scripts have to do it: the server instance gets --server-args and the
+clients get --client-args, both through -G. Every instance runs in
+benchmark mode with -L impairment and its own port.
+
+Example:
+  network-harness.py --binary ./stratagus --data ../wargus -n 4 \\
+      --impair delay=60,jitter=20,loss=3,reorder=2 \\
+      --server-args "host" --client-args "join 127.0.0.1:6660" \\
+      --max-stall-ms 5000 --min-cps 25
+"""
+
+import argparse
+import re
+import subprocess
+import sys
+import time
+
+RESULT = re.compile(r"NETWORK RESULT: ([0-9.]+) cps \((\d+) cycles in (\d+)ms\), "
+                    r"(\d+) stalls \((\d+)ms\), (\d+) resends, (\d+) recovered updates, lag (\d+)")
+IMPAIRMENT = re.compile(r"NETWORK IMPAIRMENT: (\d+) sent, (\d+) dropped, (\d+) duplicated, (\d+) reordered")
+
+
+def launch(args, index):
+    port = args.port + index
+    gameargs = args.server_args if index == 0 else args.client_args
+    cmd = [args.binary, "-b", "-l", "-d", args.data, "-P", str(port),
+           "-N", "Player%d" % index, "-L", args.impair + ",seed=%d" % (args.seed + index),
+           "-G", gameargs]
+    return subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE,
+                            universal_newlines=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--binary", default="./stratagus")
+    parser.add_argument("--data", default=".")
+    parser.add_argument("-n", "--instances", type=int, default=2, choices=range(2, 9))
+    parser.add_argument("--port", type=int, default=6660)
+    parser.add_argument("--impair", default="delay=50,jitter=10")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--server-args", default="")
+    parser.add_argument("--client-args", default="")
+    parser.add_argument("--timeout", type=int, default=600, help="seconds")
+    parser.add_argument("--max-stall-ms", type=int, default=None)
+    parser.add_argument("--max-resends", type=int, default=None)
+    parser.add_argument("--min-cps", type=float, default=None)
+    args = parser.parse_args()
+
+    procs = []
+    for i in range(args.instances):
+        procs.append(launch(args, i))
+        if i == 0:
+            time.sleep(1)  # let the server open its port
+
+    failed = False
+    for i, proc in enumerate(procs):
+        try:
+            _, err = proc.communicate(timeout=args.timeout)
+        except subprocess.TimeoutExpired:
+            proc.kill()
+            _, err = proc.communicate()
+            print("instance %d: timed out" % i)
+            failed = True
+            continue
+        result = RESULT.search(err)
+        if not result:
+            print("instance %d: no network result (exit code %d)" % (i, proc.returncode))
+            failed = True
+            continue
+        cps, cycles, ticks, stalls, stallms, resends, recovered, lag = result.groups()
+        line = ("instance %d: %s cps, %s cycles, %s stalls (%s ms), %s resends, "
+                "%s recovered updates, final lag %s" %
+                (i, cps, cycles, stalls, stallms, resends, recovered, lag))
+        impairment = IMPAIRMENT.search(err)
+        if impairment:
+            line += "; sent %s, dropped %s, duplicated %s, reordered %s" % impairment.groups()
+        print(line)
+        if args.max_stall_ms is not None and int(stallms) > args.max_stall_ms:
+            print("instance %d: stalled too long" % i)
+            failed = True
+        if args.max_resends is not None and int(resends) > args.max_resends:
+            print("instance %d: too many resends" % i)
+            failed = True
+        if args.min_cps is not None and float(cps) < args.min_cps:
+            print("instance %d: too slow" % i)
+            failed = True
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())